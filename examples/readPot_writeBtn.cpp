@@ -6,14 +6,22 @@
  * Description: Example program demonstrating the use of the RN4871 BLE library
  *              on the ATmega328PB microcontroller. Configures a BLE service with
  *              one readable characteristic for analog input and one writable
- *              characteristic for LED control.
+ *              characteristic for LED control. Sensor values reach their
+ *              characteristics through the sensor bridge table.
  */
 
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "rn4871.h"
+#include "advController.h"
+#include "diagService.h"
+#include "sensorBridge.h"
+#include "moduleConfig.h"
+#include "crc16.h"
 #include "bleSerial.h"
 #include "wiring.h"
 
@@ -38,27 +46,40 @@ lock_state_t lock_state = LOCKED;
 const char* myDeviceName = "Avocado";
 const char* myServiceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
 const char* potCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
-const uint16_t potCharLen = 4;
-uint16_t potHandle;
-char potPayload[potCharLen * 4 + 1];
+const char* supplyCharUUID = "AD11CF40263F11E5BE3E0002A5D5C51B";
 
 const char* toggleLedCharUUID = "AD11CF40363F11E5BE3E0002A5D5C51B";
 const uint8_t toggleLedCharLen = 1;
 uint16_t toggleHandle;
 
-uint16_t analogRead(uint8_t pin) {
-    DDRC &= ~(1 << pin); // Set pin as input
-    DIDR0 |= (1 << pin); // Disable digital input buffer
-    ADMUX = (1 << REFS0); // Reference voltage AVcc
-    if (pin > 5) return 0; // Invalid pin check
-    ADMUX &= ~0x0F; // Clear previous channel
-    ADMUX |= (pin & 0x0F); // Select ADC channel
+// Advertising phases: fast discovery burst, then decay to background mode
+const advPhaseConfig_t advPhases[] = {
+    { 32, 30000 },   // Fast burst for 30 s
+    { 200, 120000 }, // Medium interval for 2 min
+    { 1600, 0 }      // Long-interval background mode
+};
+
+int32_t readSupply(uint8_t channel) {
+    (void)channel;
+    ADMUX = (1 << REFS0) | 0x0E; // Measure the 1.1 V bandgap against AVcc
     ADCSRA = (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0); // Enable ADC, prescaler 128
+    _delay_ms(1); // Let the bandgap settle
     ADCSRA |= (1 << ADSC); // Start conversion
     while (ADCSRA & (1 << ADSC)); // Wait for completion
-    return ADC;
+    return ADC ? 1100L * 1024L / ADC : 0; // Supply voltage in mV
 }
 
+// Sensor rows: adding a sensor is one more row
+const bridgeRow_t sensorRows[] = {
+    // Potentiometer on PC0, readable, updated when it moves
+    { bridgeAdc, 0, NULL, 100, bridgeUint16Be, potCharUUID, READ_PROPERTY, bridgeOnChange },
+    // Supply voltage in mV, notified every 10 s while subscribed
+    { bridgeCallback, 0, readSupply, 10000, bridgeUint16Le, supplyCharUUID,
+      READ_PROPERTY | NOTIFY_PROPERTY, bridgeNotify }
+};
+const uint8_t sensorRowCount = sizeof(sensorRows) / sizeof(sensorRows[0]);
+bridgeState_t sensorState[sensorRowCount]; // Bridge run state, one per row
+
 void timer_for_10ms(void) {
     cli(); // Disable interrupts
     TCCR1A = 0; // Clear Timer1 control registers
@@ -75,6 +96,11 @@ ISR(TIMER1_COMPA_vect) {
     lock_state = (lock_state == LOCKED) ? UNLOCKED : LOCKED;
 }
 
+void onBleEvent(const char* event) {
+    diagHandleEvent(event); // Connection count and diagnostics subscription
+    bridgeHandleEvent(event); // Connection and sensor subscriptions
+}
+
 int main(void) {
     // Initialize peripherals
     bleInit();
@@ -85,42 +111,65 @@ int main(void) {
 
     // Initialize RN4871 BLE module
     hwInit(7, &DDRD, &PORTD);
-    if (!swInit()) {
+    if (probeModule() == moduleSilent) { // Leaves the module in command mode
         while (1); // Halt on initialization failure
     }
 
-    // Configure BLE services
-    enterCommandMode();
-    stopAdvertising();
-    clearAllServices();
-    setSerializedName(myDeviceName);
-    setServiceUUID(myServiceUUID);
-    setCharactUUID(potCharUUID, READ_PROPERTY, potCharLen);
-    setCharactUUID(toggleLedCharUUID, WRITE_PROPERTY, toggleLedCharLen);
+    // Configure BLE services unless the module still holds this configuration
+    uint16_t configFingerprint = crc16String(CRC16_INIT, myDeviceName);
+    configFingerprint = crc16String(configFingerprint, myServiceUUID);
+    configFingerprint = bridgeFingerprint(configFingerprint, sensorRows, sensorRowCount);
+    configFingerprint = crc16String(configFingerprint, toggleLedCharUUID);
+    configFingerprint = crc16Update(configFingerprint, WRITE_PROPERTY);
+    configFingerprint = crc16Update(configFingerprint, toggleLedCharLen);
+    configFingerprint = crc16String(configFingerprint, DIAG_SERVICE_UUID);
+    bool configured = configIsCurrent(configFingerprint);
+    if (!configured) {
+        stopAdvertising();
+        clearAllServices();
+        setSerializedName(myDeviceName);
+        setServiceUUID(myServiceUUID);
+        bridgeDefine(sensorRows, sensorRowCount);
+        setCharactUUID(toggleLedCharUUID, WRITE_PROPERTY, toggleLedCharLen);
+        diagDefine(); // Field diagnostics for the mobile app
+        if (reboot() && enterCommandMode()) { // New services take effect after reboot
+            configSave(configFingerprint);
+        }
+    }
 
     // Find characteristic handles
-    char handleStr[5];
-    potHandle = findHandle(potCharUUID, READ_PROPERTY);
+    bridgeInit(sensorRows, sensorState, sensorRowCount);
     toggleHandle = findHandle(toggleLedCharUUID, WRITE_PROPERTY);
+    diagInit();
+    setEventHandler(onBleEvent);
 
-    // Reboot and start advertising
-    if (reboot() && enterCommandMode()) {
-        startCustomAdvertising(200);
+    // Start advertising
+    advControllerInit(advPhases, sizeof(advPhases) / sizeof(advPhases[0]));
+    if (enterCommandMode()) {
         setAdvPower(0);
+        advControllerBurst(); // Fast discovery after boot
     }
 
+    int lastStatus = 0;
     while (1) {
-        if (getConnectionStatus() == 1) { // Connected
-            // Read and send analog value
-            uint16_t analogValue = analogRead(0); // Read from PC0
-            sprintf(potPayload, "%04X", analogValue); // Format as 4-digit hex
-            writeLocalCharacteristic(potHandle, potPayload);
+        int status = getConnectionStatus();
+        if (status == 1 && lastStatus != 1) {
+            advControllerSuspend(); // Module stops advertising on connection
+        } else if (status == 0 && lastStatus == 1) {
+            advControllerBurst(); // Fast rediscovery after disconnect
+        }
+        if (status >= 0) {
+            lastStatus = status;
+        }
+        advControllerTask();
+        diagTask(); // Publishes only while the diagnostics client is subscribed
+        bridgeTask(); // Samples due sensors and writes their updates
 
+        if (status == 1) { // Connected
             // Check for LED control command
             if (lock_state == UNLOCKED && readLocalCharacteristic(toggleHandle)) {
-                const char* resp = getLastResponse();
-                char* number_str = strstr(resp, "CMD> ") + 5; // Extract value after "CMD> "
-                uint8_t val = (uint8_t)strtol(number_str, NULL, 16);
+                const char* resp = getLastResponse(); // Value line, prompt already stripped
+                uint8_t val = (uint8_t)strtol(resp, NULL, 16);
                 // Control LEDs based on received value
                 LED_PORT &= ~((1 << LED_PIN1) | (1 << LED_PIN2) | (1 << LED_PIN3)); // Clear LEDs
                 if (val == 0x05) {
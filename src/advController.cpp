@@ -0,0 +1,156 @@
+/*
+ * advController.cpp
+ *
+ * Created: 18-10-2026 05:43:03
+ * Author: Subrata
+ * Description: Implementation of the adaptive advertising controller for the
+ *              RN4871 BLE module. Issues a single custom advertising command on
+ *              each phase change and accounts the time spent in every phase.
+ */
+
+#include "advController.h"
+#include "rn4871.h"
+#include <string.h>
+
+advController_t advController = { {}, 0, ADV_PHASE_OFF, false, 0, {} };
+
+// -----------------------------------------------------------------------------------
+// Phase bucket procedure
+// -----------------------------------------------------------------------------------
+// Input : phase - Phase index or ADV_PHASE_OFF
+// Output: uint8_t - Index into the phaseTime array
+// Maps a phase index to its accounting bucket, the last bucket collecting off time.
+// -----------------------------------------------------------------------------------
+static uint8_t phaseBucket(uint8_t phase) {
+    return (phase == ADV_PHASE_OFF) ? ADV_MAX_PHASES : phase;
+}
+
+// -----------------------------------------------------------------------------------
+// Enter phase procedure
+// -----------------------------------------------------------------------------------
+// Input : phase - Phase index to enter or ADV_PHASE_OFF
+// Output: void
+// Closes the accounting of the active phase and switches to the new one, marking the
+// advertising command as pending when an advertising phase is entered.
+// -----------------------------------------------------------------------------------
+static void enterPhase(uint8_t phase) {
+    uint32_t now = millis();
+
+    advController.phaseTime[phaseBucket(advController.current)] += now - advController.phaseStart;
+    advController.current = phase;
+    advController.phaseStart = now;
+    advController.pending = (phase != ADV_PHASE_OFF); // Interval is applied by the task
+}
+
+// -----------------------------------------------------------------------------------
+// Advertising controller initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : phases - Phase table ordered from fastest to slowest, count - Number of phases
+// Output: void
+// Stores the phase table and resets the controller to the off state. The last phase
+// should have a zero duration so that advertising settles in background mode.
+// -----------------------------------------------------------------------------------
+void advControllerInit(const advPhaseConfig_t* phases, uint8_t count) {
+    if (count > ADV_MAX_PHASES) {
+        count = ADV_MAX_PHASES; // Truncate oversized tables
+    }
+
+    memcpy(advController.phases, phases, count * sizeof(advPhaseConfig_t));
+    advController.phaseCount = count;
+    advController.current = ADV_PHASE_OFF;
+    advController.pending = false;
+    advControllerResetStats();
+}
+
+// -----------------------------------------------------------------------------------
+// Advertising burst procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Restarts the phase sequence from the fastest phase. Call after boot, after a
+// disconnect or on a user trigger such as a button press.
+// -----------------------------------------------------------------------------------
+void advControllerBurst(void) {
+    if (advController.phaseCount == 0) return;
+    enterPhase(0);
+}
+
+// -----------------------------------------------------------------------------------
+// Advertising suspend procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Moves the controller to the off state without sending a command, as the RN4871
+// stops advertising by itself once a central connects.
+// -----------------------------------------------------------------------------------
+void advControllerSuspend(void) {
+    if (advController.current == ADV_PHASE_OFF) return;
+    enterPhase(ADV_PHASE_OFF);
+}
+
+// -----------------------------------------------------------------------------------
+// Advertising controller task procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Decays to the next phase once the active phase has expired and sends the pending
+// interval command. Commands are only issued in command mode; a failed command is
+// retried on the next call. Call periodically from the main loop.
+// -----------------------------------------------------------------------------------
+void advControllerTask(void) {
+    uint8_t phase = advController.current;
+    if (phase == ADV_PHASE_OFF) return;
+
+    uint32_t duration = advController.phases[phase].duration;
+    if (duration != 0 && phase + 1 < advController.phaseCount &&
+        millis() - advController.phaseStart >= duration) {
+        enterPhase(phase + 1); // Decay to the next, slower phase
+        phase = advController.current;
+    }
+
+    if (advController.pending && getOperationMode() == cmdMode) {
+        if (startCustomAdvertising(advController.phases[phase].interval)) {
+            advController.pending = false;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Get advertising phase procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint8_t - Active phase index or ADV_PHASE_OFF
+// Returns the phase the controller is currently in.
+// -----------------------------------------------------------------------------------
+uint8_t advControllerGetPhase(void) {
+    return advController.current;
+}
+
+// -----------------------------------------------------------------------------------
+// Get phase time procedure
+// -----------------------------------------------------------------------------------
+// Input : phase - Phase index or ADV_PHASE_OFF
+// Output: uint32_t - Total time spent in the phase in ms
+// Returns the accumulated residency of a phase, including the running one.
+// -----------------------------------------------------------------------------------
+uint32_t advControllerGetPhaseTime(uint8_t phase) {
+    if (phase != ADV_PHASE_OFF && phase >= ADV_MAX_PHASES) return 0;
+
+    uint32_t total = advController.phaseTime[phaseBucket(phase)];
+    if (phase == advController.current) {
+        total += millis() - advController.phaseStart; // Add the running phase
+    }
+    return total;
+}
+
+// -----------------------------------------------------------------------------------
+// Reset phase statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Clears the accumulated phase residency counters.
+// -----------------------------------------------------------------------------------
+void advControllerResetStats(void) {
+    memset(advController.phaseTime, 0, sizeof(advController.phaseTime));
+    advController.phaseStart = millis();
+}
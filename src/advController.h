@@ -0,0 +1,47 @@
+/*
+ * advController.h
+ *
+ * Created: 18-10-2026 05:41:34
+ * Author: Subrata
+ * Description: Header file for the adaptive advertising controller of the RN4871
+ *              BLE library. Runs fast advertising bursts after boot, disconnect or
+ *              a user trigger and decays through configurable phases to a
+ *              long-interval background mode.
+ */
+
+#ifndef ADVCONTROLLER_H_
+#define ADVCONTROLLER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Maximum number of configurable advertising phases
+#define ADV_MAX_PHASES 4
+// Phase index reported while not advertising (stopped or connected)
+#define ADV_PHASE_OFF  0xFF
+
+typedef struct {
+    uint16_t interval; // Advertising interval passed to startCustomAdvertising
+    uint32_t duration; // Time spent in the phase in ms, 0 = remain in this phase
+} advPhaseConfig_t;
+
+typedef struct {
+    advPhaseConfig_t phases[ADV_MAX_PHASES]; // Phase table, fastest first
+    uint8_t phaseCount;                      // Number of valid phases
+    uint8_t current;                         // Active phase or ADV_PHASE_OFF
+    bool pending;                            // Interval command still to be sent
+    uint32_t phaseStart;                     // millis() at entry of the active phase
+    uint32_t phaseTime[ADV_MAX_PHASES + 1];  // Accumulated ms per phase, last entry = off
+} advController_t;
+
+extern advController_t advController;
+
+void advControllerInit(const advPhaseConfig_t* phases, uint8_t count);
+void advControllerBurst(void);
+void advControllerSuspend(void);
+void advControllerTask(void);
+uint8_t advControllerGetPhase(void);
+uint32_t advControllerGetPhaseTime(uint8_t phase);
+void advControllerResetStats(void);
+
+#endif /* ADVCONTROLLER_H_ */
@@ -0,0 +1,126 @@
+/*
+ * beacon.cpp
+ *
+ * Created: 18-10-2026 05:46:59
+ * Author: Subrata
+ * Description: Implementation of the autonomous beacon mode for the RN4871 BLE
+ *              module. Configures the beacon payload once, refreshes it through
+ *              incremental IB updates and keeps the MCU in power-down in between.
+ */
+
+#include "beacon.h"
+#include "rn4871.h"
+#include "crc16.h"
+#include <string.h>
+
+beacon_t beacon;
+
+// -----------------------------------------------------------------------------------
+// Forget AD slots procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Marks all tracked AD structures as unsent so the next update resends them.
+// -----------------------------------------------------------------------------------
+static void forgetSlots(void) {
+    memset(beacon.slots, 0, sizeof(beacon.slots));
+}
+
+// -----------------------------------------------------------------------------------
+// Beacon setup procedure
+// -----------------------------------------------------------------------------------
+// Input : adType - Advertising type, adData - Initial advertising data as hex string
+// Output: bool - True if successful, false otherwise
+// Enables beaconing and stores the initial payload permanently on the module. Run
+// once in command mode; the module beacons on its own after the next reboot.
+// -----------------------------------------------------------------------------------
+bool beaconSetup(uint8_t adType, const char adData[]) {
+    forgetSlots();
+    return setBeaconFeatures(BEACON_ON) &&
+           clearPermanentBeacon() &&
+           startPermanentBeacon(adType, adData);
+}
+
+// -----------------------------------------------------------------------------------
+// Beacon update procedure
+// -----------------------------------------------------------------------------------
+// Input : adType - Advertising type, adData - Advertising data as hex string
+// Output: bool - True if the module holds the data, false otherwise
+// Refreshes one AD structure of the running beacon with an IB command. The command
+// is skipped when the data is unchanged since the last refresh of the same type.
+// -----------------------------------------------------------------------------------
+bool beaconUpdate(uint8_t adType, const char adData[]) {
+    uint16_t crc = crc16String(crc16Update(CRC16_INIT, adType), adData);
+    beaconAdSlot_t* slot = NULL;
+
+    for (uint8_t i = 0; i < BEACON_MAX_AD_SLOTS; i++) {
+        if (beacon.slots[i].used && beacon.slots[i].adType == adType) {
+            slot = &beacon.slots[i]; // Known AD type
+            break;
+        }
+        if (!beacon.slots[i].used && slot == NULL) {
+            slot = &beacon.slots[i]; // First free slot
+        }
+    }
+
+    if (slot != NULL && slot->used && slot->crc == crc) {
+        beacon.skippedUpdates++;
+        return true; // Module already beacons this data
+    }
+
+    if (!startImmediateBeacon(adType, adData)) {
+        return false;
+    }
+    beacon.sentUpdates++;
+    if (slot != NULL) {
+        slot->used = true;
+        slot->adType = adType;
+        slot->crc = crc;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Beacon clear procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if successful, false otherwise
+// Clears the immediate beacon payload and forgets the tracked AD structures.
+// -----------------------------------------------------------------------------------
+bool beaconClear(void) {
+    forgetSlots();
+    return clearImmediateBeacon();
+}
+
+// -----------------------------------------------------------------------------------
+// Set refresh period procedure
+// -----------------------------------------------------------------------------------
+// Input : period - Time between payload refreshes in ms
+// Output: void
+// Sets the refresh schedule and starts a new refresh cycle.
+// -----------------------------------------------------------------------------------
+void beaconSetRefreshPeriod(uint32_t period) {
+    beacon.refreshPeriod = period;
+    beacon.lastRefresh = millis();
+}
+
+// -----------------------------------------------------------------------------------
+// Sleep until refresh procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Waits for pending UART output and keeps the MCU in power-down for the remainder of
+// the refresh cycle. The module stays in command mode and beacons on its own, so the
+// next refresh needs no mode change. Cycles keep their cadence unless overrun.
+// -----------------------------------------------------------------------------------
+void beaconSleepUntilRefresh(void) {
+    uint32_t elapsed = millis() - beacon.lastRefresh;
+
+    if (elapsed < beacon.refreshPeriod) {
+        bleTxWait(); // Do not cut the last command short
+        powerDown(beacon.refreshPeriod - elapsed);
+        beacon.lastRefresh += beacon.refreshPeriod;
+    } else {
+        beacon.lastRefresh = millis(); // Overrun, restart the schedule
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * beacon.h
+ *
+ * Created: 18-10-2026 05:46:28
+ * Author: Subrata
+ * Description: Header file for the autonomous beacon mode of the RN4871 BLE
+ *              library. The module beacons on its own while the ATmega328PB stays
+ *              in power-down between scheduled payload refreshes.
+ */
+
+#ifndef BEACON_H_
+#define BEACON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of AD structures tracked for incremental payload updates
+#define BEACON_MAX_AD_SLOTS 3
+
+typedef struct {
+    bool used;      // Slot holds a sent AD structure
+    uint8_t adType; // AD type of the structure
+    uint16_t crc;   // Fingerprint of the last data sent for this type
+} beaconAdSlot_t;
+
+typedef struct {
+    beaconAdSlot_t slots[BEACON_MAX_AD_SLOTS]; // Last sent AD structures
+    uint32_t refreshPeriod;                    // Time between payload refreshes in ms
+    uint32_t lastRefresh;                      // millis() at the start of the refresh cycle
+    uint16_t sentUpdates;                      // IB commands sent
+    uint16_t skippedUpdates;                   // Refreshes skipped as data was unchanged
+} beacon_t;
+
+extern beacon_t beacon;
+
+bool beaconSetup(uint8_t adType, const char adData[]);
+bool beaconUpdate(uint8_t adType, const char adData[]);
+bool beaconClear(void);
+void beaconSetRefreshPeriod(uint32_t period);
+void beaconSleepUntilRefresh(void);
+
+#endif /* BEACON_H_ */
@@ -4,10 +4,25 @@
  * Created: 09-07-2025 11:39:17
  * Author: Subrata
  * Description: Implementation of UART communication for the RN4871 BLE module
- *              using UART0 on the ATmega328PB microcontroller.
+ *              using USART0 or USART1 of the ATmega328PB. The API is a thin
+ *              layer over the HAL serial driver instantiated for the USART chosen
+ *              with BLE_USART, so every call inlines to direct register accesses.
  */
 
 #include "bleSerial.h"
+#include "hal.h"
+#include "cpuLoad.h"
+#include "energyModel.h"
+
+#if BLE_USART == 1
+typedef BleSerialDriver<AvrUsart1, AvrClock> bleDriver;
+#define BLE_RX_vect   USART1_RX_vect
+#define BLE_UDRE_vect USART1_UDRE_vect
+#else
+typedef BleSerialDriver<AvrUsart0, AvrClock> bleDriver;
+#define BLE_RX_vect   USART0_RX_vect
+#define BLE_UDRE_vect USART0_UDRE_vect
+#endif
 
 ble_uart_t ble;
 
@@ -16,21 +31,12 @@ ble_uart_t ble;
 // -----------------------------------------------------------------------------------
 // Input : None
 // Output: void
-// Configures UART0 for communication with the RN4871 at 9600 baud, initializing
+// Configures the USART for communication with the RN4871 at 9600 baud, initializing
 // ring buffers and enabling UART interrupts.
 // -----------------------------------------------------------------------------------
 void bleInit(void) {
     if (ble.initialized) return;
-
-    RingBuffer_init(&ble.rx_buffer, ble.rx_storage, BLE_BUFFER_SIZE); // Initialize receive buffer
-    RingBuffer_init(&ble.tx_buffer, ble.tx_storage, BLE_BUFFER_SIZE); // Initialize transmit buffer
-
-    UBRR0 = BLE_UBRR_VALUE; // Set baud rate
-    UCSR0A = (1 << U2X0); // Enable double speed mode
-    UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0) | (1 << UDRIE0); // Enable RX, TX, interrupts
-    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // Set 8-bit data, no parity, 1 stop bit
-
-    ble.initialized = true;
+    bleDriver::init(ble);
 }
 
 // -----------------------------------------------------------------------------------
@@ -41,7 +47,7 @@ void bleInit(void) {
 // Returns the number of bytes available in the UART receive buffer.
 // -----------------------------------------------------------------------------------
 int bleAvailable(void) {
-    return RingBuffer_available(&ble.rx_buffer);
+    return bleDriver::available(ble);
 }
 
 // -----------------------------------------------------------------------------------
@@ -52,11 +58,7 @@ int bleAvailable(void) {
 // Reads a single byte from the UART receive buffer, returning -1 if empty.
 // -----------------------------------------------------------------------------------
 int bleRead(void) {
-    char data;
-    if (!RingBuffer_pop(&ble.rx_buffer, &data)) {
-        return -1; // Buffer empty
-    }
-    return (int)data;
+    return bleDriver::read(ble);
 }
 
 // -----------------------------------------------------------------------------------
@@ -67,19 +69,8 @@ int bleRead(void) {
 // Reads up to the specified number of bytes from the UART receive buffer with a timeout.
 // -----------------------------------------------------------------------------------
 size_t bleReadBytes(char* buffer, uint16_t length) {
-    size_t bytesRead = 0;
-    uint32_t start = millis();
-    const uint16_t timeout = 1000;
-
-    while (bytesRead < length && (millis() - start < timeout)) {
-        if (bleAvailable()) {
-            int c = bleRead();
-            if (c != -1) {
-                buffer[bytesRead++] = (char)c;
-            }
-        }
-    }
-    return bytesRead;
+    CPU_WAIT_SCOPE();
+    return bleDriver::readBytes(ble, buffer, length);
 }
 
 // -----------------------------------------------------------------------------------
@@ -90,10 +81,10 @@ size_t bleReadBytes(char* buffer, uint16_t length) {
 // Writes a single byte to the UART transmit buffer and enables the transmit interrupt.
 // -----------------------------------------------------------------------------------
 bool blePrint(uint8_t data) {
-    if (!RingBuffer_push(&ble.tx_buffer, (char)data)) {
-        return false; // Buffer full
+    if (!bleDriver::write(ble, data)) {
+        return false;
     }
-    UCSR0B |= (1 << UDRIE0); // Enable transmit interrupt
+    ENERGY_TX_BYTE();
     return true;
 }
 
@@ -105,11 +96,7 @@ bool blePrint(uint8_t data) {
 // Writes a single character to the UART transmit buffer and enables the transmit interrupt.
 // -----------------------------------------------------------------------------------
 bool blePrintChar(char data) {
-    if (!RingBuffer_push(&ble.tx_buffer, data)) {
-        return false; // Buffer full
-    }
-    UCSR0B |= (1 << UDRIE0); // Enable transmit interrupt
-    return true;
+    return blePrint((uint8_t)data);
 }
 
 // -----------------------------------------------------------------------------------
@@ -120,8 +107,10 @@ bool blePrintChar(char data) {
 // Writes a null-terminated string to the UART transmit buffer, sending each character.
 // -----------------------------------------------------------------------------------
 void blePrintString(const char* str) {
+    CPU_WAIT_SCOPE(); // Mostly waiting for buffer room
     while (*str) {
-        while (!blePrintChar(*str++)); // Send character, wait if buffer full
+        while (!blePrintChar(*str)); // Send character, wait if buffer full
+        str++;
     }
 }
 
@@ -145,9 +134,20 @@ void blePrintStringln(const char* str) {
 // Clears the UART transmit buffer and disables the transmit interrupt.
 // -----------------------------------------------------------------------------------
 void bleTxFlush(void) {
-    UCSR0B &= ~(1 << UDRIE0); // Disable transmit interrupt
-    ble.tx_buffer.head = 0; // Reset buffer pointers
-    ble.tx_buffer.tail = 0;
+    bleDriver::txFlush(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Wait for transmit completion procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Blocks until the transmit buffer is empty and the last byte has left the shift
+// register, so the MCU can sleep without cutting a command short.
+// -----------------------------------------------------------------------------------
+void bleTxWait(void) {
+    CPU_WAIT_SCOPE();
+    bleDriver::txWait(ble);
 }
 
 // -----------------------------------------------------------------------------------
@@ -158,8 +158,22 @@ void bleTxFlush(void) {
 // Clears the UART receive buffer by resetting its pointers.
 // -----------------------------------------------------------------------------------
 void bleRxFlush(void) {
-    ble.rx_buffer.head = 0; // Reset buffer pointers
-    ble.rx_buffer.tail = 0;
+    bleDriver::rxFlush(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Reset buffer statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Clears the high-water marks and the overrun count, which the receive interrupt
+// also updates.
+// -----------------------------------------------------------------------------------
+void bleResetStats(void) {
+    uint8_t oldSREG = SREG;
+    cli(); // Overrun count is wider than one byte
+    bleDriver::resetStats(ble);
+    SREG = oldSREG;
 }
 
 // -----------------------------------------------------------------------------------
@@ -169,9 +183,10 @@ void bleRxFlush(void) {
 // Output: void
 // Handles incoming UART data by pushing it to the receive ring buffer.
 // -----------------------------------------------------------------------------------
-ISR(USART0_RX_vect) {
-    char data = (char)UDR0; // Read incoming byte
-    RingBuffer_push(&ble.rx_buffer, data); // Push to buffer, ignore if full
+ISR(BLE_RX_vect) {
+    CPU_ISR_ENTER();
+    bleDriver::onReceive(ble);
+    CPU_ISR_LEAVE();
 }
 
 // -----------------------------------------------------------------------------------
@@ -181,11 +196,8 @@ ISR(USART0_RX_vect) {
 // Output: void
 // Sends the next byte from the transmit buffer when the UART data register is empty.
 // -----------------------------------------------------------------------------------
-ISR(USART0_UDRE_vect) {
-    char data;
-    if (RingBuffer_pop(&ble.tx_buffer, &data)) {
-        UDR0 = (uint8_t)data; // Send byte
-    } else {
-        UCSR0B &= ~(1 << UDRIE0); // Disable interrupt if buffer empty
-    }
+ISR(BLE_UDRE_vect) {
+    CPU_ISR_ENTER();
+    bleDriver::onTxReady(ble);
+    CPU_ISR_LEAVE();
 }
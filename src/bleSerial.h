@@ -4,15 +4,18 @@
  * Created: 09-07-2025 11:39:06
  * Author: Subrata
  * Description: Header file for UART communication with the RN4871 BLE module
- *              using UART0 on the ATmega328PB microcontroller.
+ *              using USART0 (or USART1, see BLE_USART) on the ATmega328PB.
  */
 
 #ifndef BLESERIAL_H_
 #define BLESERIAL_H_
 
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#endif
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "ringBuffer.h"
 #include "wiring.h"
@@ -20,7 +23,13 @@
 // 8 MHz clock frequency
 #define F_CPU 8000000UL
 // UART baud rate
+#ifndef BLE_BAUD
 #define BLE_BAUD 9600
+#endif
+// USART connected to the module on the AVR, 0 or 1
+#ifndef BLE_USART
+#define BLE_USART 0
+#endif
 // Baud rate register value
 #define BLE_UBRR_VALUE ((F_CPU / (8UL * BLE_BAUD)) - 1)
 // Buffer size for UART communication
@@ -32,6 +41,9 @@ typedef struct {
     RingBuffer_t tx_buffer;         // Transmit ring buffer
     uint8_t rx_storage[BLE_BUFFER_SIZE]; // Receive buffer storage
     uint8_t tx_storage[BLE_BUFFER_SIZE]; // Transmit buffer storage
+    uint8_t rxHighWater;             // Most bytes ever waiting in the receive buffer
+    uint8_t txHighWater;             // Most bytes ever waiting in the transmit buffer
+    uint16_t rxOverruns;             // Bytes lost because the receive buffer was full
 } ble_uart_t;
 
 extern ble_uart_t ble;
@@ -44,7 +56,27 @@ bool blePrintChar(char data);
 void blePrintString(const char* str);
 void blePrintStringln(const char* str);
 void bleTxFlush(void);
+void bleTxWait(void);
 void bleRxFlush(void);
 size_t bleReadBytes(char* buffer, uint16_t length);
+void bleResetStats(void);
+
+#if !defined(__AVR__)
+typedef struct {
+    int (*read)(void* ctx, uint8_t* data, int length);        // Received bytes, 0 if none
+    int (*write)(void* ctx, const uint8_t* data, int length); // Bytes accepted
+    void (*wait)(void* ctx, bool forWrite, int timeout);      // Wait for activity up to timeout ms
+    void* ctx;                                                // Transport context
+} bleTransport_t;
+
+// Observer of the byte stream, transmit is true for bytes sent to the module
+typedef void (*bleTap_t)(void* ctx, bool transmit, const uint8_t* data, uint16_t length);
+
+void bleSetDevice(const char* device);
+bool bleConfigureFd(int fd);
+bool bleInitFd(int fd);
+void bleSetTransport(const bleTransport_t* custom);
+void bleSetTap(bleTap_t newTap, void* ctx);
+#endif
 
 #endif /* BLESERIAL_H_ */
@@ -0,0 +1,315 @@
+/*
+ * cmdEngine.cpp
+ *
+ * Created: 18-10-2026 05:53:41
+ * Author: Subrata
+ * Description: Implementation of the non-blocking command engine for the RN4871
+ *              BLE module. Received bytes are split into response lines, prompts
+ *              and %...% events; each completed response releases the next queued
+ *              command immediately.
+ */
+
+#include "cmdEngine.h"
+#include "rn4871_const.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------------
+// Advance clock procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, now - Current time in ms
+// Output: void
+// Moves the engine clock forward only, so a stale timestamp from the caller never
+// makes a command look older than it is.
+// -----------------------------------------------------------------------------------
+static void advanceClock(cmdEngine_t* engine, uint32_t now) {
+    if ((int32_t)(now - engine->now) > 0) {
+        engine->now = now;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Send active command procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine
+// Output: void
+// Transmits the oldest queued command if none is in flight.
+// -----------------------------------------------------------------------------------
+static void sendNext(cmdEngine_t* engine) {
+    if (engine->active || engine->count == 0) return;
+
+    cmdRequest_t* request = &engine->queue[engine->head];
+    engine->active = true;
+    engine->sentAt = engine->now;
+    engine->write(engine->writeCtx, request->command, (uint16_t)strlen(request->command));
+    if (!(request->flags & CMD_FLAG_RAW)) {
+        engine->write(engine->writeCtx, "\r", 1); // Append carriage return
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Complete command procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, status - Final status, line - Response line or NULL
+// Output: void
+// Records statistics, releases the in-flight command, reports the result and sends
+// the next queued command. The callback may submit further commands.
+// -----------------------------------------------------------------------------------
+static void complete(cmdEngine_t* engine, cmdStatus_t status, const char* line) {
+    cmdRequest_t request = engine->queue[engine->head];
+    uint32_t latency = engine->now - engine->sentAt;
+
+    engine->stats.commands++;
+    if (status == cmdError) engine->stats.errors++;
+    if (status == cmdTimeout) engine->stats.timeouts++;
+    engine->stats.latencyTotal += latency;
+    if (latency > engine->stats.latencyMax) {
+        engine->stats.latencyMax = latency;
+    }
+    if (engine->onComplete != NULL) {
+        engine->onComplete(engine->traceCtx, request.command, status, latency);
+    }
+
+    engine->head = (engine->head + 1) % CMD_QUEUE_SIZE;
+    engine->count--;
+    engine->active = false;
+
+    if (request.callback != NULL) {
+        request.callback(request.ctx, status, line);
+    }
+    sendNext(engine); // Pipeline the next command without waiting for the caller
+}
+
+// -----------------------------------------------------------------------------------
+// Handle line procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, line - Complete response line
+// Output: void
+// Applies a response line to the in-flight command; lines without a command in
+// flight are handed to the event handler.
+// -----------------------------------------------------------------------------------
+static void handleLine(cmdEngine_t* engine, const char* line) {
+    if (!engine->active) {
+        if (engine->onEvent != NULL) {
+            engine->onEvent(engine->eventCtx, line); // Unsolicited line
+        }
+        return;
+    }
+
+    cmdRequest_t* request = &engine->queue[engine->head];
+    switch (request->match) {
+        case cmdMatchList:
+            if (strcmp(line, PROMPT_END) == 0) {
+                complete(engine, cmdOk, line);
+            } else if (request->callback != NULL) {
+                request->callback(request->ctx, cmdPending, line); // Stream listing line
+            }
+            break;
+        case cmdMatchLine:
+            if (request->expect == NULL || strstr(line, request->expect) != NULL) {
+                complete(engine, cmdOk, line);
+            } else {
+                complete(engine, cmdError, line);
+            }
+            break;
+        case cmdMatchPrompt:
+            break; // Only the prompt completes the command
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Command engine initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, write - Output function, writeCtx - Output context
+// Output: void
+// Resets the engine; write is called with each command to transmit.
+// -----------------------------------------------------------------------------------
+void cmdInit(cmdEngine_t* engine, cmdWrite_t write, void* writeCtx) {
+    memset(engine, 0, sizeof(*engine));
+    engine->write = write;
+    engine->writeCtx = writeCtx;
+}
+
+// -----------------------------------------------------------------------------------
+// Set event handler procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, onEvent - Handler, ctx - Handler context
+// Output: void
+// Registers the handler for %...% events and lines received with no command in flight.
+// -----------------------------------------------------------------------------------
+void cmdSetEventHandler(cmdEngine_t* engine, cmdEvent_t onEvent, void* ctx) {
+    engine->onEvent = onEvent;
+    engine->eventCtx = ctx;
+}
+
+// -----------------------------------------------------------------------------------
+// Set trace handler procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, onComplete - Observer, ctx - Observer context
+// Output: void
+// Registers an observer told of every completed command with its status and round
+// trip, before the command's own callback runs.
+// -----------------------------------------------------------------------------------
+void cmdSetTraceHandler(cmdEngine_t* engine, cmdTrace_t onComplete, void* ctx) {
+    engine->onComplete = onComplete;
+    engine->traceCtx = ctx;
+}
+
+// -----------------------------------------------------------------------------------
+// Submit command procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, command - Command text, expect - Success substring,
+//         match - Completion rule, timeout - Timeout in ms, callback - Result callback,
+//         ctx - Callback context
+// Output: bool - True if queued, false if the queue is full or the command too long
+// Queues a command terminated by a carriage return; it is sent at once when the
+// engine is idle, otherwise as soon as the previous command completes.
+// -----------------------------------------------------------------------------------
+bool cmdSubmit(cmdEngine_t* engine, const char* command, const char* expect, cmdMatch_t match,
+               uint16_t timeout, cmdCallback_t callback, void* ctx) {
+    return cmdSubmitRaw(engine, command, expect, match, 0, timeout, callback, ctx);
+}
+
+// -----------------------------------------------------------------------------------
+// Submit command with flags procedure
+// -----------------------------------------------------------------------------------
+// Input : As cmdSubmit, flags - CMD_FLAG_* bits
+// Output: bool - True if queued, false if the queue is full or the command too long
+// Queues a command with explicit flags, e.g. CMD_FLAG_RAW for the $$$ sequence.
+// -----------------------------------------------------------------------------------
+bool cmdSubmitRaw(cmdEngine_t* engine, const char* command, const char* expect, cmdMatch_t match,
+                  uint8_t flags, uint16_t timeout, cmdCallback_t callback, void* ctx) {
+    if (engine->count >= CMD_QUEUE_SIZE || strlen(command) >= CMD_COMMAND_SIZE) {
+        return false;
+    }
+
+    cmdRequest_t* request = &engine->queue[(engine->head + engine->count) % CMD_QUEUE_SIZE];
+    strcpy(request->command, command);
+    request->expect = expect;
+    request->match = match;
+    request->flags = flags;
+    request->timeout = timeout;
+    request->callback = callback;
+    request->ctx = ctx;
+    engine->count++;
+    sendNext(engine);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Feed received bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, data - Received bytes, length - Byte count,
+//         now - Current time in ms
+// Output: void
+// Splits received bytes into lines, prompts and events. A prompt at the start of a
+// line is consumed, so a response following a late prompt is still recognized.
+// -----------------------------------------------------------------------------------
+void cmdFeed(cmdEngine_t* engine, const uint8_t* data, uint16_t length, uint32_t now) {
+    advanceClock(engine, now);
+
+    for (uint16_t i = 0; i < length; i++) {
+        char c = (char)data[i];
+
+        if (engine->inEvent) {
+            if (c == '%') {
+                engine->line[engine->lineLen] = '\0';
+                engine->lineLen = 0;
+                engine->inEvent = false;
+                engine->stats.events++;
+                if (engine->onEvent != NULL) {
+                    engine->onEvent(engine->eventCtx, engine->line);
+                }
+            } else if (engine->lineLen < CMD_LINE_SIZE - 1) {
+                engine->line[engine->lineLen++] = c;
+            } else {
+                engine->stats.overflows++;
+            }
+            continue;
+        }
+
+        if (c == '%' && engine->lineLen == 0) {
+            engine->inEvent = true; // Start of an asynchronous event
+        } else if (c == CR) {
+            continue;
+        } else if (c == LF) {
+            engine->line[engine->lineLen] = '\0';
+            if (engine->lineLen > 0) {
+                engine->lineLen = 0;
+                handleLine(engine, engine->line);
+            }
+        } else if (engine->lineLen < CMD_LINE_SIZE - 1) {
+            engine->line[engine->lineLen++] = c;
+            if (engine->lineLen == sizeof(PROMPT) - 1 && memcmp(engine->line, PROMPT, sizeof(PROMPT) - 1) == 0) {
+                engine->lineLen = 0; // Prompt consumed
+                if (engine->active && engine->queue[engine->head].match == cmdMatchPrompt) {
+                    complete(engine, cmdOk, PROMPT);
+                }
+            }
+        } else {
+            engine->stats.overflows++;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Poll timeouts procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, now - Current time in ms
+// Output: void
+// Completes the in-flight command with a timeout once its deadline has passed.
+// -----------------------------------------------------------------------------------
+void cmdPoll(cmdEngine_t* engine, uint32_t now) {
+    advanceClock(engine, now);
+    if (engine->active && engine->now - engine->sentAt >= engine->queue[engine->head].timeout) {
+        engine->lineLen = 0; // Drop a partial line of the failed response
+        engine->inEvent = false;
+        complete(engine, cmdTimeout, NULL);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Time to deadline procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, now - Current time in ms
+// Output: int32_t - Milliseconds until the in-flight command times out, -1 if idle
+// Lets an event loop sleep exactly until the next timeout.
+// -----------------------------------------------------------------------------------
+int32_t cmdTimeToDeadline(const cmdEngine_t* engine, uint32_t now) {
+    if (!engine->active) return -1;
+
+    int32_t elapsed = (int32_t)(now - engine->sentAt);
+    if (elapsed < 0) elapsed = 0;
+    uint16_t timeout = engine->queue[engine->head].timeout;
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+}
+
+// -----------------------------------------------------------------------------------
+// Engine idle procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine
+// Output: bool - True if no command is queued or in flight
+// -----------------------------------------------------------------------------------
+bool cmdIdle(const cmdEngine_t* engine) {
+    return engine->count == 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Detach procedure
+// -----------------------------------------------------------------------------------
+// Input : engine - Command engine, ctx - Callback context to forget
+// Output: bool - True if a queued command used the context
+// Clears the callback of every queued command with this context, so the context may
+// be freed. The commands themselves still run and are counted in the statistics.
+// -----------------------------------------------------------------------------------
+bool cmdDetach(cmdEngine_t* engine, void* ctx) {
+    bool found = false;
+
+    for (uint8_t i = 0; i < engine->count; i++) {
+        cmdRequest_t* request = &engine->queue[(engine->head + i) % CMD_QUEUE_SIZE];
+        if (request->callback != NULL && request->ctx == ctx) {
+            request->callback = NULL;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,104 @@
+/*
+ * cmdEngine.h
+ *
+ * Created: 18-10-2026 05:52:59
+ * Author: Subrata
+ * Description: Header file for the non-blocking command engine of the RN4871 BLE
+ *              library. Queues commands, pipelines them to the module as soon as
+ *              the previous response completes and separates responses from
+ *              asynchronous events, without ever waiting on the UART.
+ */
+
+#ifndef CMDENGINE_H_
+#define CMDENGINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of queued commands per engine
+#ifndef CMD_QUEUE_SIZE
+#define CMD_QUEUE_SIZE   8
+#endif
+// Maximum command length including the terminator
+#ifndef CMD_COMMAND_SIZE
+#define CMD_COMMAND_SIZE 80
+#endif
+// Maximum response line length including the terminator
+#ifndef CMD_LINE_SIZE
+#define CMD_LINE_SIZE    128
+#endif
+
+// Command flags
+#define CMD_FLAG_RAW     0x01 // Send without the trailing carriage return ($$$)
+
+typedef enum {
+    cmdPending, // Intermediate listing line, more to follow
+    cmdOk,      // Expected response received
+    cmdError,   // Other response received
+    cmdTimeout  // No response within the timeout
+} cmdStatus_t;
+
+typedef enum {
+    cmdMatchLine,   // First response line completes the command
+    cmdMatchPrompt, // Command prompt completes the command
+    cmdMatchList    // Lines are streamed until the END line
+} cmdMatch_t;
+
+typedef void (*cmdCallback_t)(void* ctx, cmdStatus_t status, const char* line);
+typedef void (*cmdWrite_t)(void* ctx, const char* data, uint16_t length);
+typedef void (*cmdEvent_t)(void* ctx, const char* event);
+typedef void (*cmdTrace_t)(void* ctx, const char* command, cmdStatus_t status, uint32_t latency);
+
+typedef struct {
+    char command[CMD_COMMAND_SIZE]; // Command text without carriage return
+    const char* expect;             // Substring marking success, NULL accepts any line
+    cmdMatch_t match;               // Completion rule
+    uint8_t flags;                  // CMD_FLAG_* bits
+    uint16_t timeout;               // Response timeout in ms
+    cmdCallback_t callback;         // Completion callback, may be NULL
+    void* ctx;                      // Callback context
+} cmdRequest_t;
+
+typedef struct {
+    uint32_t commands;     // Commands completed
+    uint32_t errors;       // Commands completed with another response
+    uint32_t timeouts;     // Commands without response
+    uint32_t events;       // Events received
+    uint32_t latencyTotal; // Sum of command round trips in ms
+    uint32_t latencyMax;   // Longest command round trip in ms
+    uint32_t overflows;    // Received characters dropped from overlong lines
+} cmdStats_t;
+
+typedef struct {
+    cmdRequest_t queue[CMD_QUEUE_SIZE]; // Pending commands, queue[head] is in flight
+    uint8_t head;                       // Index of the oldest command
+    uint8_t count;                      // Commands in the queue
+    bool active;                        // Oldest command has been sent
+    uint32_t sentAt;                    // Time the active command was sent
+    uint32_t now;                       // Time of the last feed or poll
+    char line[CMD_LINE_SIZE];           // Line being assembled
+    uint8_t lineLen;                    // Characters in the line
+    bool inEvent;                       // Between the % delimiters of an event
+    cmdWrite_t write;                   // Output to the module
+    void* writeCtx;                     // Output context
+    cmdEvent_t onEvent;                 // Event and unsolicited line handler, may be NULL
+    void* eventCtx;                     // Event handler context
+    cmdTrace_t onComplete;              // Completion observer, may be NULL
+    void* traceCtx;                     // Completion observer context
+    cmdStats_t stats;                   // Command statistics
+} cmdEngine_t;
+
+void cmdInit(cmdEngine_t* engine, cmdWrite_t write, void* writeCtx);
+void cmdSetEventHandler(cmdEngine_t* engine, cmdEvent_t onEvent, void* ctx);
+void cmdSetTraceHandler(cmdEngine_t* engine, cmdTrace_t onComplete, void* ctx);
+bool cmdSubmit(cmdEngine_t* engine, const char* command, const char* expect, cmdMatch_t match,
+               uint16_t timeout, cmdCallback_t callback, void* ctx);
+bool cmdSubmitRaw(cmdEngine_t* engine, const char* command, const char* expect, cmdMatch_t match,
+                  uint8_t flags, uint16_t timeout, cmdCallback_t callback, void* ctx);
+void cmdFeed(cmdEngine_t* engine, const uint8_t* data, uint16_t length, uint32_t now);
+void cmdPoll(cmdEngine_t* engine, uint32_t now);
+int32_t cmdTimeToDeadline(const cmdEngine_t* engine, uint32_t now);
+bool cmdIdle(const cmdEngine_t* engine);
+bool cmdDetach(cmdEngine_t* engine, void* ctx);
+
+#endif /* CMDENGINE_H_ */
@@ -0,0 +1,186 @@
+/*
+ * cpuLoad.cpp
+ *
+ * Created: 18-10-2026 07:01:22
+ * Author: Subrata
+ * Description: Implementation of CPU utilisation accounting for the RN4871 BLE
+ *              library. Time is read from Timer0 in 8 us ticks and charged to the
+ *              active bucket whenever the bucket changes. Interrupt time is measured
+ *              inside each handler; as the handlers run at random points of the
+ *              Timer0 period the tick differences are unbiased on average. The
+ *              interrupt share is taken out of the bucket that was interrupted.
+ *              Accounting must see a bucket change or a query at least once an hour,
+ *              as the microsecond clock wraps after 71 minutes.
+ */
+
+#include "cpuLoad.h"
+
+#if defined(CPU_ACCOUNTING)
+#include "wiring.h"
+#include <string.h>
+
+#define SLOT_US ((uint32_t)CPU_LOAD_SLOT_MS * 1000UL)
+
+#if defined(__AVR__)
+// Timer0 runs with prescaler 64
+#define MICROS_PER_TICK (64UL / (F_CPU / 1000000UL))
+
+volatile uint32_t cpuIsrTicks = 0;
+static uint32_t isrSeen = 0; // Interrupt ticks already charged
+#endif
+
+static uint32_t slots[CPU_LOAD_SLOTS][CPU_BUCKETS]; // Time per bucket in us
+static uint8_t slot = 0;                          // Slot being filled
+static uint32_t slotStart = 0;                    // Clock at the start of that slot
+static uint32_t lastCharge = 0;                   // Clock of the last charge
+static uint32_t stoppedUs = 0;                    // Time Timer0 was stopped in sleep
+static cpuBucket_t current = cpuApp;              // Bucket time is charged to
+
+// -----------------------------------------------------------------------------------
+// Microsecond clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint32_t - Time in us, including power-down sleep
+// Combines the Timer0 overflow count and counter; the host port uses millis().
+// -----------------------------------------------------------------------------------
+static uint32_t cpuMicros(void) {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli(); // Overflow count and counter must match
+    uint32_t overflows = timer0_overflow_count;
+    uint8_t ticks = TCNT0;
+    if ((TIFR0 & (1 << TOV0)) && ticks < 255) {
+        overflows++; // Overflow not yet handled
+    }
+    SREG = oldSREG;
+    return ((overflows << 8) + ticks) * MICROS_PER_TICK + stoppedUs;
+#else
+    return (uint32_t)millis() * 1000UL + stoppedUs;
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Interrupt time procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint32_t - Interrupt time in us since the last call
+// -----------------------------------------------------------------------------------
+static uint32_t takeIsrTime(void) {
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli(); // Counter is wider than one byte
+    uint32_t ticks = cpuIsrTicks;
+    SREG = oldSREG;
+    uint32_t us = (ticks - isrSeen) * MICROS_PER_TICK;
+    isrSeen = ticks;
+    return us;
+#else
+    return 0; // No interrupts on the host port
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Account procedure
+// -----------------------------------------------------------------------------------
+// Input : now - Current clock in us
+// Output: void
+// Charges the time since the last charge to the current bucket, closing every slot
+// that ended in between; the interrupt time is taken from the newest slot.
+// -----------------------------------------------------------------------------------
+static void account(uint32_t now) {
+    uint32_t isr = takeIsrTime();
+
+    while (now - slotStart >= SLOT_US) {
+        uint32_t part = slotStart + SLOT_US - lastCharge; // Remainder of the closing slot
+        slots[slot][current] += part;
+        lastCharge += part;
+        slot = (slot + 1) % CPU_LOAD_SLOTS;
+        slotStart += SLOT_US;
+        memset(slots[slot], 0, sizeof(slots[slot]));
+    }
+
+    uint32_t rest = now - lastCharge;
+    if (isr > rest) {
+        isr = rest;
+    }
+    slots[slot][current] += rest - isr;
+    slots[slot][cpuIsr] += isr;
+    lastCharge = now;
+}
+
+// -----------------------------------------------------------------------------------
+// Accounting initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Clears the window and starts charging the application bucket. Call after
+// initMillis.
+// -----------------------------------------------------------------------------------
+void cpuLoadInit(void) {
+    memset(slots, 0, sizeof(slots));
+    slot = 0;
+    current = cpuApp;
+    takeIsrTime();
+    slotStart = cpuMicros();
+    lastCharge = slotStart;
+}
+
+// -----------------------------------------------------------------------------------
+// Enter bucket procedure
+// -----------------------------------------------------------------------------------
+// Input : bucket - Bucket to charge from now on
+// Output: cpuBucket_t - Bucket charged until now, to be restored afterwards
+// -----------------------------------------------------------------------------------
+cpuBucket_t cpuLoadEnter(cpuBucket_t bucket) {
+    cpuBucket_t previous = current;
+
+    account(cpuMicros());
+    current = bucket;
+    return previous;
+}
+
+// -----------------------------------------------------------------------------------
+// Clock stopped procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time Timer0 was stopped, i.e. one power-down step
+// Output: void
+// Moves the clock over the sleep the Timer0 count does not contain.
+// -----------------------------------------------------------------------------------
+void cpuLoadClockStopped(uint32_t ms) {
+#if defined(__AVR__)
+    stoppedUs += ms * 1000UL;
+#else
+    (void)ms; // millis() already contains the sleep
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Get load procedure
+// -----------------------------------------------------------------------------------
+// Input : load - Destination
+// Output: void
+// Reports the share of each bucket over the slot being filled and the
+// CPU_LOAD_SLOTS - 1 slots before it.
+// -----------------------------------------------------------------------------------
+void cpuLoadGet(cpuLoad_t* load) {
+    uint32_t totals[CPU_BUCKETS] = { 0 };
+    uint32_t total = 0;
+
+    account(cpuMicros());
+    for (uint8_t s = 0; s < CPU_LOAD_SLOTS; s++) {
+        for (uint8_t b = 0; b < CPU_BUCKETS; b++) {
+            totals[b] += slots[s][b];
+        }
+    }
+    for (uint8_t b = 0; b < CPU_BUCKETS; b++) {
+        total += totals[b];
+    }
+    uint32_t unit = total / 100UL; // One percent, avoids overflowing products
+    for (uint8_t b = 0; b < CPU_BUCKETS; b++) {
+        uint32_t percent = unit > 0 ? totals[b] / unit : 0;
+        load->percent[b] = percent > 100 ? 100 : (uint8_t)percent;
+    }
+    load->window = total / 1000UL;
+}
+
+#endif /* CPU_ACCOUNTING */
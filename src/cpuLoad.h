@@ -0,0 +1,77 @@
+/*
+ * cpuLoad.h
+ *
+ * Created: 18-10-2026 07:00:25
+ * Author: Subrata
+ * Description: Header file for CPU utilisation accounting of the RN4871 BLE
+ *              library. Attributes time to the application, to busy-waiting in the
+ *              library's polling loops, to interrupt handlers and to power-down
+ *              sleep, measured with Timer0, and reports the shares over a sliding
+ *              window. Compiled in only with -DCPU_ACCOUNTING; without it the hooks
+ *              in the library are empty.
+ */
+
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#if defined(__AVR__)
+#include <avr/io.h>
+#endif
+
+// Sliding window of CPU_LOAD_SLOTS slots, CPU_LOAD_SLOT_MS each
+#ifndef CPU_LOAD_SLOTS
+#define CPU_LOAD_SLOTS   8
+#endif
+#ifndef CPU_LOAD_SLOT_MS
+#define CPU_LOAD_SLOT_MS 1000
+#endif
+// Number of buckets in cpuBucket_t
+#define CPU_BUCKETS      4
+
+typedef enum {
+    cpuApp,      // Everything not attributed elsewhere
+    cpuBusyWait, // Polling loops and delays of the library
+    cpuIsr,      // Interrupt handlers
+    cpuSleep     // Power-down sleep
+} cpuBucket_t;
+
+typedef struct {
+    uint8_t percent[CPU_BUCKETS]; // Share of each bucket over the window
+    uint32_t window;              // Time covered by the window in ms
+} cpuLoad_t;
+
+void cpuLoadInit(void);
+cpuBucket_t cpuLoadEnter(cpuBucket_t bucket);
+void cpuLoadClockStopped(uint32_t ms);
+void cpuLoadGet(cpuLoad_t* load);
+
+#if defined(CPU_ACCOUNTING)
+// Charges the enclosing block to a bucket and restores the previous one on exit
+struct cpuScope_t {
+    cpuBucket_t previous;
+    explicit cpuScope_t(cpuBucket_t bucket) : previous(cpuLoadEnter(bucket)) {}
+    ~cpuScope_t() { cpuLoadEnter(previous); }
+};
+#define CPU_WAIT_SCOPE()          cpuScope_t cpuScope(cpuBusyWait)
+#define CPU_SLEEP_SCOPE()         cpuScope_t cpuScope(cpuSleep)
+#define CPU_CLOCK_STOPPED(ms)     cpuLoadClockStopped(ms)
+#if defined(__AVR__)
+// Timer0 ticks spent in interrupt handlers, from TCNT0 read at entry and exit
+extern volatile uint32_t cpuIsrTicks;
+#define CPU_ISR_ENTER()           uint8_t cpuIsrStart = TCNT0
+#define CPU_ISR_LEAVE()           cpuIsrTicks += (uint8_t)(TCNT0 - cpuIsrStart)
+#else
+#define CPU_ISR_ENTER()
+#define CPU_ISR_LEAVE()
+#endif
+#else
+#define CPU_WAIT_SCOPE()
+#define CPU_SLEEP_SCOPE()
+#define CPU_CLOCK_STOPPED(ms)
+#define CPU_ISR_ENTER()
+#define CPU_ISR_LEAVE()
+#endif
+
+#endif /* CPULOAD_H_ */
@@ -0,0 +1,44 @@
+/*
+ * crc16.cpp
+ *
+ * Created: 18-10-2026 05:45:07
+ * Author: Subrata
+ * Description: Implementation of the CRC-16/CCITT checksum (polynomial 0x1021)
+ *              used by the RN4871 BLE library, computed bitwise to avoid a lookup
+ *              table in SRAM or flash.
+ */
+
+#include "crc16.h"
+
+// -----------------------------------------------------------------------------------
+// CRC update procedure
+// -----------------------------------------------------------------------------------
+// Input : crc - Running checksum, data - Next byte
+// Output: uint16_t - Updated checksum
+// Feeds one byte into a CRC-16/CCITT computation started with CRC16_INIT.
+// -----------------------------------------------------------------------------------
+uint16_t crc16Update(uint16_t crc, uint8_t data) {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (crc & 0x8000) {
+            crc = (crc << 1) ^ 0x1021;
+        } else {
+            crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+// -----------------------------------------------------------------------------------
+// CRC string procedure
+// -----------------------------------------------------------------------------------
+// Input : crc - Running checksum, str - Null-terminated string
+// Output: uint16_t - Updated checksum
+// Feeds every character of a string into a running CRC-16/CCITT computation.
+// -----------------------------------------------------------------------------------
+uint16_t crc16String(uint16_t crc, const char* str) {
+    while (*str) {
+        crc = crc16Update(crc, (uint8_t)*str++);
+    }
+    return crc;
+}
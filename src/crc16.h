@@ -0,0 +1,21 @@
+/*
+ * crc16.h
+ *
+ * Created: 18-10-2026 05:44:47
+ * Author: Subrata
+ * Description: Header file for the CRC-16/CCITT checksum used by the RN4871 BLE
+ *              library to fingerprint scripts, payloads and configurations.
+ */
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+// Initial value of a CRC-16/CCITT computation
+#define CRC16_INIT 0xFFFF
+
+uint16_t crc16Update(uint16_t crc, uint8_t data);
+uint16_t crc16String(uint16_t crc, const char* str);
+
+#endif /* CRC16_H_ */
@@ -0,0 +1,182 @@
+/*
+ * diagService.cpp
+ *
+ * Created: 18-10-2026 06:55:21
+ * Author: Subrata
+ * Description: Implementation of the diagnostics service for the RN4871 BLE
+ *              module. Subscriptions and refresh requests arrive as %WC% and %WV%
+ *              events, which only set flags; the snapshot itself is written by
+ *              diagTask from the main loop with a single SHW command, which the
+ *              module forwards as a notification to the subscribed client.
+ */
+
+#include "diagService.h"
+#include "rn4871.h"
+#include <stdlib.h>
+#include <string.h>
+
+diagService_t diagService = { 0, false, false, 0, 0, 0 };
+
+// -----------------------------------------------------------------------------------
+// Define diagnostics service procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if the service and its characteristic were accepted
+// Adds the service while the module is configured, like any application service;
+// it takes effect after the next reboot. Include DIAG_SERVICE_UUID in the
+// application's configuration fingerprint.
+// -----------------------------------------------------------------------------------
+bool diagDefine(void) {
+    return setServiceUUID(DIAG_SERVICE_UUID) &&
+           setCharactUUID(DIAG_CHARACT_UUID, DIAG_PROPERTY, DIAG_SNAPSHOT_SIZE);
+}
+
+// -----------------------------------------------------------------------------------
+// Diagnostics initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if the characteristic was found, false otherwise
+// Looks up the snapshot handle and resets the subscription state. The module must
+// be in command mode.
+// -----------------------------------------------------------------------------------
+bool diagInit(void) {
+    diagService.handle = findHandle(DIAG_CHARACT_UUID, DIAG_PROPERTY);
+    diagService.subscribed = false;
+    diagService.refreshDue = false;
+    return diagService.handle != 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Handle event procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters, as passed to the event handler
+// Output: bool - True if the event concerned the diagnostics service
+// Call from the application's event handler. Counts connections, tracks the
+// notification subscription, whose descriptor follows the value handle, and turns
+// a client write into a refresh request. Sends nothing itself.
+// -----------------------------------------------------------------------------------
+bool diagHandleEvent(const char* event) {
+    if (strncmp(event, DISCONNECT_EVENT, sizeof(DISCONNECT_EVENT) - 1) == 0) {
+        diagService.subscribed = false; // Subscriptions end with the connection
+        return false;
+    }
+    if (strncmp(event, CONNECT_EVENT, sizeof(CONNECT_EVENT) - 1) == 0) {
+        diagService.connects++;
+        diagService.subscribed = false;
+        return false;
+    }
+    if (diagService.handle == 0) {
+        return false;
+    }
+
+    char* next;
+    if (strncmp(event, CCCD_WRITE_EVENT, sizeof(CCCD_WRITE_EVENT) - 1) == 0) {
+        uint16_t handle = (uint16_t)strtoul(event + sizeof(CCCD_WRITE_EVENT) - 1, &next, 16);
+        if (handle != diagService.handle + 1 || *next != ',') {
+            return false; // Descriptor of another characteristic
+        }
+        diagService.subscribed = strtoul(next + 1, NULL, 16) != CCCD_DISABLED;
+        diagService.refreshDue = diagService.subscribed; // First snapshot right away
+        return true;
+    }
+    if (strncmp(event, VALUE_WRITE_EVENT, sizeof(VALUE_WRITE_EVENT) - 1) == 0) {
+        uint16_t handle = (uint16_t)strtoul(event + sizeof(VALUE_WRITE_EVENT) - 1, &next, 16);
+        if (handle != diagService.handle) {
+            return false;
+        }
+        diagService.refreshDue = true; // Client asks for a fresh snapshot to read
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Take snapshot procedure
+// -----------------------------------------------------------------------------------
+// Input : snapshot - Destination
+// Output: void
+// Collects the current figures from the command layer and the UART driver.
+// -----------------------------------------------------------------------------------
+void diagSnapshot(diagSnapshot_t* snapshot) {
+    const commandStats_t* stats = getCommandStats();
+    uint32_t overflows = stats->overflows;
+
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli(); // Receive interrupt updates the buffer statistics
+#endif
+    overflows += ble.rxOverruns;
+    snapshot->rxHighWater = ble.rxHighWater;
+    snapshot->txHighWater = ble.txHighWater;
+#if defined(__AVR__)
+    SREG = oldSREG;
+#endif
+
+    snapshot->uptime = millis() / 1000UL;
+    snapshot->commands = stats->commands;
+    snapshot->latencyAvg = stats->answered > 0 ? (uint16_t)(stats->latencyTotal / stats->answered) : 0;
+    snapshot->latencyMax = stats->latencyMax;
+    snapshot->timeouts = stats->timeouts;
+    snapshot->overflows = overflows > 0xFFFF ? 0xFFFF : (uint16_t)overflows;
+    snapshot->connects = diagService.connects;
+    snapshot->freeSram = freeSram();
+}
+
+// -----------------------------------------------------------------------------------
+// Encode snapshot procedure
+// -----------------------------------------------------------------------------------
+// Input : snapshot - Snapshot, hex - Destination of DIAG_SNAPSHOT_SIZE * 2 + 1 chars
+// Output: void
+// Encodes the fields little-endian as the hex string taken by SHW.
+// -----------------------------------------------------------------------------------
+void diagEncode(const diagSnapshot_t* snapshot, char* hex) {
+    static const char digits[] = "0123456789ABCDEF";
+    const uint16_t words[] = { snapshot->commands, snapshot->latencyAvg, snapshot->latencyMax,
+                               snapshot->timeouts, snapshot->overflows, snapshot->connects,
+                               snapshot->freeSram };
+    uint8_t bytes[DIAG_SNAPSHOT_SIZE];
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        bytes[n++] = (uint8_t)(snapshot->uptime >> (8 * i));
+    }
+    for (uint8_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        bytes[n++] = (uint8_t)words[i];
+        bytes[n++] = (uint8_t)(words[i] >> 8);
+    }
+    bytes[n++] = snapshot->rxHighWater;
+    bytes[n++] = snapshot->txHighWater;
+
+    for (uint8_t i = 0; i < n; i++) {
+        hex[i * 2] = digits[bytes[i] >> 4];
+        hex[i * 2 + 1] = digits[bytes[i] & 0x0F];
+    }
+    hex[n * 2] = '\0';
+}
+
+// -----------------------------------------------------------------------------------
+// Diagnostics task procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Call periodically from the main loop in command mode. Writes a snapshot when one
+// was requested and, while a client is subscribed, every DIAG_REFRESH_INTERVAL ms.
+// Does nothing otherwise, so an idle service costs no UART traffic.
+// -----------------------------------------------------------------------------------
+void diagTask(void) {
+    if (diagService.handle == 0) return;
+    if (!diagService.refreshDue &&
+        !(diagService.subscribed && timeoutExpired(diagService.lastRefresh, DIAG_REFRESH_INTERVAL))) {
+        return;
+    }
+
+    diagSnapshot_t snapshot;
+    char hex[DIAG_SNAPSHOT_SIZE * 2 + 1];
+    diagSnapshot(&snapshot);
+    diagEncode(&snapshot, hex);
+    if (writeLocalCharacteristic(diagService.handle, hex)) {
+        diagService.published++;
+    }
+    diagService.refreshDue = false; // A failed write waits for the next interval
+    diagService.lastRefresh = millis();
+}
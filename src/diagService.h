@@ -0,0 +1,65 @@
+/*
+ * diagService.h
+ *
+ * Created: 18-10-2026 06:54:21
+ * Author: Subrata
+ * Description: Header file for the diagnostics service of the RN4871 BLE library.
+ *              One characteristic carries a compact binary snapshot of uptime,
+ *              command latency, timeout and overflow counters, connection count,
+ *              free SRAM and UART buffer high-water marks, so units without a debug
+ *              port can be monitored from a phone. The snapshot is written only
+ *              while a client is subscribed or on a client's request.
+ */
+
+#ifndef DIAGSERVICE_H_
+#define DIAGSERVICE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rn4871_const.h"
+
+// Diagnostics service and snapshot characteristic, 128-bit private UUIDs
+#define DIAG_SERVICE_UUID     "D1A60000B5A311EE8C900242AC120002"
+#define DIAG_CHARACT_UUID     "D1A60001B5A311EE8C900242AC120002"
+// Read the last snapshot, notify while subscribed, write any value to request a new one
+#define DIAG_PROPERTY         (READ_PROPERTY | NOTIFY_PROPERTY | WRITE_PROPERTY)
+// Snapshot size in bytes, fits a single notification at the default MTU
+#define DIAG_SNAPSHOT_SIZE    20
+// Interval between snapshots while a client is subscribed in ms
+#ifndef DIAG_REFRESH_INTERVAL
+#define DIAG_REFRESH_INTERVAL 5000
+#endif
+
+// Snapshot fields, sent little-endian in this order
+typedef struct {
+    uint32_t uptime;      // Seconds since start
+    uint16_t commands;    // Commands sent
+    uint16_t latencyAvg;  // Average command round trip in ms
+    uint16_t latencyMax;  // Longest command round trip in ms
+    uint16_t timeouts;    // Commands without a response in time
+    uint16_t overflows;   // Receive buffer overruns and bytes dropped from long lines
+    uint16_t connects;    // Connections since start
+    uint16_t freeSram;    // Bytes between heap and stack
+    uint8_t rxHighWater;  // Most bytes waiting in the receive buffer
+    uint8_t txHighWater;  // Most bytes waiting in the transmit buffer
+} diagSnapshot_t;
+
+typedef struct {
+    uint16_t handle;      // Snapshot value handle, 0 if the service is not defined
+    bool subscribed;      // A client enabled notifications
+    bool refreshDue;      // A snapshot was requested
+    uint32_t lastRefresh; // millis() of the last snapshot written
+    uint16_t connects;    // Connections since start
+    uint16_t published;   // Snapshots written
+} diagService_t;
+
+extern diagService_t diagService;
+
+bool diagDefine(void);
+bool diagInit(void);
+bool diagHandleEvent(const char* event);
+void diagTask(void);
+void diagSnapshot(diagSnapshot_t* snapshot);
+void diagEncode(const diagSnapshot_t* snapshot, char* hex);
+
+#endif /* DIAGSERVICE_H_ */
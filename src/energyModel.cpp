@@ -0,0 +1,234 @@
+/*
+ * energyModel.cpp
+ *
+ * Created: 18-10-2026 07:07:12
+ * Author: Subrata
+ * Description: Implementation of the energy estimation model for the RN4871 BLE
+ *              library. The module state is a sequence of segments; each closed
+ *              segment is charged at the current of its state, advertising and
+ *              connected segments with the radio event charge spread over their
+ *              interval. MCU sleep time comes from powerDown and UART transmit time
+ *              from the byte count at the configured baud rate. Time is read from
+ *              millis(), which powerDown keeps running across sleep.
+ */
+
+#include "energyModel.h"
+
+#if defined(ENERGY_MODEL)
+#include "bleSerial.h"
+#include "rn4871_const.h"
+#include "wiring.h"
+#include <string.h>
+
+// uA*ms per uAh
+#define UA_MS_PER_UAH 3600000.0f
+
+const energyCoeff_t energyDefaults = {
+    { 3000,    // MCU active at 8 MHz
+      5,       // MCU power-down with the watchdog running
+      1500,    // Module idle, low power mode off
+      1500,    // Advertising floor
+      1500,    // Connected floor
+      13000,   // Scanning, receiver on
+      400 },   // UART transmit
+    30000,     // Advertising event on three channels
+    12000,     // Connection event
+    8000,      // Notification of one characteristic update
+    30,        // Connection interval
+    { 100, 92, 84, 76, 70, 66 } // SGA,0 is the strongest level
+};
+
+static energyCoeff_t coeff;
+static uint32_t start = 0;                      // millis() at energyInit
+static energyState_t radio = energyModuleIdle;  // Module state of the open segment
+static uint32_t radioStart = 0;                 // millis() at the start of the segment
+static uint16_t advInterval = ENERGY_DEFAULT_ADV_INTERVAL; // 0.625 ms units
+static energyState_t resume = energyModuleIdle; // Module state after a disconnect
+static uint16_t resumeInterval = ENERGY_DEFAULT_ADV_INTERVAL;
+static uint8_t powerLevel = 0;                  // Advertising power level
+static uint32_t residency[ENERGY_STATES];       // Closed segments per module state in ms
+static float radioCharge = 0;                   // Charge of closed segments and updates in uAh
+static uint32_t sleepTime = 0;                  // MCU power-down time in ms
+static uint32_t txBytes = 0;                    // Bytes queued for the UART
+static uint32_t updates = 0;                    // Updates sent while connected
+
+// -----------------------------------------------------------------------------------
+// Radio current procedure
+// -----------------------------------------------------------------------------------
+// Input : state - Module state
+// Output: float - Average current of the module in that state in uA
+// -----------------------------------------------------------------------------------
+static float radioCurrent(energyState_t state) {
+    float current = coeff.current[state];
+
+    if (state == energyAdvertising && advInterval > 0) {
+        current += (float)coeff.advEventCharge * coeff.powerScale[powerLevel] / 100.0f /
+                   (advInterval * 0.625f);
+    } else if (state == energyConnected && coeff.connInterval > 0) {
+        current += (float)coeff.connEventCharge / coeff.connInterval;
+    }
+    return current;
+}
+
+// -----------------------------------------------------------------------------------
+// Close segment procedure
+// -----------------------------------------------------------------------------------
+// Input : now - Current millis()
+// Output: void
+// Charges the open module segment up to now and starts a new one in the same state.
+// -----------------------------------------------------------------------------------
+static void closeSegment(uint32_t now) {
+    uint32_t length = now - radioStart;
+
+    residency[radio] += length;
+    radioCharge += length * radioCurrent(radio) / UA_MS_PER_UAH;
+    radioStart = now;
+}
+
+// -----------------------------------------------------------------------------------
+// Energy model initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : coefficients - Current coefficients, NULL for energyDefaults
+// Output: void
+// Clears all residencies and starts with the module idle at the strongest power
+// level. Call once the clock runs, before the module is configured.
+// -----------------------------------------------------------------------------------
+void energyInit(const energyCoeff_t* coefficients) {
+    coeff = coefficients != NULL ? *coefficients : energyDefaults;
+    start = millis();
+    radioStart = start;
+    radio = energyModuleIdle;
+    resume = energyModuleIdle;
+    advInterval = ENERGY_DEFAULT_ADV_INTERVAL;
+    powerLevel = 0;
+    memset(residency, 0, sizeof(residency));
+    radioCharge = 0;
+    sleepTime = 0;
+    txBytes = 0;
+    updates = 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Module state procedure
+// -----------------------------------------------------------------------------------
+// Input : state - New module state, interval - Advertising interval in 0.625 ms units,
+//                 used only for energyAdvertising
+// Output: void
+// -----------------------------------------------------------------------------------
+void energyRadio(energyState_t state, uint16_t interval) {
+    closeSegment(millis());
+    radio = state;
+    if (state == energyAdvertising) {
+        advInterval = interval;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Power level procedure
+// -----------------------------------------------------------------------------------
+// Input : level - Advertising power level as passed to SGA
+// Output: void
+// -----------------------------------------------------------------------------------
+void energyTxPower(uint8_t level) {
+    closeSegment(millis());
+    powerLevel = level < ENERGY_POWER_LEVELS ? level : ENERGY_POWER_LEVELS - 1;
+}
+
+// -----------------------------------------------------------------------------------
+// Module event procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters
+// Output: void
+// Follows the state changes the module makes on its own: it is connected on CONNECT,
+// resumes what it did before on DISCONNECT and advertises after a reboot.
+// -----------------------------------------------------------------------------------
+void energyEvent(const char* event) {
+    if (strncmp(event, CONNECT_EVENT, sizeof(CONNECT_EVENT) - 1) == 0) {
+        if (radio != energyConnected) {
+            resume = radio;
+            resumeInterval = advInterval;
+            energyRadio(energyConnected, 0);
+        }
+    } else if (strncmp(event, DISCONNECT_EVENT, sizeof(DISCONNECT_EVENT) - 1) == 0) {
+        if (radio == energyConnected) {
+            energyRadio(resume, resumeInterval);
+        }
+    } else if (strncmp(event, REBOOT_EVENT + 1, sizeof(REBOOT_EVENT) - 3) == 0) {
+        energyRadio(energyAdvertising, ENERGY_DEFAULT_ADV_INTERVAL);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// MCU sleep procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time the MCU spent in power-down
+// Output: void
+// -----------------------------------------------------------------------------------
+void energySleep(uint32_t ms) {
+    sleepTime += ms;
+}
+
+// -----------------------------------------------------------------------------------
+// UART byte procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Counts a byte queued for the module.
+// -----------------------------------------------------------------------------------
+void energyTxByte(void) {
+    txBytes++;
+}
+
+// -----------------------------------------------------------------------------------
+// Characteristic update procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Charges one notification if a central is connected; without a connection the
+// update only changes the module's table.
+// -----------------------------------------------------------------------------------
+void energyUpdate(void) {
+    if (radio == energyConnected) {
+        updates++;
+        radioCharge += (float)coeff.updateCharge * coeff.powerScale[powerLevel] / 100.0f / UA_MS_PER_UAH;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Energy report procedure
+// -----------------------------------------------------------------------------------
+// Input : report - Destination
+// Output: void
+// Fills the residency of every state and the charge since energyInit.
+// -----------------------------------------------------------------------------------
+void energyGet(energyReport_t* report) {
+    uint32_t now = millis();
+
+    closeSegment(now);
+    memcpy(report->residency, residency, sizeof(report->residency));
+    report->elapsed = now - start;
+    report->updates = updates;
+
+    uint32_t sleep = sleepTime < report->elapsed ? sleepTime : report->elapsed;
+    report->residency[energyMcuSleep] = sleep;
+    report->residency[energyMcuActive] = report->elapsed - sleep;
+    report->residency[energyUartTx] = (uint32_t)((uint64_t)txBytes * 10000UL / BLE_BAUD); // 10 bits per byte
+
+    report->charge = radioCharge +
+                     ((float)report->residency[energyMcuActive] * coeff.current[energyMcuActive] +
+                      (float)sleep * coeff.current[energyMcuSleep] +
+                      (float)report->residency[energyUartTx] * coeff.current[energyUartTx]) / UA_MS_PER_UAH;
+    report->averageCurrent = report->elapsed > 0 ? report->charge * UA_MS_PER_UAH / report->elapsed : 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Battery life procedure
+// -----------------------------------------------------------------------------------
+// Input : report - Report from energyGet, capacity - Battery capacity in mAh
+// Output: float - Predicted battery life in hours at the average current, 0 if unknown
+// -----------------------------------------------------------------------------------
+float energyLifeHours(const energyReport_t* report, uint16_t capacity) {
+    if (report->averageCurrent <= 0) return 0;
+    return capacity * 1000.0f / report->averageCurrent;
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * energyModel.h
+ *
+ * Created: 18-10-2026 07:06:13
+ * Author: Subrata
+ * Description: Header file for the energy estimation model of the RN4871 BLE
+ *              library. The library reports its state changes: MCU power-down,
+ *              module idle, advertising, connected or scanning, bytes sent on the
+ *              UART and characteristic updates. The model keeps the residency of
+ *              every state and turns it into a running charge estimate with
+ *              per-state current coefficients, so firmware configurations can be
+ *              compared by predicted battery life. Compiled in only with
+ *              -DENERGY_MODEL; without it the hooks in the library are empty.
+ */
+
+#ifndef ENERGYMODEL_H_
+#define ENERGYMODEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Interval of the module's default advertising (A without parameters), 0.625 ms units
+#ifndef ENERGY_DEFAULT_ADV_INTERVAL
+#define ENERGY_DEFAULT_ADV_INTERVAL 160
+#endif
+// Number of states in energyState_t
+#define ENERGY_STATES      7
+// Number of advertising power levels (SGA,0 to SGA,5)
+#define ENERGY_POWER_LEVELS 6
+
+typedef enum {
+    energyMcuActive,   // MCU running
+    energyMcuSleep,    // MCU in power-down
+    energyModuleIdle,  // Module powered, radio off
+    energyAdvertising, // Module advertising
+    energyConnected,   // Module connected to a central
+    energyScanning,    // Module scanning
+    energyUartTx       // MCU sending on the UART, overlaps the states above
+} energyState_t;
+
+typedef struct {
+    uint16_t current[ENERGY_STATES];         // Average current per state in uA; for
+                                             // advertising and connected the floor
+                                             // between radio events
+    uint16_t advEventCharge;                 // Charge per advertising event in nC (uA*ms)
+    uint16_t connEventCharge;                // Charge per connection event in nC
+    uint16_t updateCharge;                   // Charge per characteristic update sent
+                                             // to a connected central in nC
+    uint16_t connInterval;                   // Connection interval assumed in ms
+    uint8_t powerScale[ENERGY_POWER_LEVELS]; // Radio event charge per power level in %
+} energyCoeff_t;
+
+typedef struct {
+    uint32_t residency[ENERGY_STATES]; // Time in each state in ms
+    uint32_t elapsed;                  // Time since energyInit in ms
+    uint32_t updates;                  // Characteristic updates sent while connected
+    float charge;                      // Estimated charge since energyInit in uAh
+    float averageCurrent;              // Average current in uA
+} energyReport_t;
+
+// Rough figures for an ATmega328PB at 8 MHz and an RN4871 at 3.3 V
+extern const energyCoeff_t energyDefaults;
+
+void energyInit(const energyCoeff_t* coeff);
+void energyRadio(energyState_t state, uint16_t interval);
+void energyTxPower(uint8_t level);
+void energyEvent(const char* event);
+void energySleep(uint32_t ms);
+void energyTxByte(void);
+void energyUpdate(void);
+void energyGet(energyReport_t* report);
+float energyLifeHours(const energyReport_t* report, uint16_t capacity);
+
+#if defined(ENERGY_MODEL)
+#define ENERGY_RADIO(state, interval) energyRadio(state, interval)
+#define ENERGY_TX_POWER(level)        energyTxPower(level)
+#define ENERGY_EVENT(event)           energyEvent(event)
+#define ENERGY_SLEEP(ms)              energySleep(ms)
+#define ENERGY_TX_BYTE()              energyTxByte()
+#define ENERGY_UPDATE()               energyUpdate()
+#else
+#define ENERGY_RADIO(state, interval)
+#define ENERGY_TX_POWER(level)
+#define ENERGY_EVENT(event)
+#define ENERGY_SLEEP(ms)
+#define ENERGY_TX_BYTE()
+#define ENERGY_UPDATE()
+#endif
+
+#endif /* ENERGYMODEL_H_ */
@@ -0,0 +1,155 @@
+/*
+ * hal.h
+ *
+ * Created: 18-10-2026 06:14:33
+ * Author: Subrata
+ * Description: Hardware abstraction layer of the RN4871 BLE library. Backends are
+ *              policy classes with static members, bound at compile time by
+ *              instantiating the drivers below, so there is no indirect call on
+ *              the per-byte path.
+ *
+ *              UART policy:  polled, begin(), txStart(), txStop(),
+ *                            txBusy(state), txComplete(), idle(forWrite),
+ *                            serviceTx(state), serviceRx(state), and for
+ *                            interrupt driven UARTs read() and write(byte)
+ *              Clock policy: now(), expired(start, timeout), sleep(ms)
+ *
+ *              A polled UART moves bytes in serviceTx() and serviceRx(); idle()
+ *              lets it wait for the port instead of spinning when a path has
+ *              nothing to do. The transmit path only services transmission, so
+ *              a response is received when the application reads, not while
+ *              its command is still being written.
+ *
+ *              Backends: AvrUsart0, AvrUsart1, AvrClock (halAvr.h);
+ *              MockUart, MockClock (halMock.h); LinuxTermios, LinuxClock
+ *              (host/halTermios.h).
+ */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stddef.h>
+#include "bleSerial.h"
+#include "ringBuffer.h"
+#if defined(__AVR__)
+#include "halAvr.h"
+#endif
+
+// -----------------------------------------------------------------------------------
+// Serial driver
+// -----------------------------------------------------------------------------------
+// Ring buffered UART driver for the module link, operating on a ble_uart_t. The
+// bleSerial API is one instantiation of it.
+// -----------------------------------------------------------------------------------
+template <class Uart, class Clock>
+struct BleSerialDriver {
+    static void init(ble_uart_t& s) {
+        RingBuffer_init(&s.rx_buffer, s.rx_storage, BLE_BUFFER_SIZE); // Initialize receive buffer
+        RingBuffer_init(&s.tx_buffer, s.tx_storage, BLE_BUFFER_SIZE); // Initialize transmit buffer
+        resetStats(s);
+        Uart::begin();
+        s.initialized = true;
+    }
+
+    static int available(ble_uart_t& s) {
+        Uart::serviceTx(s);
+        Uart::serviceRx(s);
+        if (Uart::polled && RingBuffer_is_empty(&s.rx_buffer)) {
+            Uart::idle(false); // Wait briefly for the port instead of spinning
+            Uart::serviceRx(s);
+        }
+        return RingBuffer_available(&s.rx_buffer);
+    }
+
+    static int read(ble_uart_t& s) {
+        char data;
+        Uart::serviceRx(s);
+        if (!RingBuffer_pop(&s.rx_buffer, &data)) {
+            return -1; // Buffer empty
+        }
+        return (int)data;
+    }
+
+    static bool write(ble_uart_t& s, uint8_t data) {
+        if (!RingBuffer_push(&s.tx_buffer, (char)data)) {
+            Uart::serviceTx(s);
+            return false; // Buffer full
+        }
+        uint8_t used = (s.tx_buffer.head - s.tx_buffer.tail) & (BLE_BUFFER_SIZE - 1);
+        if (used > s.txHighWater) {
+            s.txHighWater = used;
+        }
+        Uart::txStart(); // Enable transmit interrupt
+        Uart::serviceTx(s);
+        return true;
+    }
+
+    static size_t readBytes(ble_uart_t& s, char* buffer, uint16_t length) {
+        size_t bytesRead = 0;
+        unsigned long start = Clock::now();
+        const uint16_t timeout = 1000;
+
+        while (bytesRead < length && !Clock::expired(start, timeout)) {
+            if (available(s)) {
+                int c = read(s);
+                if (c != -1) {
+                    buffer[bytesRead++] = (char)c;
+                }
+            }
+        }
+        return bytesRead;
+    }
+
+    static void txFlush(ble_uart_t& s) {
+        Uart::txStop(); // Disable transmit interrupt
+        s.tx_buffer.head = 0; // Reset buffer pointers
+        s.tx_buffer.tail = 0;
+    }
+
+    static void txWait(ble_uart_t& s) {
+        Uart::serviceTx(s);
+        while (Uart::txBusy(s)) { // Wait for the transmit buffer to drain
+            Uart::idle(true);
+            Uart::serviceTx(s);
+        }
+
+        unsigned long start = Clock::now();
+        while (!Uart::txComplete() && !Clock::expired(start, 5)); // Wait for the last frame
+    }
+
+    static void rxFlush(ble_uart_t& s) {
+        s.rx_buffer.head = 0; // Reset buffer pointers
+        s.rx_buffer.tail = 0;
+    }
+
+    static void resetStats(ble_uart_t& s) {
+        s.rxHighWater = 0;
+        s.txHighWater = 0;
+        s.rxOverruns = 0;
+    }
+
+    // Receive interrupt body of interrupt driven UARTs
+    static void onReceive(ble_uart_t& s) {
+        char data = (char)Uart::read(); // Read incoming byte
+        if (!RingBuffer_push(&s.rx_buffer, data)) {
+            s.rxOverruns++; // Buffer full, byte lost
+            return;
+        }
+        uint8_t used = (s.rx_buffer.head - s.rx_buffer.tail) & (BLE_BUFFER_SIZE - 1);
+        if (used > s.rxHighWater) {
+            s.rxHighWater = used;
+        }
+    }
+
+    // Data register empty interrupt body of interrupt driven UARTs
+    static void onTxReady(ble_uart_t& s) {
+        char data;
+        if (RingBuffer_pop(&s.tx_buffer, &data)) {
+            Uart::write((uint8_t)data); // Send byte
+        } else {
+            Uart::txStop(); // Disable interrupt if buffer empty
+        }
+    }
+};
+
+#endif /* HAL_H_ */
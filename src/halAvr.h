@@ -0,0 +1,65 @@
+/*
+ * halAvr.h
+ *
+ * Created: 18-10-2026 06:15:10
+ * Author: Subrata
+ * Description: AVR backend policies of the hardware abstraction layer: USART0 and
+ *              USART1 of the ATmega328PB and the Timer0 clock.
+ *              Every member is a static inline register access, so a driver
+ *              instantiated with these policies compiles to the same code as
+ *              direct register use.
+ */
+
+#ifndef HALAVR_H_
+#define HALAVR_H_
+
+#if defined(__AVR__)
+#include <avr/io.h>
+#include "bleSerial.h"
+#include "wiring.h"
+
+// -----------------------------------------------------------------------------------
+// USART policy
+// -----------------------------------------------------------------------------------
+// Interrupt driven: received bytes and transmit room are delivered by the RX and
+// UDRE interrupts, so serviceTx(), serviceRx() and idle() have nothing to do.
+// -----------------------------------------------------------------------------------
+#define HAL_AVR_USART(name, n)                                                              \
+    struct name {                                                                           \
+        static const bool polled = false;                                                   \
+        static void begin(void) {                                                           \
+            UBRR##n = BLE_UBRR_VALUE; /* Set baud rate */                                   \
+            UCSR##n##A = (1 << U2X##n); /* Enable double speed mode */                      \
+            UCSR##n##B = (1 << RXEN##n) | (1 << TXEN##n) | (1 << RXCIE##n) | (1 << UDRIE##n); \
+            UCSR##n##C = (1 << UCSZ##n##1) | (1 << UCSZ##n##0); /* 8N1 */                   \
+        }                                                                                   \
+        static uint8_t read(void) { return UDR##n; }                                        \
+        static void write(uint8_t data) {                                                   \
+            UCSR##n##A |= (1 << TXC##n); /* Clear transmit complete flag */                 \
+            UDR##n = data;                                                                  \
+        }                                                                                   \
+        static void txStart(void) { UCSR##n##B |= (1 << UDRIE##n); }                        \
+        static void txStop(void) { UCSR##n##B &= ~(1 << UDRIE##n); }                        \
+        static bool txBusy(const ble_uart_t&) { return UCSR##n##B & (1 << UDRIE##n); }      \
+        static bool txComplete(void) { return UCSR##n##A & (1 << TXC##n); }                 \
+        static void idle(bool) {}                                                           \
+        static void serviceTx(ble_uart_t&) {}                                               \
+        static void serviceRx(ble_uart_t&) {}                                               \
+    }
+
+HAL_AVR_USART(AvrUsart0, 0);
+#if defined(UDRIE1)
+HAL_AVR_USART(AvrUsart1, 1);
+#endif
+
+// -----------------------------------------------------------------------------------
+// Clock policy
+// -----------------------------------------------------------------------------------
+struct AvrClock {
+    static unsigned long now(void) { return millis(); }
+    static bool expired(unsigned long start, unsigned long timeout) { return timeoutExpired(start, timeout); }
+    static void sleep(unsigned long ms) { delay(ms); }
+};
+#endif
+
+#endif /* HALAVR_H_ */
@@ -0,0 +1,97 @@
+/*
+ * halMock.h
+ *
+ * Created: 18-10-2026 06:15:46
+ * Author: Subrata
+ * Description: In-memory backend policies of the hardware abstraction layer for
+ *              host builds: a mock UART with byte queues in both directions and a
+ *              manually advanced clock.
+ *              Drivers instantiated with them run and link without hardware.
+ */
+
+#ifndef HALMOCK_H_
+#define HALMOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bleSerial.h"
+
+// Size of each mock UART queue (power of 2)
+#define HAL_MOCK_QUEUE_SIZE 1024
+
+typedef struct {
+    uint8_t toMcu[HAL_MOCK_QUEUE_SIZE];   // Bytes the module will send
+    uint16_t toMcuHead;                    // Write index
+    uint16_t toMcuTail;                    // Read index
+    uint8_t fromMcu[HAL_MOCK_QUEUE_SIZE]; // Bytes the MCU sent
+    uint16_t fromMcuLen;                   // Bytes in fromMcu, wraps to 0 when full
+    uint32_t sent;                         // Total bytes sent by the MCU
+} halMockUart_t;
+
+// -----------------------------------------------------------------------------------
+// Mock UART policy
+// -----------------------------------------------------------------------------------
+// Polled: serviceRx() moves queued module bytes into the receive ring and serviceTx()
+// the transmit ring into fromMcu, the work the interrupts do on the AVR.
+// -----------------------------------------------------------------------------------
+struct MockUart {
+    static const bool polled = true;
+    static halMockUart_t& state(void) {
+        static halMockUart_t mock;
+        return mock;
+    }
+    static void begin(void) { memset(&state(), 0, sizeof(halMockUart_t)); }
+    static void txStart(void) {}
+    static void txStop(void) {}
+    static bool txBusy(const ble_uart_t& s) { return s.tx_buffer.head != s.tx_buffer.tail; }
+    static bool txComplete(void) { return true; }
+    static void idle(bool) {}
+    static void serviceTx(ble_uart_t& s) {
+        halMockUart_t& mock = state();
+        char data;
+        while (RingBuffer_pop(&s.tx_buffer, &data)) {
+            mock.fromMcu[mock.fromMcuLen] = (uint8_t)data;
+            mock.fromMcuLen = (mock.fromMcuLen + 1) & (HAL_MOCK_QUEUE_SIZE - 1);
+            mock.sent++;
+        }
+    }
+    static void serviceRx(ble_uart_t& s) {
+        halMockUart_t& mock = state();
+        while (mock.toMcuTail != mock.toMcuHead && !RingBuffer_is_full(&s.rx_buffer)) {
+            RingBuffer_push(&s.rx_buffer, (char)mock.toMcu[mock.toMcuTail]);
+            mock.toMcuTail = (mock.toMcuTail + 1) & (HAL_MOCK_QUEUE_SIZE - 1);
+        }
+    }
+
+    // Test side: queue bytes as if sent by the module
+    static bool inject(const uint8_t* data, uint16_t length) {
+        halMockUart_t& mock = state();
+        for (uint16_t i = 0; i < length; i++) {
+            uint16_t next = (mock.toMcuHead + 1) & (HAL_MOCK_QUEUE_SIZE - 1);
+            if (next == mock.toMcuTail) return false;
+            mock.toMcu[mock.toMcuHead] = data[i];
+            mock.toMcuHead = next;
+        }
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------------
+// Mock clock policy
+// -----------------------------------------------------------------------------------
+// Time only moves in sleep() or advance(), so timeouts expire deterministically.
+// -----------------------------------------------------------------------------------
+struct MockClock {
+    static unsigned long& time(void) { static unsigned long value = 0; return value; }
+    static unsigned long now(void) { return time(); }
+    static bool expired(unsigned long start, unsigned long timeout) {
+        if (time() - start >= timeout) return true;
+        time()++; // A polling loop iteration costs 1 ms of mock time
+        return false;
+    }
+    static void sleep(unsigned long ms) { time() += ms; }
+    static void advance(unsigned long ms) { time() += ms; }
+};
+
+#endif /* HALMOCK_H_ */
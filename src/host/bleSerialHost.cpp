@@ -0,0 +1,274 @@
+/*
+ * bleSerialHost.cpp
+ *
+ * Created: 18-10-2026 05:48:15
+ * Author: Subrata
+ * Description: Linux port of the UART communication layer for the RN4871 BLE
+ *              module. The API is a thin layer over the HAL serial driver
+ *              instantiated with the LinuxTermios policy, which feeds the same ring
+ *              buffers as the AVR interrupt handlers from a termios file descriptor
+ *              or an in-process transport using non-blocking I/O.
+ */
+
+#include "bleSerial.h"
+#include "hal.h"
+#include "halTermios.h"
+#include "cpuLoad.h"
+#include "energyModel.h"
+
+// Serial device opened by bleInit when no descriptor is attached
+#define BLE_DEFAULT_DEVICE "/dev/ttyUSB0"
+
+typedef BleSerialDriver<LinuxTermios, LinuxClock> bleDriver;
+
+ble_uart_t ble;
+static const char* bleDevice = BLE_DEFAULT_DEVICE;
+
+// -----------------------------------------------------------------------------------
+// Baud rate mapping procedure
+// -----------------------------------------------------------------------------------
+// Input : baud - Baud rate in bits per second
+// Output: speed_t - Matching termios speed constant, B0 if the rate is not supported
+// -----------------------------------------------------------------------------------
+static speed_t baudToSpeed(unsigned long baud) {
+    switch (baud) {
+        case 115200: return B115200;
+        case 57600:  return B57600;
+        case 38400:  return B38400;
+        case 19200:  return B19200;
+        case 9600:   return B9600;
+        default:     return B0;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Set serial device procedure
+// -----------------------------------------------------------------------------------
+// Input : device - Path of the serial device, e.g. /dev/ttyUSB0
+// Output: void
+// Selects the serial device opened by the next bleInit call.
+// -----------------------------------------------------------------------------------
+void bleSetDevice(const char* device) {
+    bleDevice = device;
+}
+
+// -----------------------------------------------------------------------------------
+// Configure file descriptor procedure
+// -----------------------------------------------------------------------------------
+// Input : fd - Open serial or pseudo-terminal file descriptor
+// Output: bool - True if successful, false if BLE_BAUD is not a termios rate or on error
+// Configures a descriptor for raw 8N1 at BLE_BAUD when it is a terminal and switches
+// it to non-blocking mode. Shared by every host component that opens a module port.
+// -----------------------------------------------------------------------------------
+bool bleConfigureFd(int fd) {
+    struct termios tio;
+    speed_t speed = baudToSpeed(BLE_BAUD);
+
+    if (speed == B0) {
+        return false; // BLE_BAUD has no termios equivalent
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio); // 8-bit data, no parity, no echo
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS); // 1 stop bit, no flow control
+        tio.c_cflag |= CLOCAL | CREAD;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+            return false;
+        }
+    }
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Attach file descriptor procedure
+// -----------------------------------------------------------------------------------
+// Input : fd - Open serial or pseudo-terminal file descriptor
+// Output: bool - True if successful, false otherwise
+// Uses an already open descriptor as the module port, e.g. one side of a pty pair.
+// -----------------------------------------------------------------------------------
+bool bleInitFd(int fd) {
+    if (!LinuxTermios::attach(fd)) {
+        return false;
+    }
+    bleDriver::init(ble);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Attach transport procedure
+// -----------------------------------------------------------------------------------
+// Input : custom - In-process transport, NULL to return to the file descriptor
+// Output: void
+// Replaces the serial port with an in-process transport such as a session replay, so
+// the library can be driven without a descriptor. Resets both buffers.
+// -----------------------------------------------------------------------------------
+void bleSetTransport(const bleTransport_t* custom) {
+    LinuxTermios::setTransport(custom);
+    bleDriver::init(ble);
+    ble.initialized = LinuxTermios::connected();
+}
+
+// -----------------------------------------------------------------------------------
+// Set byte tap procedure
+// -----------------------------------------------------------------------------------
+// Input : newTap - Observer called with every chunk sent or received, NULL to remove,
+//         ctx - Observer context
+// Output: void
+// Lets a session recorder see the exact byte stream in both directions.
+// -----------------------------------------------------------------------------------
+void bleSetTap(bleTap_t newTap, void* ctx) {
+    LinuxTermios::tap() = newTap;
+    LinuxTermios::tapCtx() = ctx;
+}
+
+// -----------------------------------------------------------------------------------
+// UART initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Opens the selected serial device and configures it for communication with the
+// RN4871. ble.initialized stays false if the device cannot be opened.
+// -----------------------------------------------------------------------------------
+void bleInit(void) {
+    if (ble.initialized) return;
+    if (LinuxTermios::open(bleDevice)) {
+        bleDriver::init(ble);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Check available bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: int - Number of bytes available
+// Returns the number of received bytes. When none are pending it waits briefly for
+// the transport instead of spinning, so polling loops do not burn a CPU core.
+// -----------------------------------------------------------------------------------
+int bleAvailable(void) {
+    return bleDriver::available(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Read byte procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: int - The byte read or -1 if empty
+// Reads a single byte from the receive buffer, returning -1 if empty.
+// -----------------------------------------------------------------------------------
+int bleRead(void) {
+    return bleDriver::read(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Reset buffer statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Clears the high-water marks and the overrun count. The host port never overruns,
+// since bytes stay queued in the transport until the ring has room.
+// -----------------------------------------------------------------------------------
+void bleResetStats(void) {
+    bleDriver::resetStats(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Read multiple bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : buffer - Destination buffer, length - Number of bytes to read
+// Output: size_t - Number of bytes read
+// Reads up to the specified number of bytes from the receive buffer with a timeout.
+// -----------------------------------------------------------------------------------
+size_t bleReadBytes(char* buffer, uint16_t length) {
+    CPU_WAIT_SCOPE();
+    return bleDriver::readBytes(ble, buffer, length);
+}
+
+// -----------------------------------------------------------------------------------
+// Write byte procedure
+// -----------------------------------------------------------------------------------
+// Input : data - Byte to write
+// Output: bool - True if successful, false if buffer full
+// Writes a single byte to the transmit buffer and hands it to the transport.
+// -----------------------------------------------------------------------------------
+bool blePrint(uint8_t data) {
+    if (!bleDriver::write(ble, data)) {
+        return false;
+    }
+    ENERGY_TX_BYTE();
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Write character procedure
+// -----------------------------------------------------------------------------------
+// Input : data - Character to write
+// Output: bool - True if successful, false if buffer full
+// Writes a single character to the transmit buffer and hands it to the transport.
+// -----------------------------------------------------------------------------------
+bool blePrintChar(char data) {
+    return blePrint((uint8_t)data);
+}
+
+// -----------------------------------------------------------------------------------
+// Write string procedure
+// -----------------------------------------------------------------------------------
+// Input : str - The string to write
+// Output: void
+// Writes a null-terminated string to the transmit buffer, sending each character.
+// -----------------------------------------------------------------------------------
+void blePrintString(const char* str) {
+    CPU_WAIT_SCOPE();
+    while (*str) {
+        while (!blePrintChar(*str)); // Send character, wait if buffer full
+        str++;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Write string with CR+LF procedure
+// -----------------------------------------------------------------------------------
+// Input : str - The string to write
+// Output: void
+// Writes a string followed by a carriage return and line feed.
+// -----------------------------------------------------------------------------------
+void blePrintStringln(const char* str) {
+    blePrintString(str); // Write string
+    blePrintString("\r\n"); // Append CR+LF
+}
+
+// -----------------------------------------------------------------------------------
+// Flush transmit buffer procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Discards bytes not yet handed to the transport.
+// -----------------------------------------------------------------------------------
+void bleTxFlush(void) {
+    bleDriver::txFlush(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Wait for transmit completion procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Blocks until the transmit buffer is handed to the transport and, for terminals,
+// until the driver has sent it.
+// -----------------------------------------------------------------------------------
+void bleTxWait(void) {
+    CPU_WAIT_SCOPE();
+    bleDriver::txWait(ble);
+}
+
+// -----------------------------------------------------------------------------------
+// Flush receive buffer procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Clears the receive buffer by resetting its pointers. Bytes still queued in the
+// transport count as not yet received, like bytes on the wire for the AVR.
+// -----------------------------------------------------------------------------------
+void bleRxFlush(void) {
+    bleDriver::rxFlush(ble);
+}
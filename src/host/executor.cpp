@@ -0,0 +1,486 @@
+/*
+ * executor.cpp
+ *
+ * Created: 18-10-2026 06:21:57
+ * Author: Subrata
+ * Description: Implementation of the thread-safe command executor for the Linux port.
+ *              Submitters only exchange the queue head and, when the I/O thread is
+ *              not already signalled, write the eventfd; no lock is taken on either
+ *              side. The I/O thread moves requests into per-module wait lists and
+ *              feeds the command engines as they free room, so per-module order is
+ *              the submission order. Waiters sleep on a futex that the I/O thread
+ *              only wakes if someone is actually sleeping.
+ */
+
+#include "executor.h"
+#include "bleSerial.h"
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+
+// epoll tags of the executor's own descriptors
+#define EXEC_TAG_GATEWAY 0
+#define EXEC_TAG_WAKE    1
+
+// -----------------------------------------------------------------------------------
+// Futex wait procedure
+// -----------------------------------------------------------------------------------
+// Input : word - Futex word, expected - Value to sleep on, timeout - Relative timeout or NULL
+// Output: void
+// Returns when woken, on timeout, on a signal or if the word no longer holds expected.
+// -----------------------------------------------------------------------------------
+static void futexWait(std::atomic<int>* word, int expected, const struct timespec* timeout) {
+    syscall(SYS_futex, (int*)word, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+}
+
+static void futexWake(std::atomic<int>* word) {
+    syscall(SYS_futex, (int*)word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// -----------------------------------------------------------------------------------
+// Wake I/O thread procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: void
+// Signals the eventfd unless a signal is already outstanding, so a burst of
+// submissions costs one system call.
+// -----------------------------------------------------------------------------------
+static void wakeIoThread(executor_t* exec) {
+    if (exec->wakePending.exchange(true)) return;
+
+    uint64_t one = 1;
+    ssize_t n = write(exec->wakeFd, &one, sizeof(one));
+    (void)n; // Counter saturation still leaves the eventfd readable
+}
+
+// -----------------------------------------------------------------------------------
+// Finish request procedure
+// -----------------------------------------------------------------------------------
+// Input : request - Completed request, status - Result, line - Final line or NULL
+// Output: void
+// Publishes the result. A callback request is handed to its callback; a waited
+// request is marked done and its waiter woken only if it went to sleep.
+// -----------------------------------------------------------------------------------
+static void finishRequest(execRequest_t* request, cmdStatus_t status, const char* line) {
+    request->status = status;
+    snprintf(request->line, sizeof(request->line), "%s", line != NULL ? line : "");
+    request->owner->completed.fetch_add(1, std::memory_order_relaxed);
+
+    if (request->callback != NULL) {
+        execCallback_t callback = request->callback;
+        request->state.store(execDone, std::memory_order_release);
+        callback(request, status, request->line); // May free or resubmit the request
+        return;
+    }
+    if (request->state.exchange(execDone, std::memory_order_acq_rel) == execWaiting) {
+        futexWake(&request->state);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Engine callback procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Request, status - Command status, line - Response line
+// Output: void
+// Listing lines are passed on to callback requests only; waited requests keep the
+// final line.
+// -----------------------------------------------------------------------------------
+static void engineDone(void* ctx, cmdStatus_t status, const char* line) {
+    execRequest_t* request = (execRequest_t*)ctx;
+
+    if (status == cmdPending) {
+        if (request->callback != NULL) request->callback(request, status, line);
+        return;
+    }
+    finishRequest(request, status, line);
+}
+
+// -----------------------------------------------------------------------------------
+// Pop submission procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: execRequest_t* - Oldest submitted request or NULL
+// Consumer side of the intrusive MPSC queue. NULL is also returned while a producer
+// has swapped the head but not linked its node yet; its wakeup follows the link.
+// -----------------------------------------------------------------------------------
+static execRequest_t* popSubmission(executor_t* exec) {
+    execRequest_t* tail = exec->tail;
+    execRequest_t* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &exec->stub) {
+        if (next == NULL) return NULL;
+        exec->tail = next; // Skip the sentinel
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != NULL) {
+        exec->tail = next;
+        return tail;
+    }
+    if (tail != exec->head.load(std::memory_order_acquire)) {
+        return NULL; // Producer in the middle of a push
+    }
+    // Last node: put the sentinel behind it so the node can be handed out
+    exec->stub.next.store(NULL, std::memory_order_relaxed);
+    execRequest_t* prev = exec->head.exchange(&exec->stub, std::memory_order_acq_rel);
+    prev->next.store(&exec->stub, std::memory_order_release);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != NULL) {
+        exec->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Drain submissions procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: void
+// Moves every submitted request to the wait list of its module, or fails it at once
+// if the module does not exist or its port is closed.
+// -----------------------------------------------------------------------------------
+static void drainSubmissions(executor_t* exec) {
+    execRequest_t* request;
+
+    exec->wakePending.store(false); // Later submissions signal again
+    while ((request = popSubmission(exec)) != NULL) {
+        rn4871_t* module = gatewayModule(&exec->gw, request->module);
+        if (module == NULL || module->fd < 0) {
+            finishRequest(request, cmdError, "no module");
+            continue;
+        }
+        request->pendingNext = NULL;
+        if (exec->waitHead[request->module] == NULL) {
+            exec->waitHead[request->module] = request;
+        } else {
+            exec->waitTail[request->module]->pendingNext = request;
+        }
+        exec->waitTail[request->module] = request;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Pump procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: void
+// Feeds waiting requests into the command engines while they have room.
+// -----------------------------------------------------------------------------------
+static void pumpModules(executor_t* exec) {
+    for (uint16_t id = 0; id < exec->gw.moduleCount; id++) {
+        execRequest_t* request;
+        while ((request = exec->waitHead[id]) != NULL) {
+            if (exec->gw.modules[id].fd < 0) {
+                exec->waitHead[id] = request->pendingNext;
+                finishRequest(request, cmdError, "port closed");
+                continue;
+            }
+            if (!gatewaySubmitRaw(&exec->gw, id, request->command, request->expect, request->match,
+                                  request->flags, request->timeout, engineDone, request)) {
+                break; // Engine queue full
+            }
+            exec->waitHead[id] = request->pendingNext;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Executor idle procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: bool - True if no request is waiting or in flight
+// -----------------------------------------------------------------------------------
+static bool executorIdle(executor_t* exec) {
+    for (uint16_t id = 0; id < exec->gw.moduleCount; id++) {
+        if (exec->waitHead[id] != NULL) return false;
+    }
+    return gatewayIdle(&exec->gw);
+}
+
+// -----------------------------------------------------------------------------------
+// I/O thread procedure
+// -----------------------------------------------------------------------------------
+// Input : arg - Executor
+// Output: void* - NULL
+// Waits on the gateway's epoll and the eventfd until the nearest command deadline,
+// then runs one gateway step and hands new requests to the engines. Once a stop is
+// requested it keeps going until every accepted request has completed.
+// -----------------------------------------------------------------------------------
+static void* ioThread(void* arg) {
+    executor_t* exec = (executor_t*)arg;
+    struct epoll_event ready[2];
+    gatewayEvent_t event;
+
+    for (;;) {
+        drainSubmissions(exec);
+        pumpModules(exec);
+        while (gatewayPopEvent(&exec->gw, &event)) {
+            if (exec->onEvent != NULL) exec->onEvent(exec->eventCtx, &event);
+        }
+        if (exec->stopping.load() && exec->tail == &exec->stub &&
+            exec->head.load() == &exec->stub && executorIdle(exec)) {
+            break;
+        }
+
+        uint32_t now = millis();
+        int wait = -1;
+        for (uint16_t id = 0; id < exec->gw.moduleCount; id++) {
+            int32_t left = cmdTimeToDeadline(&exec->gw.modules[id].engine, now);
+            if (left >= 0 && (wait < 0 || left < wait)) {
+                wait = (int)left; // Wake up for the nearest timeout
+            }
+        }
+
+        int count = epoll_wait(exec->epfd, ready, 2, wait);
+        if (count < 0 && errno != EINTR) break;
+        for (int i = 0; i < count; i++) {
+            if (ready[i].data.u32 == EXEC_TAG_WAKE) {
+                uint64_t value;
+                if (read(exec->wakeFd, &value, sizeof(value)) > 0) exec->wakeups++;
+            }
+        }
+        if (gatewayRun(&exec->gw, 0) < 0 && errno != EINTR) break;
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Executor initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: bool - True if successful, false otherwise
+// Creates the gateway, the eventfd and the epoll instance that watches both. The
+// executor structure is large; allocate it statically or on the heap.
+// -----------------------------------------------------------------------------------
+bool executorInit(executor_t* exec) {
+    struct epoll_event ev;
+
+    if (!gatewayInit(&exec->gw)) return false;
+    exec->running = false;
+    exec->onEvent = NULL;
+    exec->eventCtx = NULL;
+    exec->wakeups = 0;
+    exec->submitted.store(0);
+    exec->completed.store(0);
+    exec->submitting.store(0);
+    exec->stopping.store(false);
+    exec->wakePending.store(false);
+    exec->stub.next.store(NULL);
+    exec->head.store(&exec->stub);
+    exec->tail = &exec->stub;
+    memset(exec->waitHead, 0, sizeof(exec->waitHead));
+    memset(exec->waitTail, 0, sizeof(exec->waitTail));
+
+    exec->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    exec->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (exec->wakeFd < 0 || exec->epfd < 0) {
+        executorStop(exec);
+        return false;
+    }
+    // The gateway's epoll tags ports with module ids, so the wakeup gets its own set
+    ev.events = EPOLLIN;
+    ev.data.u32 = EXEC_TAG_GATEWAY;
+    epoll_ctl(exec->epfd, EPOLL_CTL_ADD, exec->gw.epfd, &ev);
+    ev.data.u32 = EXEC_TAG_WAKE;
+    epoll_ctl(exec->epfd, EPOLL_CTL_ADD, exec->wakeFd, &ev);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Open device procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor, device - Serial device path
+// Output: int - Module id or -1 on failure
+// Modules can only be added before executorStart.
+// -----------------------------------------------------------------------------------
+int executorOpen(executor_t* exec, const char* device) {
+    return exec->running ? -1 : gatewayOpen(&exec->gw, device);
+}
+
+int executorAddFd(executor_t* exec, int fd) {
+    return exec->running ? -1 : gatewayAddFd(&exec->gw, fd);
+}
+
+// -----------------------------------------------------------------------------------
+// Set event handler procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor, onEvent - Handler or NULL to discard events, ctx - Context
+// Output: void
+// Events of all modules are delivered on the I/O thread. Set before executorStart.
+// -----------------------------------------------------------------------------------
+void executorSetEventHandler(executor_t* exec, execEvent_t onEvent, void* ctx) {
+    exec->onEvent = onEvent;
+    exec->eventCtx = ctx;
+}
+
+// -----------------------------------------------------------------------------------
+// Start procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: bool - True if the I/O thread is running
+// -----------------------------------------------------------------------------------
+bool executorStart(executor_t* exec) {
+    if (exec->running) return true;
+
+    millis(); // Start the host clock before a second thread can read it
+    exec->stopping.store(false);
+    exec->running = pthread_create(&exec->thread, NULL, ioThread, exec) == 0;
+    return exec->running;
+}
+
+// -----------------------------------------------------------------------------------
+// Stop procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor
+// Output: void
+// Refuses further submissions, lets the I/O thread finish every accepted request
+// (by response or timeout), then closes all ports. Requests that raced the stop and
+// were never sent complete with cmdError.
+// -----------------------------------------------------------------------------------
+void executorStop(executor_t* exec) {
+    execRequest_t* request;
+
+    exec->stopping.store(true);
+    while (exec->submitting.load() != 0) {
+        sched_yield(); // Let producers past the stopping check finish their push
+    }
+    if (exec->running) {
+        exec->wakePending.store(false);
+        wakeIoThread(exec);
+        pthread_join(exec->thread, NULL);
+        exec->running = false;
+    }
+
+    while ((request = popSubmission(exec)) != NULL) {
+        finishRequest(request, cmdError, "stopped");
+    }
+    for (uint16_t id = 0; id < exec->gw.moduleCount; id++) {
+        while ((request = exec->waitHead[id]) != NULL) {
+            exec->waitHead[id] = request->pendingNext;
+            finishRequest(request, cmdError, "stopped");
+        }
+    }
+    gatewayClose(&exec->gw);
+    if (exec->wakeFd >= 0) close(exec->wakeFd);
+    if (exec->epfd >= 0) close(exec->epfd);
+    exec->wakeFd = -1;
+    exec->epfd = -1;
+}
+
+// -----------------------------------------------------------------------------------
+// Prepare request procedure
+// -----------------------------------------------------------------------------------
+// Input : request - Request to fill, module - Module id, command - Command text,
+//         expect - Success substring or NULL, match - Completion rule, timeout - ms
+// Output: bool - True if the command fits, false otherwise
+// Resets the request for a plain command without callback; set flags, callback and
+// ctx afterwards if needed.
+// -----------------------------------------------------------------------------------
+bool executorPrepare(execRequest_t* request, uint16_t module, const char* command, const char* expect,
+                     cmdMatch_t match, uint16_t timeout) {
+    size_t length = strlen(command);
+
+    if (length >= CMD_COMMAND_SIZE) return false;
+    memcpy(request->command, command, length + 1);
+    request->next.store(NULL, std::memory_order_relaxed);
+    request->pendingNext = NULL;
+    request->owner = NULL;
+    request->module = module;
+    request->expect = expect;
+    request->match = match;
+    request->flags = 0;
+    request->timeout = timeout;
+    request->callback = NULL;
+    request->ctx = NULL;
+    request->state.store(execIdle, std::memory_order_relaxed);
+    request->status = cmdPending;
+    request->line[0] = '\0';
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Submit procedure
+// -----------------------------------------------------------------------------------
+// Input : exec - Executor, request - Prepared request
+// Output: bool - True if accepted, false if stopping or the module id is out of range
+// Callable from any thread. Lock-free: one exchange on the queue head, one store to
+// link the node and at most one eventfd write per batch.
+// -----------------------------------------------------------------------------------
+bool executorSubmit(executor_t* exec, execRequest_t* request) {
+    if (request->module >= GATEWAY_MAX_MODULES) return false;
+
+    exec->submitting.fetch_add(1);
+    if (exec->stopping.load()) {
+        exec->submitting.fetch_sub(1);
+        return false;
+    }
+    request->owner = exec;
+    request->state.store(execQueued, std::memory_order_relaxed);
+    request->next.store(NULL, std::memory_order_relaxed);
+    execRequest_t* prev = exec->head.exchange(request, std::memory_order_acq_rel);
+    prev->next.store(request, std::memory_order_release);
+    exec->submitted.fetch_add(1, std::memory_order_relaxed);
+    wakeIoThread(exec);
+    exec->submitting.fetch_sub(1);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Wait procedure
+// -----------------------------------------------------------------------------------
+// Input : request - Submitted request without callback, timeout - ms, -1 forever
+// Output: bool - True once complete, false on timeout
+// On success status and line hold the result and the request may be reused. After a
+// timeout the request is still in flight and must stay valid.
+// -----------------------------------------------------------------------------------
+bool executorWait(execRequest_t* request, int timeout) {
+    struct timespec deadline;
+    struct timespec left;
+
+    if (timeout >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    for (;;) {
+        int state = request->state.load(std::memory_order_acquire);
+        if (state == execDone) {
+            request->state.store(execIdle, std::memory_order_relaxed);
+            return true;
+        }
+        if (state == execIdle) return false; // Never submitted
+        if (state == execQueued &&
+            !request->state.compare_exchange_weak(state, execWaiting, std::memory_order_acq_rel)) {
+            continue; // Completed meanwhile
+        }
+        if (timeout < 0) {
+            futexWait(&request->state, execWaiting, NULL);
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &left);
+        left.tv_sec = deadline.tv_sec - left.tv_sec;
+        left.tv_nsec = deadline.tv_nsec - left.tv_nsec;
+        if (left.tv_nsec < 0) {
+            left.tv_sec--;
+            left.tv_nsec += 1000000000L;
+        }
+        if (left.tv_sec < 0) return false;
+        futexWait(&request->state, execWaiting, &left);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * executor.h
+ *
+ * Created: 18-10-2026 06:20:56
+ * Author: Subrata
+ * Description: Header file for the thread-safe command executor of the Linux port.
+ *              One I/O thread owns a gateway and all its module contexts; any
+ *              number of application threads submit commands through a lock-free
+ *              multi-producer single-consumer queue (Vyukov's intrusive list) and
+ *              an eventfd wakeup, then wait on the request or get a callback.
+ *              Commands to one module are sent in the order they were queued.
+ */
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <atomic>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gateway.h"
+
+typedef enum {
+    execIdle,   // Not submitted or already collected
+    execQueued, // Submitted, not yet complete
+    execWaiting, // Submitted, a thread sleeps in executorWait
+    execDone    // Complete, status and line are valid
+} execState_t;
+
+struct execRequest;
+struct executor;
+
+// Completion callback, runs on the I/O thread; cmdPending reports listing lines
+typedef void (*execCallback_t)(struct execRequest* request, cmdStatus_t status, const char* line);
+// Event callback, runs on the I/O thread
+typedef void (*execEvent_t)(void* ctx, const gatewayEvent_t* event);
+
+// Caller-owned request, doubles as the future of its result. It must stay valid
+// until it completes. Use either a callback or executorWait on a request, not both;
+// a callback owns the request once it runs and may free or resubmit it.
+typedef struct execRequest {
+    std::atomic<struct execRequest*> next; // Submission queue link
+    struct execRequest* pendingNext;       // Per-module wait list link, I/O thread only
+    struct executor* owner;                // Executor the request was submitted to
+    uint16_t module;                       // Module id
+    char command[CMD_COMMAND_SIZE];        // Command text without carriage return
+    const char* expect;                    // Success substring, must stay valid, NULL accepts any line
+    cmdMatch_t match;                      // Completion rule
+    uint8_t flags;                         // CMD_FLAG_* bits
+    uint16_t timeout;                      // Response timeout in ms
+    execCallback_t callback;               // Completion callback, NULL to wait instead
+    void* ctx;                             // Callback context
+    std::atomic<int> state;                // execState_t, futex word
+    cmdStatus_t status;                    // Result
+    char line[CMD_LINE_SIZE];              // Final response line
+} execRequest_t;
+
+typedef struct executor {
+    gateway_t gw;                                // Gateway, owned by the I/O thread once started
+    pthread_t thread;                            // I/O thread
+    bool running;                                // I/O thread started
+    int epfd;                                    // epoll over the gateway and the wakeup
+    int wakeFd;                                  // eventfd signalled by submitters
+    std::atomic<execRequest_t*> head;            // Newest queued request, producers only
+    execRequest_t* tail;                         // Oldest queued request, I/O thread only
+    execRequest_t stub;                          // Queue sentinel
+    std::atomic<bool> wakePending;               // An eventfd write is outstanding
+    std::atomic<bool> stopping;                  // Stop requested, no new submissions
+    std::atomic<int> submitting;                 // Producers inside executorSubmit
+    execRequest_t* waitHead[GATEWAY_MAX_MODULES]; // Requests waiting for engine room
+    execRequest_t* waitTail[GATEWAY_MAX_MODULES]; // Last waiting request per module
+    execEvent_t onEvent;                         // Event handler, may be NULL
+    void* eventCtx;                              // Event handler context
+    std::atomic<uint32_t> submitted;             // Requests accepted
+    std::atomic<uint32_t> completed;             // Requests completed
+    uint32_t wakeups;                            // eventfd wakeups consumed by the I/O thread
+} executor_t;
+
+bool executorInit(executor_t* exec);
+int executorOpen(executor_t* exec, const char* device);
+int executorAddFd(executor_t* exec, int fd);
+void executorSetEventHandler(executor_t* exec, execEvent_t onEvent, void* ctx);
+bool executorStart(executor_t* exec);
+void executorStop(executor_t* exec);
+
+bool executorPrepare(execRequest_t* request, uint16_t module, const char* command, const char* expect,
+                     cmdMatch_t match, uint16_t timeout);
+bool executorSubmit(executor_t* exec, execRequest_t* request);
+bool executorWait(execRequest_t* request, int timeout);
+
+#endif /* EXECUTOR_H_ */
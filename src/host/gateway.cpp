@@ -0,0 +1,399 @@
+/*
+ * gateway.cpp
+ *
+ * Created: 18-10-2026 05:55:00
+ * Author: Subrata
+ * Description: Implementation of the multi-module gateway engine for the Linux
+ *              port. All serial ports are multiplexed in one epoll loop; no call
+ *              blocks on a single module, so the gateway scales with port count
+ *              without a thread per device.
+ */
+
+#include "gateway.h"
+#include "bleSerial.h"
+#include "rn4871_const.h"
+#include "traceLog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------------
+// Update write interest procedure
+// -----------------------------------------------------------------------------------
+// Input : module - Module context
+// Output: void
+// Registers EPOLLOUT only while bytes are waiting, so idle ports cause no wakeups.
+// -----------------------------------------------------------------------------------
+static void updateWriteInterest(rn4871_t* module) {
+    bool pending = module->txHead != module->txTail;
+    if (pending == module->writeArmed) return;
+
+    struct epoll_event ev;
+    ev.events = pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.u32 = module->id;
+    epoll_ctl(module->gateway->epfd, EPOLL_CTL_MOD, module->fd, &ev);
+    module->writeArmed = pending;
+}
+
+// -----------------------------------------------------------------------------------
+// Flush transmit buffer procedure
+// -----------------------------------------------------------------------------------
+// Input : module - Module context
+// Output: void
+// Writes as much of the transmit buffer as the port accepts without blocking.
+// -----------------------------------------------------------------------------------
+static void flushTx(rn4871_t* module) {
+    while (module->txHead != module->txTail) {
+        uint16_t chunk = (module->txHead > module->txTail) ? module->txHead - module->txTail
+                                                           : GATEWAY_TX_SIZE - module->txTail;
+        ssize_t n = write(module->fd, &module->tx[module->txTail], chunk);
+        if (n <= 0) {
+            break; // Port busy, wait for EPOLLOUT
+        }
+        module->txBytes += n;
+        if (module->gateway->trace != NULL) {
+            traceLogWrite(module->gateway->trace, traceTx, module->id, 0, &module->tx[module->txTail], (uint16_t)n);
+        }
+        module->txTail = (module->txTail + n) & (GATEWAY_TX_SIZE - 1);
+    }
+    updateWriteInterest(module);
+}
+
+// -----------------------------------------------------------------------------------
+// Module write procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Module context, data - Bytes to send, length - Byte count
+// Output: void
+// Output function of the command engine: queues bytes and starts writing them.
+// -----------------------------------------------------------------------------------
+static void moduleWrite(void* ctx, const char* data, uint16_t length) {
+    rn4871_t* module = (rn4871_t*)ctx;
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint16_t next = (module->txHead + 1) & (GATEWAY_TX_SIZE - 1);
+        if (next == module->txTail) {
+            module->txDropped += length - i; // Transmit buffer overflow
+            break;
+        }
+        module->tx[module->txHead] = (uint8_t)data[i];
+        module->txHead = next;
+    }
+    flushTx(module);
+}
+
+// -----------------------------------------------------------------------------------
+// Module event procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Module context, event - Event or unsolicited line
+// Output: void
+// Tracks the connection state and appends the event to the aggregated queue.
+// -----------------------------------------------------------------------------------
+static void moduleEvent(void* ctx, const char* event) {
+    rn4871_t* module = (rn4871_t*)ctx;
+    gateway_t* gw = module->gateway;
+
+    bool wasConnected = module->connected;
+    if (strncmp(event, "CONNECT", 7) == 0) {
+        module->connected = true;
+    } else if (strncmp(event, "DISCONNECT", 10) == 0 || strncmp(event, "REBOOT", 6) == 0) {
+        module->connected = false;
+    }
+    if (module->connected && !wasConnected) {
+        module->connects++;
+    }
+    if (gw->trace != NULL) {
+        traceLogWrite(gw->trace, traceEvent, module->id, 0, event, (uint16_t)strlen(event));
+        if (module->connected != wasConnected) {
+            traceLogWrite(gw->trace, traceConnection, module->id, module->connected ? 1 : 0, NULL, 0);
+        }
+    }
+
+    uint16_t next = (gw->eventHead + 1) & (GATEWAY_EVENT_QUEUE - 1);
+    if (next == gw->eventTail) {
+        gw->eventsDropped++; // Application is not draining events
+        return;
+    }
+    gatewayEvent_t* slot = &gw->events[gw->eventHead];
+    slot->module = module->id;
+    slot->time = module->engine.now;
+    snprintf(slot->text, sizeof(slot->text), "%s", event);
+    gw->eventHead = next;
+}
+
+// -----------------------------------------------------------------------------------
+// Module command done procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Module context, command - Command text, status - Result,
+//         latency - Round trip in ms
+// Output: void
+// Completion observer of the command engine: fills the latency histogram and
+// records the command in the trace log.
+// -----------------------------------------------------------------------------------
+static void moduleCommandDone(void* ctx, const char* command, cmdStatus_t status, uint32_t latency) {
+    static const uint16_t bounds[] = GATEWAY_LATENCY_BOUNDS;
+    static_assert(sizeof(bounds) / sizeof(bounds[0]) == GATEWAY_LATENCY_BUCKETS - 1, "latency histogram bounds");
+    rn4871_t* module = (rn4871_t*)ctx;
+    uint8_t bucket = 0;
+
+    while (bucket < GATEWAY_LATENCY_BUCKETS - 1 && latency > bounds[bucket]) {
+        bucket++;
+    }
+    module->latency[bucket]++;
+    if (module->gateway->trace != NULL) {
+        traceLogCommand(module->gateway->trace, module->id, (uint8_t)status, latency, command);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Gateway initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway
+// Output: bool - True if successful, false otherwise
+// Creates the epoll instance. The gateway structure is large; allocate it statically.
+// -----------------------------------------------------------------------------------
+bool gatewayInit(gateway_t* gw) {
+    memset(gw, 0, sizeof(*gw));
+    gw->epfd = epoll_create1(EPOLL_CLOEXEC);
+    return gw->epfd >= 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Gateway close procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway
+// Output: void
+// Closes all module ports and the epoll instance.
+// -----------------------------------------------------------------------------------
+void gatewayClose(gateway_t* gw) {
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        if (gw->modules[i].fd >= 0) {
+            close(gw->modules[i].fd);
+            gw->modules[i].fd = -1;
+        }
+    }
+    if (gw->epfd >= 0) {
+        close(gw->epfd);
+        gw->epfd = -1;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Add descriptor procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, fd - Open serial or pseudo-terminal descriptor
+// Output: int - Module id or -1 on failure
+// Configures the port, creates the module context and registers it with epoll.
+// -----------------------------------------------------------------------------------
+int gatewayAddFd(gateway_t* gw, int fd) {
+    if (gw->moduleCount >= GATEWAY_MAX_MODULES || !bleConfigureFd(fd)) {
+        return -1;
+    }
+
+    rn4871_t* module = &gw->modules[gw->moduleCount];
+    memset(module, 0, sizeof(*module));
+    module->fd = fd;
+    module->id = gw->moduleCount;
+    module->gateway = gw;
+    cmdInit(&module->engine, moduleWrite, module);
+    cmdSetEventHandler(&module->engine, moduleEvent, module);
+    cmdSetTraceHandler(&module->engine, moduleCommandDone, module);
+    module->engine.now = millis();
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = module->id;
+    if (epoll_ctl(gw->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        return -1;
+    }
+    return gw->moduleCount++;
+}
+
+// -----------------------------------------------------------------------------------
+// Open device procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, device - Serial device path
+// Output: int - Module id or -1 on failure
+// Opens a serial device and adds it to the gateway.
+// -----------------------------------------------------------------------------------
+int gatewayOpen(gateway_t* gw, const char* device) {
+    int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    int id = gatewayAddFd(gw, fd);
+    if (id < 0) {
+        close(fd);
+    }
+    return id;
+}
+
+// -----------------------------------------------------------------------------------
+// Get module procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id
+// Output: rn4871_t* - Module context or NULL
+// -----------------------------------------------------------------------------------
+rn4871_t* gatewayModule(gateway_t* gw, uint16_t id) {
+    return id < gw->moduleCount ? &gw->modules[id] : NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Submit command procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id, remaining as cmdSubmit
+// Output: bool - True if queued, false otherwise
+// Queues a command on one module; the callback runs from gatewayRun.
+// -----------------------------------------------------------------------------------
+bool gatewaySubmit(gateway_t* gw, uint16_t id, const char* command, const char* expect,
+                   cmdMatch_t match, uint16_t timeout, cmdCallback_t callback, void* ctx) {
+    return gatewaySubmitRaw(gw, id, command, expect, match, 0, timeout, callback, ctx);
+}
+
+// -----------------------------------------------------------------------------------
+// Submit command with flags procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id, remaining as cmdSubmitRaw
+// Output: bool - True if queued, false otherwise
+// -----------------------------------------------------------------------------------
+bool gatewaySubmitRaw(gateway_t* gw, uint16_t id, const char* command, const char* expect,
+                      cmdMatch_t match, uint8_t flags, uint16_t timeout, cmdCallback_t callback, void* ctx) {
+    rn4871_t* module = gatewayModule(gw, id);
+    if (module == NULL || module->fd < 0) return false;
+
+    cmdPoll(&module->engine, millis()); // Latency counts from submission when idle
+    return cmdSubmitRaw(&module->engine, command, expect, match, flags, timeout, callback, ctx);
+}
+
+// -----------------------------------------------------------------------------------
+// Enter command mode procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id, callback - Result callback, ctx - Context
+// Output: bool - True if queued, false otherwise
+// Queues the $$$ sequence, completed by the command prompt. The caller is responsible
+// for the guard time of silence the module requires before the sequence.
+// -----------------------------------------------------------------------------------
+bool gatewayEnterCommandMode(gateway_t* gw, uint16_t id, cmdCallback_t callback, void* ctx) {
+    return gatewaySubmitRaw(gw, id, ENTER_CMD, NULL, cmdMatchPrompt, CMD_FLAG_RAW,
+                            DEFAULT_CMD_TIMEOUT, callback, ctx);
+}
+
+// -----------------------------------------------------------------------------------
+// Gateway run procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, maxWait - Longest time to wait for activity in ms, -1 forever
+// Output: int - Number of ports that were serviced, -1 on error
+// Runs one iteration of the event loop: waits until a port is ready or the nearest
+// command deadline, feeds received bytes to the command engines, flushes pending
+// output and completes timed out commands.
+// -----------------------------------------------------------------------------------
+int gatewayRun(gateway_t* gw, int maxWait) {
+    struct epoll_event ready[GATEWAY_MAX_MODULES];
+    uint8_t buffer[GATEWAY_RX_CHUNK];
+    uint32_t now = millis();
+    int wait = maxWait;
+
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        int32_t left = cmdTimeToDeadline(&gw->modules[i].engine, now);
+        if (left >= 0 && (wait < 0 || left < wait)) {
+            wait = (int)left; // Wake up for the nearest timeout
+        }
+    }
+
+    int count = epoll_wait(gw->epfd, ready, GATEWAY_MAX_MODULES, wait);
+    if (count < 0) return -1;
+
+    now = millis();
+    for (int i = 0; i < count; i++) {
+        rn4871_t* module = &gw->modules[ready[i].data.u32];
+        if (ready[i].events & EPOLLOUT) {
+            flushTx(module);
+        }
+        if (ready[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            ssize_t n = read(module->fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                module->rxBytes += n;
+                if (gw->trace != NULL) {
+                    traceLogWrite(gw->trace, traceRx, module->id, 0, buffer, (uint16_t)n);
+                }
+                cmdFeed(&module->engine, buffer, (uint16_t)n, now);
+            } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                epoll_ctl(gw->epfd, EPOLL_CTL_DEL, module->fd, NULL); // Port gone
+                close(module->fd);
+                module->fd = -1;
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        cmdPoll(&gw->modules[i].engine, now);
+    }
+    return count;
+}
+
+// -----------------------------------------------------------------------------------
+// Gateway idle procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway
+// Output: bool - True if no module has a command queued or in flight
+// -----------------------------------------------------------------------------------
+bool gatewayIdle(const gateway_t* gw) {
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        if (!cmdIdle(&gw->modules[i].engine)) return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Pop event procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, event - Destination
+// Output: bool - True if an event was returned, false if the queue is empty
+// Takes the oldest event from the aggregated queue of all modules.
+// -----------------------------------------------------------------------------------
+bool gatewayPopEvent(gateway_t* gw, gatewayEvent_t* event) {
+    if (gw->eventHead == gw->eventTail) return false;
+
+    *event = gw->events[gw->eventTail];
+    gw->eventTail = (gw->eventTail + 1) & (GATEWAY_EVENT_QUEUE - 1);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Set trace log procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, trace - Open trace log, NULL to stop tracing
+// Output: void
+// Records port traffic, events, connection changes and command round trips of all
+// modules. The log is written from gatewayRun and must not be shared with a thread.
+// -----------------------------------------------------------------------------------
+void gatewaySetTrace(gateway_t* gw, struct traceLog* trace) {
+    gw->trace = trace;
+}
+
+// -----------------------------------------------------------------------------------
+// Trace statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway
+// Output: void
+// Appends a statistics snapshot of every module to the trace log, if tracing.
+// -----------------------------------------------------------------------------------
+void gatewayTraceStats(gateway_t* gw) {
+    if (gw->trace == NULL) return;
+
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        const rn4871_t* module = &gw->modules[i];
+        traceStats_t stats;
+        stats.commands = module->engine.stats.commands;
+        stats.errors = module->engine.stats.errors;
+        stats.timeouts = module->engine.stats.timeouts;
+        stats.events = module->engine.stats.events;
+        stats.latencyTotal = module->engine.stats.latencyTotal;
+        stats.latencyMax = module->engine.stats.latencyMax;
+        stats.rxBytes = module->rxBytes;
+        stats.txBytes = module->txBytes;
+        stats.txDropped = module->txDropped;
+        traceLogWrite(gw->trace, traceStats, module->id, 0, &stats, sizeof(stats));
+    }
+}
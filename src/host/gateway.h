@@ -0,0 +1,86 @@
+/*
+ * gateway.h
+ *
+ * Created: 18-10-2026 05:54:23
+ * Author: Subrata
+ * Description: Header file for the multi-module gateway engine of the Linux port.
+ *              Drives many RN4871 modules on separate serial ports from a single
+ *              epoll loop, each with its own command engine, and aggregates their
+ *              events into one queue.
+ */
+
+#ifndef GATEWAY_H_
+#define GATEWAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cmdEngine.h"
+
+// Maximum number of modules per gateway
+#define GATEWAY_MAX_MODULES 64
+// Transmit buffer per module (power of 2)
+#define GATEWAY_TX_SIZE     1024
+// Aggregated event queue length (power of 2)
+#define GATEWAY_EVENT_QUEUE 256
+// Maximum event text length including the terminator
+#define GATEWAY_EVENT_SIZE  64
+// Receive chunk read per readiness notification
+#define GATEWAY_RX_CHUNK    256
+// Upper bounds of the command latency histogram in ms; one more bucket counts the rest
+#define GATEWAY_LATENCY_BOUNDS  { 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000 }
+#define GATEWAY_LATENCY_BUCKETS 11
+
+struct gateway;
+struct traceLog;
+
+typedef struct {
+    uint16_t module;               // Module that raised the event
+    uint32_t time;                 // millis() at reception
+    char text[GATEWAY_EVENT_SIZE]; // Event text without % delimiters
+} gatewayEvent_t;
+
+typedef struct rn4871 {
+    int fd;                        // Serial port descriptor, -1 if closed
+    uint16_t id;                   // Index in the gateway
+    cmdEngine_t engine;            // Command engine of the module
+    uint8_t tx[GATEWAY_TX_SIZE];   // Bytes not yet accepted by the port
+    uint16_t txHead;               // Transmit write index
+    uint16_t txTail;               // Transmit read index
+    bool writeArmed;               // EPOLLOUT is registered
+    bool connected;                // A central is connected
+    uint32_t connects;             // Connections established
+    uint32_t latency[GATEWAY_LATENCY_BUCKETS]; // Command round trips per histogram bucket
+    uint32_t rxBytes;              // Bytes received
+    uint32_t txBytes;              // Bytes written to the port
+    uint32_t txDropped;            // Bytes dropped on transmit buffer overflow
+    struct gateway* gateway;       // Owning gateway
+} rn4871_t;
+
+typedef struct gateway {
+    int epfd;                                   // epoll instance
+    rn4871_t modules[GATEWAY_MAX_MODULES];      // Module contexts
+    uint16_t moduleCount;                       // Modules in use
+    gatewayEvent_t events[GATEWAY_EVENT_QUEUE]; // Aggregated events
+    uint16_t eventHead;                         // Event write index
+    uint16_t eventTail;                         // Event read index
+    uint32_t eventsDropped;                     // Events lost on queue overflow
+    struct traceLog* trace;                     // Binary trace log, NULL if off
+} gateway_t;
+
+bool gatewayInit(gateway_t* gw);
+void gatewayClose(gateway_t* gw);
+int gatewayAddFd(gateway_t* gw, int fd);
+int gatewayOpen(gateway_t* gw, const char* device);
+rn4871_t* gatewayModule(gateway_t* gw, uint16_t id);
+bool gatewaySubmit(gateway_t* gw, uint16_t id, const char* command, const char* expect,
+                   cmdMatch_t match, uint16_t timeout, cmdCallback_t callback, void* ctx);
+bool gatewaySubmitRaw(gateway_t* gw, uint16_t id, const char* command, const char* expect,
+                      cmdMatch_t match, uint8_t flags, uint16_t timeout, cmdCallback_t callback, void* ctx);
+bool gatewayEnterCommandMode(gateway_t* gw, uint16_t id, cmdCallback_t callback, void* ctx);
+int gatewayRun(gateway_t* gw, int maxWait);
+bool gatewayIdle(const gateway_t* gw);
+bool gatewayPopEvent(gateway_t* gw, gatewayEvent_t* event);
+void gatewaySetTrace(gateway_t* gw, struct traceLog* trace);
+void gatewayTraceStats(gateway_t* gw);
+
+#endif /* GATEWAY_H_ */
@@ -0,0 +1,151 @@
+/*
+ * halTermios.h
+ *
+ * Created: 18-10-2026 06:16:18
+ * Author: Subrata
+ * Description: Linux termios backend policy of the hardware abstraction layer.
+ *              A polled UART on a serial device or pseudo-terminal opened in raw
+ *              non-blocking mode, or on an in-process transport such as the
+ *              simulator; serviceTx() and serviceRx() do the work of the AVR
+ *              interrupts. The host bleSerial API is the driver instantiated with
+ *              this policy.
+ */
+
+#ifndef HALTERMIOS_H_
+#define HALTERMIOS_H_
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "bleSerial.h"
+#include "wiring.h"
+
+// Time a drained path waits for the transport before polling again (ms)
+#define BLE_IDLE_WAIT 1
+
+// -----------------------------------------------------------------------------------
+// Linux termios UART policy
+// -----------------------------------------------------------------------------------
+// open() or attach() must be called before the driver's init. Received bytes are
+// only read while the receive ring has room and only when the application polls,
+// so bytes still queued in the kernel count as not yet received and nothing is
+// dropped. Every chunk moved is shown to the tap, if one is set.
+// -----------------------------------------------------------------------------------
+struct LinuxTermios {
+    static const bool polled = true;
+
+    static int& fd(void) {
+        static int value = -1;
+        return value;
+    }
+    static const bleTransport_t*& transport(void) {
+        static const bleTransport_t* value = &fdTransport();
+        return value;
+    }
+    static bleTap_t& tap(void) {
+        static bleTap_t value = NULL;
+        return value;
+    }
+    static void*& tapCtx(void) {
+        static void* value = NULL;
+        return value;
+    }
+
+    // Descriptor transport, used unless an in-process transport is set
+    static int fdRead(void*, uint8_t* data, int length) {
+        return fd() >= 0 ? (int)::read(fd(), data, length) : -1;
+    }
+    static int fdWrite(void*, const uint8_t* data, int length) {
+        return fd() >= 0 ? (int)::write(fd(), data, length) : -1;
+    }
+    static void fdWait(void*, bool forWrite, int timeout) {
+        if (fd() < 0) return;
+
+        struct pollfd pfd = { fd(), (short)(forWrite ? POLLOUT : POLLIN), 0 };
+        poll(&pfd, 1, timeout);
+        if (forWrite && timeout == 0) {
+            tcdrain(fd()); // Fails harmlessly on non-terminals
+        }
+    }
+    static const bleTransport_t& fdTransport(void) {
+        static const bleTransport_t value = { fdRead, fdWrite, fdWait, NULL };
+        return value;
+    }
+
+    static bool attach(int f) {
+        if (!bleConfigureFd(f)) return false;
+        fd() = f;
+        transport() = &fdTransport();
+        return true;
+    }
+    static bool open(const char* device) {
+        int f = ::open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (f < 0) return false;
+        if (!attach(f)) {
+            ::close(f);
+            return false;
+        }
+        return true;
+    }
+    static void close(void) {
+        if (fd() >= 0) ::close(fd());
+        fd() = -1;
+    }
+    static void setTransport(const bleTransport_t* custom) {
+        transport() = custom != NULL ? custom : &fdTransport();
+    }
+    static bool connected(void) { return transport() != &fdTransport() || fd() >= 0; }
+
+    static void begin(void) {}
+    static void txStart(void) {}
+    static void txStop(void) {}
+    static bool txBusy(const ble_uart_t& s) { return s.initialized && s.tx_buffer.head != s.tx_buffer.tail; }
+    static bool txComplete(void) {
+        transport()->wait(transport()->ctx, true, 0); // Drain the driver, no-op when closed
+        return true;
+    }
+    static void idle(bool forWrite) { transport()->wait(transport()->ctx, forWrite, BLE_IDLE_WAIT); }
+    static void serviceTx(ble_uart_t& s) {
+        const bleTransport_t* t = transport();
+        RingBuffer_t* tx = &s.tx_buffer;
+
+        while (tx->head != tx->tail) {
+            uint8_t chunk = (tx->head > tx->tail) ? tx->head - tx->tail : tx->size - tx->tail;
+            int n = t->write(t->ctx, &tx->buffer[tx->tail], chunk);
+            if (n <= 0) break; // Kernel buffer full, retry on next service
+            if (tap() != NULL) tap()(tapCtx(), true, &tx->buffer[tx->tail], (uint16_t)n);
+            tx->tail = (tx->tail + n) & (tx->size - 1);
+        }
+    }
+    static void serviceRx(ble_uart_t& s) {
+        const bleTransport_t* t = transport();
+        RingBuffer_t* rx = &s.rx_buffer;
+
+        while (!RingBuffer_is_full(rx)) {
+            uint8_t limit = (rx->tail > rx->head) ? rx->tail - 1 : rx->size - (rx->tail == 0 ? 1 : 0);
+            int n = t->read(t->ctx, &rx->buffer[rx->head], limit - rx->head);
+            if (n <= 0) break; // Nothing pending
+            if (tap() != NULL) tap()(tapCtx(), false, &rx->buffer[rx->head], (uint16_t)n);
+            rx->head = (rx->head + n) & (rx->size - 1);
+        }
+        uint8_t used = (uint8_t)RingBuffer_available(rx);
+        if (used > s.rxHighWater) {
+            s.rxHighWater = used;
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------------
+// Linux clock policy
+// -----------------------------------------------------------------------------------
+// Follows the wiring clock, so drivers also run on a virtual clock when one is
+// installed.
+// -----------------------------------------------------------------------------------
+struct LinuxClock {
+    static unsigned long now(void) { return millis(); }
+    static bool expired(unsigned long start, unsigned long timeout) { return timeoutExpired(start, timeout); }
+    static void sleep(unsigned long ms) { delay(ms); }
+};
+
+#endif /* HALTERMIOS_H_ */
@@ -0,0 +1,336 @@
+/*
+ * metrics.cpp
+ *
+ * Created: 18-10-2026 06:30:00
+ * Author: Subrata
+ * Description: Implementation of the statistics exporter for the Linux gateway.
+ *              The gateway thread and the publisher exchange whole snapshots
+ *              through a triple buffer: each side owns one buffer and swaps it with
+ *              the middle one in a single atomic exchange, so neither ever waits.
+ */
+
+#include "metrics.h"
+#include "wiring.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Set in middle while the buffer there has not been taken by the publisher
+#define METRICS_FRESH 0x04
+#define METRICS_INDEX 0x03
+
+typedef enum {
+    metricCounter,
+    metricGauge
+} metricKind_t;
+
+// Per-module metric read from a 32-bit field of metricsModule_t
+typedef struct {
+    const char* name;   // Metric name
+    metricKind_t kind;  // Exposition type
+    const char* help;   // HELP text
+    size_t offset;      // Field offset in metricsModule_t
+    double scale;       // Factor applied to the field
+} metricField_t;
+
+static const metricField_t fields[] = {
+    { "rn4871_commands_total", metricCounter, "Commands completed.",
+      offsetof(metricsModule_t, stats.commands), 1.0 },
+    { "rn4871_command_errors_total", metricCounter, "Commands answered with an unexpected response.",
+      offsetof(metricsModule_t, stats.errors), 1.0 },
+    { "rn4871_command_timeouts_total", metricCounter, "Commands without response.",
+      offsetof(metricsModule_t, stats.timeouts), 1.0 },
+    { "rn4871_command_latency_max_seconds", metricGauge, "Longest command round trip.",
+      offsetof(metricsModule_t, stats.latencyMax), 0.001 },
+    { "rn4871_events_total", metricCounter, "Asynchronous events received.",
+      offsetof(metricsModule_t, stats.events), 1.0 },
+    { "rn4871_rx_overflow_bytes_total", metricCounter, "Received bytes dropped from overlong lines.",
+      offsetof(metricsModule_t, stats.overflows), 1.0 },
+    { "rn4871_rx_bytes_total", metricCounter, "Bytes received from the module.",
+      offsetof(metricsModule_t, rxBytes), 1.0 },
+    { "rn4871_tx_bytes_total", metricCounter, "Bytes written to the module.",
+      offsetof(metricsModule_t, txBytes), 1.0 },
+    { "rn4871_tx_dropped_bytes_total", metricCounter, "Bytes dropped on transmit buffer overflow.",
+      offsetof(metricsModule_t, txDropped), 1.0 },
+    { "rn4871_connects_total", metricCounter, "Connections established by a central.",
+      offsetof(metricsModule_t, connects), 1.0 },
+};
+
+// -----------------------------------------------------------------------------------
+// Append text procedure
+// -----------------------------------------------------------------------------------
+// Input : text - Buffer, size - Buffer size, length - Bytes used, updated, format - printf format
+// Output: void
+// Appends formatted text; output beyond the buffer is cut off.
+// -----------------------------------------------------------------------------------
+static void appendf(char* text, size_t size, size_t* length, const char* format, ...) {
+    va_list args;
+
+    if (*length >= size) return;
+    va_start(args, format);
+    int n = vsnprintf(text + *length, size - *length, format, args);
+    va_end(args);
+    if (n > 0) *length = *length + (size_t)n < size ? *length + (size_t)n : size;
+}
+
+static void appendHeader(char* text, size_t size, size_t* length, const char* name, const char* type,
+                         const char* help) {
+    appendf(text, size, length, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// -----------------------------------------------------------------------------------
+// Rate procedure
+// -----------------------------------------------------------------------------------
+// Input : now, before - Counter values, seconds - Time between them
+// Output: double - Change per second, 0 without a time base
+// -----------------------------------------------------------------------------------
+static double rate(uint32_t now, uint32_t before, double seconds) {
+    return seconds > 0 ? (uint32_t)(now - before) / seconds : 0.0;
+}
+
+// -----------------------------------------------------------------------------------
+// Format procedure
+// -----------------------------------------------------------------------------------
+// Input : snapshot - Counters to publish, previous - Earlier snapshot for rates or NULL,
+//         text - Output buffer, size - Buffer size
+// Output: size_t - Length of the formatted text
+// Renders a snapshot in the Prometheus text exposition format, one series per
+// module labelled module="<id>".
+// -----------------------------------------------------------------------------------
+size_t metricsFormat(const metricsSnapshot_t* snapshot, const metricsSnapshot_t* previous,
+                     char* text, size_t size) {
+    static const uint16_t bounds[] = GATEWAY_LATENCY_BOUNDS;
+    size_t length = 0;
+    uint16_t count = snapshot->moduleCount;
+    double seconds = 0;
+
+    if (previous != NULL && previous->moduleCount == count) {
+        seconds = (uint32_t)(snapshot->time - previous->time) / 1000.0;
+    }
+
+    appendHeader(text, size, &length, "rn4871_gateway_modules", "gauge", "Modules driven by the gateway.");
+    appendf(text, size, &length, "rn4871_gateway_modules %u\n", count);
+    appendHeader(text, size, &length, "rn4871_gateway_events_dropped_total", "counter",
+                 "Events lost because the application did not drain the queue.");
+    appendf(text, size, &length, "rn4871_gateway_events_dropped_total %u\n", snapshot->eventsDropped);
+
+    appendHeader(text, size, &length, "rn4871_up", "gauge", "1 if the module's port is open.");
+    for (uint16_t i = 0; i < count; i++) {
+        appendf(text, size, &length, "rn4871_up{module=\"%u\"} %d\n", i, snapshot->modules[i].open ? 1 : 0);
+    }
+    appendHeader(text, size, &length, "rn4871_connected", "gauge", "1 while a central is connected.");
+    for (uint16_t i = 0; i < count; i++) {
+        appendf(text, size, &length, "rn4871_connected{module=\"%u\"} %d\n", i, snapshot->modules[i].connected ? 1 : 0);
+    }
+
+    for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+        appendHeader(text, size, &length, fields[f].name, fields[f].kind == metricCounter ? "counter" : "gauge",
+                     fields[f].help);
+        for (uint16_t i = 0; i < count; i++) {
+            uint32_t value;
+            memcpy(&value, (const uint8_t*)&snapshot->modules[i] + fields[f].offset, sizeof(value));
+            if (fields[f].scale == 1.0) {
+                appendf(text, size, &length, "%s{module=\"%u\"} %u\n", fields[f].name, i, value);
+            } else {
+                appendf(text, size, &length, "%s{module=\"%u\"} %g\n", fields[f].name, i, value * fields[f].scale);
+            }
+        }
+    }
+
+    appendHeader(text, size, &length, "rn4871_command_latency_seconds", "histogram", "Command round trip time.");
+    for (uint16_t i = 0; i < count; i++) {
+        const metricsModule_t* module = &snapshot->modules[i];
+        uint32_t cumulative = 0;
+        for (uint8_t b = 0; b < GATEWAY_LATENCY_BUCKETS; b++) {
+            cumulative += module->latency[b];
+            if (b < GATEWAY_LATENCY_BUCKETS - 1) {
+                appendf(text, size, &length, "rn4871_command_latency_seconds_bucket{module=\"%u\",le=\"%g\"} %u\n",
+                        i, bounds[b] / 1000.0, cumulative);
+            } else {
+                appendf(text, size, &length, "rn4871_command_latency_seconds_bucket{module=\"%u\",le=\"+Inf\"} %u\n",
+                        i, cumulative);
+            }
+        }
+        appendf(text, size, &length, "rn4871_command_latency_seconds_sum{module=\"%u\"} %g\n", i,
+                module->stats.latencyTotal / 1000.0);
+        appendf(text, size, &length, "rn4871_command_latency_seconds_count{module=\"%u\"} %u\n", i, cumulative);
+    }
+
+    appendHeader(text, size, &length, "rn4871_rx_bytes_per_second", "gauge", "Receive rate over the last interval.");
+    for (uint16_t i = 0; i < count; i++) {
+        appendf(text, size, &length, "rn4871_rx_bytes_per_second{module=\"%u\"} %.1f\n", i,
+                seconds > 0 ? rate(snapshot->modules[i].rxBytes, previous->modules[i].rxBytes, seconds) : 0.0);
+    }
+    appendHeader(text, size, &length, "rn4871_tx_bytes_per_second", "gauge", "Transmit rate over the last interval.");
+    for (uint16_t i = 0; i < count; i++) {
+        appendf(text, size, &length, "rn4871_tx_bytes_per_second{module=\"%u\"} %.1f\n", i,
+                seconds > 0 ? rate(snapshot->modules[i].txBytes, previous->modules[i].txBytes, seconds) : 0.0);
+    }
+    return length;
+}
+
+// -----------------------------------------------------------------------------------
+// Write file procedure
+// -----------------------------------------------------------------------------------
+// Input : exporter - Exporter, snapshot - Counters to publish
+// Output: bool - True if the metrics file was replaced
+// Writes a temporary file next to the metrics file and renames it over the old one.
+// -----------------------------------------------------------------------------------
+static bool writeFile(metricsExporter_t* exporter, const metricsSnapshot_t* snapshot) {
+    char temporary[METRICS_PATH_SIZE + 8];
+    size_t length = metricsFormat(snapshot, exporter->havePrevious ? &exporter->previous : NULL,
+                                  exporter->text, METRICS_TEXT_SIZE);
+
+    exporter->previous = *snapshot;
+    exporter->havePrevious = true;
+
+    snprintf(temporary, sizeof(temporary), "%s.tmp", exporter->path);
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    for (size_t done = 0; done < length;) {
+        ssize_t n = write(fd, exporter->text + done, length - done);
+        if (n <= 0) {
+            close(fd);
+            unlink(temporary);
+            return false;
+        }
+        done += (size_t)n;
+    }
+    close(fd);
+    return rename(temporary, exporter->path) == 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Publish procedure
+// -----------------------------------------------------------------------------------
+// Input : exporter - Exporter
+// Output: void
+// Takes the newest snapshot if the gateway handed one over and publishes it.
+// -----------------------------------------------------------------------------------
+static void publish(metricsExporter_t* exporter) {
+    if (!(exporter->middle.load(std::memory_order_relaxed) & METRICS_FRESH)) return;
+
+    uint8_t taken = exporter->middle.exchange(exporter->front, std::memory_order_acq_rel);
+    exporter->front = taken & METRICS_INDEX;
+    if (writeFile(exporter, &exporter->buffers[exporter->front])) {
+        exporter->published++;
+    } else {
+        exporter->failures++;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Publisher thread procedure
+// -----------------------------------------------------------------------------------
+// Input : arg - Exporter
+// Output: void* - NULL
+// Publishes once per interval until stopped, then publishes the final snapshot.
+// -----------------------------------------------------------------------------------
+static void* publisherThread(void* arg) {
+    metricsExporter_t* exporter = (metricsExporter_t*)arg;
+    struct pollfd stop = { exporter->wakeFd, POLLIN, 0 };
+
+    for (;;) {
+        stop.revents = 0;
+        if (poll(&stop, 1, (int)exporter->interval) > 0 && (stop.revents & POLLIN)) break;
+        publish(exporter);
+    }
+    publish(exporter);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Start procedure
+// -----------------------------------------------------------------------------------
+// Input : exporter - Exporter, path - Metrics file, interval - ms, 0 for METRICS_INTERVAL
+// Output: bool - True if the publisher is running
+// The exporter structure is large; allocate it statically or on the heap.
+// -----------------------------------------------------------------------------------
+bool metricsStart(metricsExporter_t* exporter, const char* path, uint32_t interval) {
+    if (strlen(path) >= sizeof(exporter->path)) return false;
+
+    snprintf(exporter->path, sizeof(exporter->path), "%s", path);
+    exporter->interval = interval != 0 ? interval : METRICS_INTERVAL;
+    exporter->middle.store(1);
+    exporter->back = 0;
+    exporter->front = 2;
+    exporter->captured = false;
+    exporter->havePrevious = false;
+    exporter->published = 0;
+    exporter->failures = 0;
+    exporter->running = false;
+    exporter->text = (char*)malloc(METRICS_TEXT_SIZE);
+    exporter->wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (exporter->text == NULL || exporter->wakeFd < 0) {
+        metricsStop(exporter);
+        return false;
+    }
+    millis(); // Start the host clock before the publisher thread exists
+    exporter->running = pthread_create(&exporter->thread, NULL, publisherThread, exporter) == 0;
+    if (!exporter->running) metricsStop(exporter);
+    return exporter->running;
+}
+
+// -----------------------------------------------------------------------------------
+// Capture procedure
+// -----------------------------------------------------------------------------------
+// Input : exporter - Exporter, gw - Gateway
+// Output: void
+// Called by the thread that runs the gateway, as often as convenient; copies the
+// counters at most once per interval and hands them to the publisher without
+// waiting, replacing an unread older snapshot.
+// -----------------------------------------------------------------------------------
+void metricsCapture(metricsExporter_t* exporter, const gateway_t* gw) {
+    uint32_t now = millis();
+
+    if (!exporter->running) return;
+    if (exporter->captured && now - exporter->lastCapture < exporter->interval) return;
+    exporter->lastCapture = now;
+    exporter->captured = true;
+
+    metricsSnapshot_t* snapshot = &exporter->buffers[exporter->back];
+    snapshot->time = now;
+    snapshot->moduleCount = gw->moduleCount;
+    snapshot->eventsDropped = gw->eventsDropped;
+    for (uint16_t i = 0; i < gw->moduleCount; i++) {
+        const rn4871_t* module = &gw->modules[i];
+        metricsModule_t* out = &snapshot->modules[i];
+        out->open = module->fd >= 0;
+        out->connected = module->connected;
+        out->stats = module->engine.stats;
+        memcpy(out->latency, module->latency, sizeof(out->latency));
+        out->connects = module->connects;
+        out->rxBytes = module->rxBytes;
+        out->txBytes = module->txBytes;
+        out->txDropped = module->txDropped;
+    }
+    uint8_t previous = exporter->middle.exchange(exporter->back | METRICS_FRESH, std::memory_order_acq_rel);
+    exporter->back = previous & METRICS_INDEX;
+}
+
+// -----------------------------------------------------------------------------------
+// Stop procedure
+// -----------------------------------------------------------------------------------
+// Input : exporter - Exporter
+// Output: void
+// Stops the publisher after it wrote the last captured snapshot.
+// -----------------------------------------------------------------------------------
+void metricsStop(metricsExporter_t* exporter) {
+    if (exporter->running) {
+        uint64_t one = 1;
+        ssize_t n = write(exporter->wakeFd, &one, sizeof(one));
+        (void)n; // An eventfd counter far from overflow always accepts the write
+        pthread_join(exporter->thread, NULL);
+        exporter->running = false;
+    }
+    if (exporter->wakeFd >= 0) close(exporter->wakeFd);
+    exporter->wakeFd = -1;
+    free(exporter->text);
+    exporter->text = NULL;
+}
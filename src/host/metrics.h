@@ -0,0 +1,74 @@
+/*
+ * metrics.h
+ *
+ * Created: 18-10-2026 06:28:59
+ * Author: Subrata
+ * Description: Header file for the statistics exporter of the Linux gateway. The
+ *              gateway thread copies its counters into a lock-free triple buffer;
+ *              a publisher thread formats the newest snapshot in the Prometheus
+ *              text exposition format and replaces the metrics file atomically
+ *              (write to a temporary file, then rename), so a collector such as
+ *              node_exporter's textfile collector never sees a partial file and the
+ *              I/O path never waits on the file system or a lock.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gateway.h"
+
+// Default interval between snapshots and file rewrites in ms
+#define METRICS_INTERVAL    5000
+// Maximum metrics file path length including the terminator
+#define METRICS_PATH_SIZE   256
+// Bytes reserved for the formatted file
+#define METRICS_TEXT_SIZE   (256UL * 1024UL)
+
+typedef struct {
+    bool open;                                  // Port is open
+    bool connected;                             // A central is connected
+    cmdStats_t stats;                           // Command engine statistics
+    uint32_t latency[GATEWAY_LATENCY_BUCKETS];  // Command round trips per histogram bucket
+    uint32_t connects;                          // Connections established
+    uint32_t rxBytes;                           // Bytes received
+    uint32_t txBytes;                           // Bytes written to the port
+    uint32_t txDropped;                         // Bytes dropped on transmit buffer overflow
+} metricsModule_t;
+
+typedef struct {
+    uint32_t time;                              // millis() at capture
+    uint16_t moduleCount;                       // Modules in use
+    uint32_t eventsDropped;                     // Events lost on queue overflow
+    metricsModule_t modules[GATEWAY_MAX_MODULES];
+} metricsSnapshot_t;
+
+typedef struct {
+    char path[METRICS_PATH_SIZE];               // Metrics file
+    uint32_t interval;                          // Capture and publish interval in ms
+    metricsSnapshot_t buffers[3];               // Triple buffer of snapshots
+    std::atomic<uint8_t> middle;                // Buffer handed over, METRICS_FRESH if unread
+    uint8_t back;                               // Buffer the gateway thread fills
+    uint8_t front;                              // Buffer the publisher reads
+    uint32_t lastCapture;                       // millis() of the last capture
+    bool captured;                              // At least one snapshot was taken
+    metricsSnapshot_t previous;                 // Last published snapshot, for rates
+    bool havePrevious;                          // previous is valid
+    char* text;                                 // Formatting buffer
+    pthread_t thread;                           // Publisher thread
+    int wakeFd;                                 // eventfd that stops the publisher
+    bool running;                               // Publisher started
+    uint32_t published;                         // Files written
+    uint32_t failures;                          // Files that could not be written
+} metricsExporter_t;
+
+bool metricsStart(metricsExporter_t* exporter, const char* path, uint32_t interval);
+void metricsCapture(metricsExporter_t* exporter, const gateway_t* gw);
+void metricsStop(metricsExporter_t* exporter);
+size_t metricsFormat(const metricsSnapshot_t* snapshot, const metricsSnapshot_t* previous,
+                     char* text, size_t size);
+
+#endif /* METRICS_H_ */
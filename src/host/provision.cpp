@@ -0,0 +1,331 @@
+/*
+ * provision.cpp
+ *
+ * Created: 18-10-2026 05:59:03
+ * Author: Subrata
+ * Description: Implementation of module provisioning on the Linux port. The whole
+ *              sequence is queued through the command engine as far as the next
+ *              reboot, so the module never waits on the host between commands.
+ */
+
+#include "provision.h"
+#include "rn4871_const.h"
+#include "wiring.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// -----------------------------------------------------------------------------------
+// Add step procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, type - Step type, command - Command text,
+//         expect - Success substring, match - Completion rule, flags - CMD_FLAG_* bits
+// Output: void
+// Appends one step to the provisioning sequence.
+// -----------------------------------------------------------------------------------
+static void addStep(provUnit_t* unit, provStepType_t type, const char* command, const char* expect,
+                    cmdMatch_t match, uint8_t flags) {
+    if (unit->stepCount >= PROV_MAX_STEPS) return;
+
+    provStep_t* step = &unit->steps[unit->stepCount++];
+    step->type = type;
+    snprintf(step->command, sizeof(step->command), "%s", command);
+    step->expect = expect;
+    step->match = match;
+    step->flags = flags;
+    step->timeout = DEFAULT_CMD_TIMEOUT;
+}
+
+// -----------------------------------------------------------------------------------
+// Fail unit procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, step - Failed step index, detail - Reason
+// Output: void
+// Records the first failure; later steps are no longer submitted.
+// -----------------------------------------------------------------------------------
+static void failUnit(provUnit_t* unit, uint8_t step, const char* detail) {
+    if (unit->result != provRunning) return;
+
+    unit->result = provFailed;
+    unit->failedStep = (int8_t)step;
+    snprintf(unit->detail, sizeof(unit->detail), "%s", detail != NULL ? detail : "");
+    unit->endTime = millis();
+}
+
+// -----------------------------------------------------------------------------------
+// Verify GATT table procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, step - Index of the LS step
+// Output: void
+// Checks the handles and properties collected from the LS listing against the profile.
+// -----------------------------------------------------------------------------------
+static void verifyTable(provUnit_t* unit, uint8_t step) {
+    const provProfile_t* profile = unit->profile;
+
+    if (!unit->serviceSeen) {
+        failUnit(unit, step, "service missing");
+        return;
+    }
+    for (uint8_t i = 0; i < profile->charCount; i++) {
+        if (unit->handles[i] == 0 || unit->properties[i] != profile->chars[i].property) {
+            char detail[48];
+            snprintf(detail, sizeof(detail), "characteristic %u mismatch", i);
+            failUnit(unit, step, detail);
+            return;
+        }
+    }
+}
+
+static void fillQueue(provUnit_t* unit);
+
+// -----------------------------------------------------------------------------------
+// Step completion procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Provisioning unit, status - Result, line - Response line
+// Output: void
+// Steps complete in submission order, so the completed count identifies the step.
+// -----------------------------------------------------------------------------------
+static void onStep(void* ctx, cmdStatus_t status, const char* line) {
+    provUnit_t* unit = (provUnit_t*)ctx;
+    uint8_t index = unit->completed;
+    const provStep_t* step = &unit->steps[index];
+
+    if (status == cmdPending) {
+        char uuid[33];
+        uint16_t handle;
+        uint8_t property;
+        if (!parseLsLine(line, uuid, sizeof(uuid), &handle, &property)) return;
+
+        if (handle == 0) {
+            unit->serviceSeen |= strcasecmp(uuid, unit->profile->serviceUuid) == 0;
+            return;
+        }
+        for (uint8_t i = 0; i < unit->profile->charCount; i++) {
+            if (strcasecmp(uuid, unit->profile->chars[i].uuid) == 0) {
+                unit->handles[i] = handle;
+                unit->properties[i] = property;
+            }
+        }
+        return;
+    }
+
+    unit->completed++;
+    if (status == cmdTimeout) {
+        failUnit(unit, index, "timeout");
+    } else if (status == cmdError) {
+        failUnit(unit, index, line);
+    } else if (step->match == cmdMatchList) {
+        verifyTable(unit, index);
+    }
+
+    if (unit->completed < unit->stepCount && unit->steps[unit->completed].type == provWaitReboot) {
+        unit->rebootSeen = false;
+        unit->waitStart = millis(); // Reboot wait starts once R,1 is acknowledged
+    }
+    fillQueue(unit);
+}
+
+// -----------------------------------------------------------------------------------
+// Fill command queue procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit
+// Output: void
+// Submits steps until the engine queue is full or a reboot wait is reached, and
+// marks the unit passed once every step has completed.
+// -----------------------------------------------------------------------------------
+static void fillQueue(provUnit_t* unit) {
+    while (unit->result == provRunning && unit->submitted < unit->stepCount) {
+        const provStep_t* step = &unit->steps[unit->submitted];
+        if (step->type == provWaitReboot) {
+            return; // Resumed by provisionTask
+        }
+        if (!gatewaySubmitRaw(unit->gw, unit->id, step->command, step->expect, step->match,
+                              step->flags, step->timeout, onStep, unit)) {
+            return; // Queue full, retried on the next completion
+        }
+        unit->submitted++;
+    }
+
+    if (unit->result == provRunning && unit->completed == unit->stepCount) {
+        unit->result = provPassed;
+        unit->endTime = millis();
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Start provisioning procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, gw - Gateway, id - Module id, profile - Configuration
+// Output: void
+// Builds the sequence of the example firmware: command mode, stop advertising, clear
+// services, name, service and characteristics, one LS listing to verify the table,
+// reboot, then advertising power. The caller must have observed the guard time.
+// -----------------------------------------------------------------------------------
+void provisionStart(provUnit_t* unit, gateway_t* gw, uint16_t id, const provProfile_t* profile) {
+    char command[CMD_COMMAND_SIZE];
+
+    memset(unit, 0, sizeof(*unit));
+    unit->gw = gw;
+    unit->id = id;
+    unit->profile = profile;
+    unit->failedStep = -1;
+    unit->startTime = millis();
+
+    addStep(unit, provCommand, ENTER_CMD, NULL, cmdMatchPrompt, CMD_FLAG_RAW);
+    addStep(unit, provCommand, STOP_ADV, AOK_RESP, cmdMatchLine, 0);
+    addStep(unit, provCommand, CLEAR_ALL_SERVICES, AOK_RESP, cmdMatchLine, 0);
+    snprintf(command, sizeof(command), SET_SERIALIZED_NAME "%s", profile->name);
+    addStep(unit, provCommand, command, AOK_RESP, cmdMatchLine, 0);
+    snprintf(command, sizeof(command), DEFINE_SERVICE_UUID "%s", profile->serviceUuid);
+    addStep(unit, provCommand, command, AOK_RESP, cmdMatchLine, 0);
+    for (uint8_t i = 0; i < profile->charCount; i++) {
+        const provChar_t* c = &profile->chars[i];
+        snprintf(command, sizeof(command), DEFINE_CHARACT_UUID "%s,%02X,%02X", c->uuid, c->property, c->octetLen);
+        addStep(unit, provCommand, command, AOK_RESP, cmdMatchLine, 0);
+    }
+    addStep(unit, provCommand, LIST_SERVICES_AND_CHARS, NULL, cmdMatchList, 0);
+    addStep(unit, provCommand, REBOOT, REBOOTING_RESP, cmdMatchLine, 0);
+    addStep(unit, provWaitReboot, "", NULL, cmdMatchLine, 0);
+    addStep(unit, provCommand, ENTER_CMD, NULL, cmdMatchPrompt, CMD_FLAG_RAW);
+    snprintf(command, sizeof(command), SET_ADV_POWER "%u", profile->advPower);
+    addStep(unit, provCommand, command, AOK_RESP, cmdMatchLine, 0);
+    addStep(unit, provCommand, "---", PROMPT_END, cmdMatchLine, 0);
+
+    fillQueue(unit);
+}
+
+// -----------------------------------------------------------------------------------
+// Provisioning event procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, event - Event text from the gateway queue
+// Output: void
+// -----------------------------------------------------------------------------------
+void provisionEvent(provUnit_t* unit, const char* event) {
+    if (unit->result != provRunning || unit->completed >= unit->stepCount) return;
+
+    if (unit->steps[unit->completed].type == provWaitReboot && strcmp(event, "REBOOT") == 0) {
+        unit->rebootSeen = true;
+        unit->waitStart = millis(); // Guard time counts from the reboot event
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Provisioning task procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Provisioning unit, now - Current time in ms
+// Output: void
+// Ends a reboot wait once the guard time after %REBOOT% has passed, or fails the unit
+// if the module does not come back.
+// -----------------------------------------------------------------------------------
+void provisionTask(provUnit_t* unit, uint32_t now) {
+    if (unit->result != provRunning || unit->completed >= unit->stepCount ||
+        unit->steps[unit->completed].type != provWaitReboot) {
+        return;
+    }
+
+    uint32_t elapsed = now - unit->waitStart;
+    if (!unit->rebootSeen && elapsed >= RESET_CMD_TIMEOUT) {
+        failUnit(unit, unit->completed, "no reboot event");
+    } else if (unit->rebootSeen && elapsed >= DELAY_BEFORE_CMD) {
+        unit->completed++;
+        unit->submitted++;
+        fillQueue(unit);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Parse LS line procedure
+// -----------------------------------------------------------------------------------
+// Input : line - One LS listing line, uuid - Receives the UUID, uuidSize - UUID buffer
+//         size, handle - Receives the value handle, property - Receives the property
+// Output: bool - True if the line holds a service or characteristic
+// Service lines carry the UUID only and report handle 0; characteristic lines are
+// indented and carry "UUID,HHHH,PP".
+// -----------------------------------------------------------------------------------
+bool parseLsLine(const char* line, char* uuid, uint8_t uuidSize, uint16_t* handle, uint8_t* property) {
+    uint8_t length = 0;
+    unsigned int h, p;
+
+    while (*line == ' ') line++;
+    while ((*line >= '0' && *line <= '9') || (*line >= 'A' && *line <= 'F') || (*line >= 'a' && *line <= 'f')) {
+        if (length >= uuidSize - 1) return false;
+        uuid[length++] = *line++;
+    }
+    uuid[length] = '\0';
+    if (length != 4 && length != 32) return false; // 16-bit or 128-bit UUID
+
+    *handle = 0;
+    *property = 0;
+    if (*line == '\0') return true; // Service line
+    if (sscanf(line, ",%4x,%2x", &h, &p) != 2) return false;
+    *handle = (uint16_t)h;
+    *property = (uint8_t)p;
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// JSON escape procedure
+// -----------------------------------------------------------------------------------
+// Input : text - String to escape, dest - Destination, size - Destination size
+// Output: const char* - dest, holding text as the contents of a JSON string
+// Escapes quotes, backslashes and control characters; module responses and profile
+// text end up in the report verbatim otherwise. Truncates at a whole character.
+// -----------------------------------------------------------------------------------
+static const char* jsonEscape(const char* text, char* dest, uint16_t size) {
+    uint16_t n = 0;
+
+    for (; *text != '\0'; text++) {
+        uint8_t c = (uint8_t)*text;
+        char escaped[7];
+        if (c == '"' || c == '\\') {
+            snprintf(escaped, sizeof(escaped), "\\%c", c);
+        } else if (c < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04X", c);
+        } else {
+            escaped[0] = (char)c;
+            escaped[1] = '\0';
+        }
+        uint16_t length = (uint16_t)strlen(escaped);
+        if (n + length >= size) break;
+        memcpy(&dest[n], escaped, length);
+        n += length;
+    }
+    dest[n] = '\0';
+    return dest;
+}
+
+// -----------------------------------------------------------------------------------
+// Provisioning report procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Finished unit, device - Port of the unit, buffer - Destination,
+//         size - Buffer size
+// Output: int - Length of the report line
+// Formats the per-unit report as one JSON object.
+// -----------------------------------------------------------------------------------
+int provisionReport(const provUnit_t* unit, const char* device, char* buffer, uint16_t size) {
+    const char* result = unit->result == provPassed ? "passed" : unit->result == provFailed ? "failed" : "running";
+    const rn4871_t* module = gatewayModule(unit->gw, unit->id);
+    char escaped[6 * sizeof(unit->detail)]; // Every character may become \u00XX
+    char escapedStep[6 * sizeof(unit->steps[0].command)];
+    int n = snprintf(buffer, size, "{\"device\":\"%s\",\"result\":\"%s\"",
+                     jsonEscape(device, escaped, sizeof(escaped)), result);
+
+    if (unit->failedStep >= 0 && n < size) {
+        const provStep_t* step = &unit->steps[unit->failedStep];
+        n += snprintf(buffer + n, size - n, ",\"failed_step\":\"%s\",\"detail\":\"%s\"",
+                      step->type == provWaitReboot ? "reboot" : jsonEscape(step->command, escapedStep, sizeof(escapedStep)),
+                      jsonEscape(unit->detail, escaped, sizeof(escaped)));
+    }
+    for (uint8_t i = 0; i < unit->profile->charCount && n < size; i++) {
+        n += snprintf(buffer + n, size - n, "%s\"%04X\"", i == 0 ? ",\"handles\":[" : ",", unit->handles[i]);
+    }
+    if (unit->profile->charCount > 0 && n < size) {
+        n += snprintf(buffer + n, size - n, "]");
+    }
+    if (n < size) {
+        n += snprintf(buffer + n, size - n, ",\"commands\":%lu,\"elapsed_ms\":%lu}",
+                      (unsigned long)module->engine.stats.commands,
+                      (unsigned long)(unit->endTime - unit->startTime));
+    }
+    return n;
+}
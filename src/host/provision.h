@@ -0,0 +1,84 @@
+/*
+ * provision.h
+ *
+ * Created: 18-10-2026 05:58:00
+ * Author: Subrata
+ * Description: Header file for module provisioning on the Linux port. Replays the
+ *              setup sequence of the example firmware on a gateway module through
+ *              the pipelined command engine, verifies the resulting GATT table
+ *              with a single LS listing and records the outcome per unit.
+ */
+
+#ifndef PROVISION_H_
+#define PROVISION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gateway.h"
+
+// Maximum characteristics per provisioning profile
+#define PROV_MAX_CHARS 8
+// Maximum steps of one provisioning run
+#define PROV_MAX_STEPS 24
+
+typedef struct {
+    const char* uuid; // 128-bit UUID as hex string
+    uint8_t property; // Property bitmap
+    uint8_t octetLen; // Maximum value length
+} provChar_t;
+
+typedef struct {
+    const char* name;                 // Serialized device name
+    const char* serviceUuid;          // Private service UUID
+    provChar_t chars[PROV_MAX_CHARS]; // Characteristics of the service
+    uint8_t charCount;                // Characteristics in use
+    uint8_t advPower;                 // Advertising output power after reboot
+} provProfile_t;
+
+typedef enum {
+    provCommand,   // Send a command through the engine
+    provWaitReboot // Wait for %REBOOT% and the guard time before continuing
+} provStepType_t;
+
+typedef struct {
+    provStepType_t type;             // Step type
+    char command[CMD_COMMAND_SIZE];  // Command text
+    const char* expect;              // Substring marking success
+    cmdMatch_t match;                // Completion rule
+    uint8_t flags;                   // CMD_FLAG_* bits
+    uint16_t timeout;                // Response timeout in ms
+} provStep_t;
+
+typedef enum {
+    provRunning, // Steps outstanding
+    provPassed,  // All steps succeeded and the GATT table matches
+    provFailed   // A step failed, see failedStep
+} provResult_t;
+
+typedef struct {
+    gateway_t* gw;                      // Gateway driving the module
+    uint16_t id;                        // Module id in the gateway
+    const provProfile_t* profile;       // Configuration to apply
+    provStep_t steps[PROV_MAX_STEPS];   // Provisioning sequence
+    uint8_t stepCount;                  // Steps in the sequence
+    uint8_t submitted;                  // Steps handed to the engine
+    uint8_t completed;                  // Steps finished
+    bool rebootSeen;                    // %REBOOT% received while waiting
+    uint32_t waitStart;                 // Start of the current reboot wait
+    uint16_t handles[PROV_MAX_CHARS];   // Value handles reported by LS
+    uint8_t properties[PROV_MAX_CHARS]; // Properties reported by LS
+    bool serviceSeen;                   // Service UUID found in the LS listing
+    provResult_t result;                // Outcome
+    int8_t failedStep;                  // Index of the failed step, -1 if none
+    char detail[48];                    // Response or reason of the failure
+    uint32_t startTime;                 // millis() at start
+    uint32_t endTime;                   // millis() at completion
+} provUnit_t;
+
+void provisionStart(provUnit_t* unit, gateway_t* gw, uint16_t id, const provProfile_t* profile);
+void provisionEvent(provUnit_t* unit, const char* event);
+void provisionTask(provUnit_t* unit, uint32_t now);
+bool parseLsLine(const char* line, char* uuid, uint8_t uuidSize, uint16_t* handle, uint8_t* property);
+int provisionReport(const provUnit_t* unit, const char* device, char* buffer, uint16_t size);
+
+#endif /* PROVISION_H_ */
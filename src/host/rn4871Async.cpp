@@ -0,0 +1,354 @@
+/*
+ * rn4871Async.cpp
+ *
+ * Created: 18-10-2026 06:18:26
+ * Author: Subrata
+ * Description: Implementation of the C++20 gateway facade. Engine callbacks only
+ *              record results and queue the awaiting coroutine; coroutines are
+ *              resumed by poll() after the gateway step, so they may submit new
+ *              commands freely.
+ */
+
+#include "rn4871Async.h"
+#include "wiring.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace rn4871host {
+
+// -----------------------------------------------------------------------------------
+// Timer order procedure
+// -----------------------------------------------------------------------------------
+// Input : due times of two timers
+// Output: bool - True if a is due after b, so std heaps keep the earliest on top
+// -----------------------------------------------------------------------------------
+static bool laterThan(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Command
+// -----------------------------------------------------------------------------------
+Command::Command(Gateway& gw, uint16_t id, std::string text, const char* expect, cmdMatch_t match,
+                 uint8_t flags, milliseconds timeout)
+    : gw(&gw), id(id), text(std::move(text)), expect(expect), match(match), flags(flags), timeout(timeout) {}
+
+Command::~Command() {
+    if (handle) gw->cancel(this); // Destroyed with a suspended Task
+}
+
+void Command::await_suspend(std::coroutine_handle<> awaiting) {
+    handle = awaiting;
+    gw->submit(this);
+}
+
+Result Command::await_resume() {
+    handle = {};
+    return std::move(result);
+}
+
+// Engine callback: listing lines are collected, the final status completes the await
+void Command::onDone(void* ctx, cmdStatus_t status, const char* line) {
+    Command* command = static_cast<Command*>(ctx);
+
+    if (status == cmdPending) {
+        command->result.lines.emplace_back(line);
+        return;
+    }
+    command->result.status = status;
+    command->result.line = line != nullptr ? line : "";
+    command->gw->complete(command);
+}
+
+// -----------------------------------------------------------------------------------
+// Sleep
+// -----------------------------------------------------------------------------------
+Sleep::~Sleep() {
+    if (handle) gw->unschedule(handle); // Destroyed with a suspended Task
+}
+
+void Sleep::await_suspend(std::coroutine_handle<> awaiting) {
+    handle = awaiting;
+    gw->schedule(handle, duration);
+}
+
+// -----------------------------------------------------------------------------------
+// Task
+// -----------------------------------------------------------------------------------
+Task& Task::operator=(Task&& other) noexcept {
+    if (this != &other) {
+        if (handle) handle.destroy();
+        handle = std::exchange(other.handle, {});
+    }
+    return *this;
+}
+
+Task::~Task() {
+    if (handle) handle.destroy();
+}
+
+void Task::rethrow() const {
+    if (handle && handle.promise().error) {
+        std::rethrow_exception(handle.promise().error);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Gateway construction
+// -----------------------------------------------------------------------------------
+Gateway::Gateway() : gw(new gateway_t), waiting(GATEWAY_MAX_MODULES) {
+    if (!gatewayInit(gw)) {
+        delete gw;
+        gw = nullptr;
+    }
+}
+
+Gateway::~Gateway() {
+    if (gw != nullptr) {
+        gatewayClose(gw);
+        delete gw;
+    }
+}
+
+int Gateway::open(const char* device) {
+    return gw != nullptr ? gatewayOpen(gw, device) : -1;
+}
+
+int Gateway::addFd(int fd) {
+    return gw != nullptr ? gatewayAddFd(gw, fd) : -1;
+}
+
+// -----------------------------------------------------------------------------------
+// Command builders
+// -----------------------------------------------------------------------------------
+Command Gateway::command(uint16_t id, std::string_view text, const char* expect, milliseconds timeout,
+                         cmdMatch_t match) {
+    return Command(*this, id, std::string(text), expect, match, 0, timeout);
+}
+
+Command Gateway::enterCommandMode(uint16_t id) {
+    return Command(*this, id, ENTER_CMD, nullptr, cmdMatchPrompt, CMD_FLAG_RAW, milliseconds(DEFAULT_CMD_TIMEOUT));
+}
+
+Command Gateway::listServices(uint16_t id, milliseconds timeout) {
+    return Command(*this, id, LIST_SERVICES_AND_CHARS, nullptr, cmdMatchList, 0, timeout);
+}
+
+Command Gateway::writeCharacteristic(uint16_t id, uint16_t handle, std::span<const std::byte> value,
+                                     milliseconds timeout) {
+    static const char hex[] = "0123456789ABCDEF";
+    char prefix[16];
+
+    snprintf(prefix, sizeof(prefix), WRITE_LOCAL_CHARACT "%04X,", handle);
+    std::string text(prefix);
+    text.reserve(text.size() + value.size() * 2);
+    for (std::byte b : value) {
+        text += hex[std::to_integer<uint8_t>(b) >> 4];
+        text += hex[std::to_integer<uint8_t>(b) & 0x0F];
+    }
+    return Command(*this, id, std::move(text), AOK_RESP, cmdMatchLine, 0, timeout);
+}
+
+Command Gateway::readCharacteristic(uint16_t id, uint16_t handle, milliseconds timeout) {
+    char text[16];
+
+    snprintf(text, sizeof(text), READ_LOCAL_CHARACT "%04X", handle);
+    return Command(*this, id, text, nullptr, cmdMatchLine, 0, timeout);
+}
+
+// -----------------------------------------------------------------------------------
+// Submit procedure
+// -----------------------------------------------------------------------------------
+// Input : command - Awaited command
+// Output: void
+// Hands the command to the module's engine, or queues it behind earlier commands
+// when the engine queue is full. Invalid commands complete at once with cmdError.
+// -----------------------------------------------------------------------------------
+void Gateway::submit(Command* command) {
+    rn4871_t* module = gw != nullptr ? gatewayModule(gw, command->id) : nullptr;
+
+    outstanding++;
+    if (module == nullptr || module->fd < 0) {
+        command->result.status = cmdError;
+        command->result.line = "no module";
+        complete(command);
+        return;
+    }
+    if (command->text.size() >= CMD_COMMAND_SIZE) {
+        command->result.status = cmdError;
+        command->result.line = "command too long";
+        complete(command);
+        return;
+    }
+    if (command->timeout.count() < 0 || command->timeout.count() > UINT16_MAX) {
+        command->result.status = cmdError; // The engine keeps timeouts in 16 bits
+        command->result.line = "timeout out of range";
+        complete(command);
+        return;
+    }
+
+    std::deque<Command*>& queue = waiting[command->id];
+    queue.push_back(command);
+    if (queue.size() == 1) {
+        pump(command->id);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Pump procedure
+// -----------------------------------------------------------------------------------
+// Input : id - Module id
+// Output: void
+// Moves waiting commands of one module into its engine while it has room.
+// -----------------------------------------------------------------------------------
+void Gateway::pump(uint16_t id) {
+    std::deque<Command*>& queue = waiting[id];
+
+    while (!queue.empty()) {
+        Command* command = queue.front();
+        if (gw->modules[id].fd < 0) {
+            command->result.status = cmdError; // Port closed while waiting
+            command->result.line = "port closed";
+            complete(command);
+        } else if (!gatewaySubmitRaw(gw, id, command->text.c_str(), command->expect, command->match,
+                                     command->flags, (uint16_t)command->timeout.count(), Command::onDone, command)) {
+            return; // Engine queue full
+        }
+        queue.pop_front();
+    }
+}
+
+void Gateway::complete(Command* command) {
+    ready.push_back(command->handle);
+}
+
+// -----------------------------------------------------------------------------------
+// Unready procedure
+// -----------------------------------------------------------------------------------
+// Input : handle - Coroutine being destroyed
+// Output: bool - True if it was waiting to be resumed and has been removed
+// -----------------------------------------------------------------------------------
+bool Gateway::unready(std::coroutine_handle<> handle) {
+    auto found = std::find(ready.begin(), ready.end(), handle);
+
+    if (found != ready.end()) {
+        ready.erase(found);
+    } else if ((found = std::find(resuming.begin(), resuming.end(), handle)) != resuming.end()) {
+        *found = {}; // poll() is resuming, skip it there
+    } else {
+        return false;
+    }
+    outstanding--;
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Cancel procedure
+// -----------------------------------------------------------------------------------
+// Input : command - Awaited command whose coroutine is being destroyed
+// Output: void
+// Removes every reference the gateway holds to the command: its pending resume, its
+// place in the waiting queue or its engine callback.
+// -----------------------------------------------------------------------------------
+void Gateway::cancel(Command* command) {
+    if (unready(command->handle)) return;
+
+    std::deque<Command*>& queue = waiting[command->id];
+    auto found = std::find(queue.begin(), queue.end(), command);
+    if (found != queue.end()) {
+        queue.erase(found);
+        outstanding--;
+        return;
+    }
+    if (gw != nullptr && cmdDetach(&gw->modules[command->id].engine, command)) {
+        outstanding--;
+    }
+}
+
+void Gateway::schedule(std::coroutine_handle<> handle, milliseconds duration) {
+    outstanding++;
+    timers.push_back(Timer{ (uint32_t)(millis() + duration.count()), handle });
+    std::push_heap(timers.begin(), timers.end(), [](const Timer& a, const Timer& b) { return laterThan(a.due, b.due); });
+}
+
+void Gateway::unschedule(std::coroutine_handle<> handle) {
+    if (unready(handle)) return;
+
+    auto found = std::find_if(timers.begin(), timers.end(), [handle](const Timer& t) { return t.handle == handle; });
+    if (found != timers.end()) {
+        timers.erase(found);
+        std::make_heap(timers.begin(), timers.end(), [](const Timer& a, const Timer& b) { return laterThan(a.due, b.due); });
+        outstanding--;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Poll procedure
+// -----------------------------------------------------------------------------------
+// Input : maxWait - Longest time to wait for activity
+// Output: bool - False on an event loop error
+// One step of the event loop: runs the gateway until activity, the nearest command
+// deadline or the nearest sleep, then resumes every coroutine whose await finished.
+// -----------------------------------------------------------------------------------
+bool Gateway::poll(milliseconds maxWait) {
+    auto later = [](const Timer& a, const Timer& b) { return laterThan(a.due, b.due); };
+    int wait = (int)maxWait.count();
+
+    if (gw == nullptr) return false;
+    if (!ready.empty()) {
+        wait = 0;
+    } else if (!timers.empty()) {
+        int32_t left = (int32_t)(timers.front().due - (uint32_t)millis());
+        if (left < 0) left = 0;
+        if (wait < 0 || left < wait) wait = (int)left;
+    }
+    if (gatewayRun(gw, wait) < 0) return false;
+
+    for (uint16_t id = 0; id < gw->moduleCount; id++) {
+        if (!waiting[id].empty()) pump(id);
+    }
+    uint32_t now = millis();
+    while (!timers.empty() && !laterThan(timers.front().due, now)) {
+        ready.push_back(timers.front().handle);
+        std::pop_heap(timers.begin(), timers.end(), later);
+        timers.pop_back();
+    }
+
+    resuming.swap(ready);
+    for (size_t i = 0; i < resuming.size(); i++) {
+        std::coroutine_handle<> handle = std::exchange(resuming[i], {});
+        if (!handle) continue; // Destroyed by a coroutine resumed before it
+        outstanding--;
+        handle.resume();
+    }
+    resuming.clear();
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Run procedure
+// -----------------------------------------------------------------------------------
+// Input : tasks - Tasks to drive
+// Output: bool - True if every task finished, false if one is blocked on something
+//         the gateway does not know about or the event loop failed
+// -----------------------------------------------------------------------------------
+bool Gateway::run(std::span<Task> tasks) {
+    auto allDone = [&tasks]() {
+        return std::all_of(tasks.begin(), tasks.end(), [](const Task& task) { return task.done(); });
+    };
+
+    while (!allDone()) {
+        if (outstanding == 0) return false; // Nothing in flight can wake the tasks
+        if (!poll(milliseconds(100))) return false;
+    }
+    return true;
+}
+
+std::optional<gatewayEvent_t> Gateway::nextEvent() {
+    gatewayEvent_t event;
+
+    if (gw != nullptr && gatewayPopEvent(gw, &event)) return event;
+    return std::nullopt;
+}
+
+} // namespace rn4871host
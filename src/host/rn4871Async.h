@@ -0,0 +1,191 @@
+/*
+ * rn4871Async.h
+ *
+ * Created: 18-10-2026 06:17:38
+ * Author: Subrata
+ * Description: C++20 facade of the multi-module gateway for Linux hosts. Commands
+ *              are awaitables resumed by the gateway's event loop, so thousands
+ *              of module operations run as coroutines on one thread. Payloads are
+ *              std::span<const std::byte> and timeouts std::chrono durations.
+ *              Build with -std=c++20.
+ */
+
+#ifndef RN4871ASYNC_H_
+#define RN4871ASYNC_H_
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "gateway.h"
+#include "rn4871_const.h"
+
+namespace rn4871host {
+
+using std::chrono::milliseconds;
+
+class Gateway;
+
+// Outcome of one command
+struct Result {
+    cmdStatus_t status = cmdPending; // cmdOk, cmdError or cmdTimeout
+    std::string line;                // Final response line
+    std::vector<std::string> lines;  // Listing lines of cmdMatchList commands
+
+    bool ok() const { return status == cmdOk; }
+};
+
+// -----------------------------------------------------------------------------------
+// Command awaitable
+// -----------------------------------------------------------------------------------
+// Submitted when awaited. If the module's command queue is full it waits in the
+// facade's per-module queue, so any number of coroutines may await one module.
+// Destroyed while awaited, i.e. with its Task, it is withdrawn from the gateway; a
+// command already handed to the module still runs there.
+// -----------------------------------------------------------------------------------
+class Command {
+public:
+    Command(Gateway& gw, uint16_t id, std::string text, const char* expect, cmdMatch_t match,
+            uint8_t flags, milliseconds timeout);
+    Command(Command&&) = default;
+    ~Command();
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    Result await_resume();
+
+private:
+    friend class Gateway;
+    static void onDone(void* ctx, cmdStatus_t status, const char* line);
+
+    Gateway* gw;                   // Owning gateway
+    uint16_t id;                   // Module id
+    std::string text;              // Command text without carriage return
+    const char* expect;            // Success substring, must outlive the command
+    cmdMatch_t match;              // Completion rule
+    uint8_t flags;                 // CMD_FLAG_* bits
+    milliseconds timeout;          // Response timeout
+    std::coroutine_handle<> handle; // Awaiting coroutine
+    Result result;                 // Filled by onDone
+};
+
+// -----------------------------------------------------------------------------------
+// Sleep awaitable
+// -----------------------------------------------------------------------------------
+class Sleep {
+public:
+    Sleep(Gateway& gw, milliseconds duration) : gw(&gw), duration(duration) {}
+    Sleep(Sleep&&) = default;
+    ~Sleep();
+
+    bool await_ready() const noexcept { return duration.count() <= 0; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() noexcept { handle = {}; }
+
+private:
+    Gateway* gw;                    // Owning gateway
+    milliseconds duration;          // Time to sleep
+    std::coroutine_handle<> handle; // Sleeping coroutine until resumed
+};
+
+// -----------------------------------------------------------------------------------
+// Task
+// -----------------------------------------------------------------------------------
+// Coroutine return type for module operations. Starts running when called and is
+// driven to completion by Gateway::run; the frame is freed with the Task. A Task may
+// be destroyed while suspended, which withdraws its pending await, but not after its
+// Gateway.
+// -----------------------------------------------------------------------------------
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        std::exception_ptr error; // Exception that ended the coroutine
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept;
+    Task(const Task&) = delete;
+    ~Task();
+
+    bool done() const { return !handle || handle.done(); }
+    void rethrow() const;
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle; // Coroutine frame
+};
+
+// -----------------------------------------------------------------------------------
+// Gateway
+// -----------------------------------------------------------------------------------
+class Gateway {
+public:
+    Gateway();
+    ~Gateway();
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    bool valid() const { return gw != nullptr; }
+    int open(const char* device);
+    int addFd(int fd);
+    gateway_t* raw() { return gw; }
+
+    // Commands, completed in submission order per module
+    Command command(uint16_t id, std::string_view text, const char* expect = AOK_RESP,
+                    milliseconds timeout = milliseconds(DEFAULT_CMD_TIMEOUT), cmdMatch_t match = cmdMatchLine);
+    Command enterCommandMode(uint16_t id);
+    Command listServices(uint16_t id, milliseconds timeout = milliseconds(DEFAULT_CMD_TIMEOUT));
+    Command writeCharacteristic(uint16_t id, uint16_t handle, std::span<const std::byte> value,
+                                milliseconds timeout = milliseconds(DEFAULT_CMD_TIMEOUT));
+    Command readCharacteristic(uint16_t id, uint16_t handle, milliseconds timeout = milliseconds(DEFAULT_CMD_TIMEOUT));
+    Sleep sleep(milliseconds duration) { return Sleep(*this, duration); }
+
+    // Event loop
+    bool poll(milliseconds maxWait);
+    bool run(std::span<Task> tasks);
+    bool run(Task& task) { return run(std::span<Task>(&task, 1)); }
+    std::optional<gatewayEvent_t> nextEvent();
+    size_t pending() const { return outstanding; }
+
+private:
+    friend class Command;
+    friend class Sleep;
+
+    struct Timer {
+        uint32_t due;                   // millis() when the sleep ends
+        std::coroutine_handle<> handle; // Sleeping coroutine
+    };
+
+    void submit(Command* command);
+    void pump(uint16_t id);
+    void complete(Command* command);
+    void cancel(Command* command);
+    void schedule(std::coroutine_handle<> handle, milliseconds duration);
+    void unschedule(std::coroutine_handle<> handle);
+    bool unready(std::coroutine_handle<> handle);
+
+    gateway_t* gw;                                  // Underlying gateway
+    std::vector<std::deque<Command*>> waiting;      // Commands not yet in the engine, per module
+    std::vector<Timer> timers;                      // Sleeping coroutines, min-heap on due
+    std::vector<std::coroutine_handle<>> ready;     // Coroutines to resume after the loop step
+    std::vector<std::coroutine_handle<>> resuming;  // Coroutines poll() is resuming now
+    size_t outstanding = 0;                         // Awaits not yet resumed
+};
+
+} // namespace rn4871host
+
+#endif /* RN4871ASYNC_H_ */
@@ -0,0 +1,742 @@
+/*
+ * rn4871Sim.cpp
+ *
+ * Created: 18-10-2026 05:50:43
+ * Author: Subrata
+ * Description: Implementation of the RN4871 module simulator. Processes the bytes
+ *              the MCU sends, answers with the responses, prompts and listings of
+ *              the real module and can be served over a pseudo-terminal.
+ */
+
+#include "rn4871Sim.h"
+#include "rn4871_const.h"
+#include <stdio.h>
+#include "wiring.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#define SIM_ESC 0x1B
+
+// -----------------------------------------------------------------------------------
+// Hex digit procedure
+// -----------------------------------------------------------------------------------
+// Input : c - Character to convert
+// Output: int - Value of the hex digit or -1 if invalid
+// Converts a single hexadecimal character to its value.
+// -----------------------------------------------------------------------------------
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// -----------------------------------------------------------------------------------
+// Parse hex number procedure
+// -----------------------------------------------------------------------------------
+// Input : str - Hex string, end - Receives the first unparsed character
+// Output: long - Parsed value or -1 if no digit was found
+// Parses a hexadecimal number terminated by any non-hex character.
+// -----------------------------------------------------------------------------------
+static long parseHex(const char* str, const char** end) {
+    long value = 0;
+    int digits = 0;
+    while (hexDigit(*str) >= 0) {
+        value = (value << 4) | hexDigit(*str++);
+        digits++;
+    }
+    if (end != NULL) *end = str;
+    return digits > 0 ? value : -1;
+}
+
+// -----------------------------------------------------------------------------------
+// Emit string procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, str - Text sent to the MCU
+// Output: void
+// Queues text for the MCU, dropping it when the output queue is full.
+// -----------------------------------------------------------------------------------
+void simEmit(rn4871Sim_t* sim, const char* str) {
+    while (*str) {
+        uint16_t next = (sim->outHead + 1) & (SIM_OUTPUT_SIZE - 1);
+        if (next == sim->outTail) return; // Output queue full
+        sim->out[sim->outHead] = (uint8_t)*str++;
+        sim->outHead = next;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Link limited procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: bool - True if traffic to the central is paced by connection events
+// -----------------------------------------------------------------------------------
+static bool linkLimited(const rn4871Sim_t* sim) {
+    return sim->connected && sim->connInterval > 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Queue data byte procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, data - Data mode byte from the MCU
+// Output: void
+// Packs transparent UART data into packets for the central. Without hardware flow
+// control a full queue loses the byte, as on the module.
+// -----------------------------------------------------------------------------------
+static void queueData(rn4871Sim_t* sim, uint8_t data) {
+    if (!sim->connected) return;
+    if (!linkLimited(sim)) {
+        sim->linkPackets += sim->linkPartial == 0 ? 1 : 0;
+        sim->linkPartial = (sim->linkPartial + 1) % SIM_PACKET_SIZE;
+    } else if (sim->linkQueued >= SIM_LINK_QUEUE) {
+        sim->linkDropped++;
+        return;
+    } else if (++sim->linkPartial == SIM_PACKET_SIZE) {
+        sim->linkPartial = 0;
+        sim->linkQueued++;
+    }
+    if (sim->central != NULL) {
+        sim->central(sim->centralCtx, 0, &data, 1);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Run connection events procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, now - Current time in ms
+// Output: void
+// Sends up to packetsPerEvent queued packets, a partly filled data packet last, at
+// every connection event that has passed. Events with nothing to send are skipped.
+// -----------------------------------------------------------------------------------
+static void runConnEvents(rn4871Sim_t* sim, uint32_t now) {
+    while (linkLimited(sim) && (int32_t)(now - sim->nextConnEvent) >= 0) {
+        if (sim->linkQueued == 0 && sim->linkPartial == 0) {
+            uint32_t missed = (now - sim->nextConnEvent) / sim->connInterval + 1;
+            sim->nextConnEvent += missed * sim->connInterval; // Skip idle events at once
+            break;
+        }
+        uint8_t budget = sim->packetsPerEvent;
+        while (budget > 0 && sim->linkQueued > 0) {
+            sim->linkQueued--;
+            sim->linkPackets++;
+            budget--;
+        }
+        if (budget > 0 && sim->linkPartial > 0) {
+            sim->linkPartial = 0;
+            sim->linkPackets++;
+        }
+        sim->nextConnEvent += sim->connInterval;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Reply procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, response - Response line or NULL for the prompt only
+// Output: void
+// Sends a response line followed by the command prompt.
+// -----------------------------------------------------------------------------------
+static void reply(rn4871Sim_t* sim, const char* response) {
+    if (response != NULL) {
+        simEmit(sim, response);
+        simEmit(sim, CRLF);
+    }
+    simEmit(sim, PROMPT);
+}
+
+// -----------------------------------------------------------------------------------
+// Find attribute procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, handle - Characteristic value handle
+// Output: simAttribute_t* - Matching characteristic or NULL
+// Looks up a characteristic by its value handle.
+// -----------------------------------------------------------------------------------
+static simAttribute_t* findAttribute(rn4871Sim_t* sim, uint16_t handle) {
+    for (uint8_t i = 0; i < sim->attrCount; i++) {
+        if (!sim->attrs[i].isService && sim->attrs[i].handle == handle) {
+            return &sim->attrs[i];
+        }
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Find handle procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, handle - Characteristic value handle
+// Output: const simAttribute_t* - Matching characteristic or NULL
+// Gives tests and tools read access to a characteristic of the GATT table.
+// -----------------------------------------------------------------------------------
+const simAttribute_t* simFindHandle(const rn4871Sim_t* sim, uint16_t handle) {
+    return findAttribute((rn4871Sim_t*)sim, handle);
+}
+
+// -----------------------------------------------------------------------------------
+// Store hex value procedure
+// -----------------------------------------------------------------------------------
+// Input : attr - Characteristic, hex - Value as hex string
+// Output: bool - True if the value is valid, false otherwise
+// Decodes a hex string into the value of a characteristic.
+// -----------------------------------------------------------------------------------
+static bool storeHexValue(simAttribute_t* attr, const char* hex) {
+    size_t len = strlen(hex);
+    if (len % 2 != 0 || len / 2 > attr->octetLen) return false;
+
+    for (size_t i = 0; i < len; i += 2) {
+        int hi = hexDigit(hex[i]);
+        int lo = hexDigit(hex[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        attr->value[i / 2] = (uint8_t)((hi << 4) | lo);
+    }
+    attr->valueLen = (uint8_t)(len / 2);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Add attribute procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, args - Arguments of the PS or PC command, isService - Type
+// Output: bool - True if added, false otherwise
+// Adds a service or characteristic and assigns handles like the module: one for the
+// declaration, one for the value and one for the client configuration descriptor of
+// notifying characteristics.
+// -----------------------------------------------------------------------------------
+static bool addAttribute(rn4871Sim_t* sim, const char* args, bool isService) {
+    if (sim->attrCount >= SIM_MAX_ATTRIBUTES) return false;
+
+    simAttribute_t* attr = &sim->attrs[sim->attrCount];
+    memset(attr, 0, sizeof(*attr));
+    const char* comma = strchr(args, ',');
+    size_t uuidLen = comma != NULL ? (size_t)(comma - args) : strlen(args);
+    if (uuidLen != PRIVATE_SERVICE_LEN && uuidLen != PUBLIC_SERVICE_LEN) return false;
+    memcpy(attr->uuid, args, uuidLen);
+    attr->isService = isService;
+
+    if (isService) {
+        if (comma != NULL) return false;
+        attr->handle = sim->nextHandle++;
+    } else {
+        if (comma == NULL || sim->attrCount == 0) return false; // Needs a service first
+        const char* next;
+        long property = parseHex(comma + 1, &next);
+        long octetLen = (*next == ',') ? parseHex(next + 1, NULL) : -1;
+        if (property < 0 || octetLen < 1 || octetLen > SIM_MAX_VALUE_LEN) return false;
+        attr->property = (uint8_t)property;
+        attr->octetLen = (uint8_t)octetLen;
+        attr->handle = sim->nextHandle + 1; // Declaration precedes the value
+        sim->nextHandle += (property & (NOTIFY_PROPERTY | INDICATE_PROPERTY)) ? 3 : 2;
+    }
+    sim->attrCount++;
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// List services procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: void
+// Emits the LS listing: services flush left, characteristics indented with their
+// handle and property, terminated by END.
+// -----------------------------------------------------------------------------------
+static void listServices(rn4871Sim_t* sim) {
+    char line[64];
+    for (uint8_t i = 0; i < sim->attrCount; i++) {
+        const simAttribute_t* attr = &sim->attrs[i];
+        if (attr->isService) {
+            snprintf(line, sizeof(line), "%s" CRLF, attr->uuid);
+        } else {
+            snprintf(line, sizeof(line), "  %s,%04X,%02X" CRLF, attr->uuid, attr->handle, attr->property);
+        }
+        simEmit(sim, line);
+    }
+    reply(sim, PROMPT_END);
+}
+
+// -----------------------------------------------------------------------------------
+// Reboot procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: void
+// Emulates a module reboot: runtime state is lost, stored configuration is kept and
+// the module comes back in data mode announcing the reboot event. With a boot time
+// set, the event is held back by simTask until the boot completes.
+// -----------------------------------------------------------------------------------
+static void rebootModule(rn4871Sim_t* sim) {
+    simEmit(sim, REBOOTING_RESP CRLF);
+    sim->mode = simDataMode;
+    sim->connected = false;
+    sim->advertising = true;
+    sim->scanning = false;
+    sim->scriptRunning = (sim->features & RUN_SCRIPT_AFTER_POWER_ON_BMP) != 0;
+    if (sim->rebootTime > 0) {
+        sim->rebooting = true;
+        sim->rebootDue = sim->now + sim->rebootTime;
+        return;
+    }
+    simEmit(sim, REBOOT_EVENT);
+}
+
+// -----------------------------------------------------------------------------------
+// Starts with procedure
+// -----------------------------------------------------------------------------------
+// Input : line - Command line, prefix - Command prefix
+// Output: bool - True if the line starts with the prefix
+// -----------------------------------------------------------------------------------
+static bool startsWith(const char* line, const char* prefix) {
+    return strncmp(line, prefix, strlen(prefix)) == 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Execute command procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, line - Complete command line without CR
+// Output: void
+// Executes one command-mode line and queues the module response.
+// -----------------------------------------------------------------------------------
+static void executeCommand(rn4871Sim_t* sim, const char* line) {
+    char value[SIM_MAX_VALUE_LEN * 2 + 1];
+    sim->commands++;
+
+    if (line[0] == '\0') {
+        reply(sim, NULL); // Empty line only prints the prompt
+    } else if (strcmp(line, "---") == 0) {
+        simEmit(sim, PROMPT_END CRLF);
+        sim->mode = simDataMode;
+    } else if (strcmp(line, ENTER_CMD) == 0) {
+        reply(sim, NULL); // Already in command mode
+    } else if (strcmp(line, REBOOT) == 0) {
+        rebootModule(sim);
+    } else if (strcmp(line, FACTORY_RESET) == 0) {
+        simEmit(sim, FACTORY_RESET_RESP CRLF);
+        simInit(sim);
+        simEmit(sim, REBOOT_EVENT);
+    } else if (strcmp(line, CLEAR_ALL_SERVICES) == 0) {
+        sim->attrCount = 0;
+        sim->nextHandle = SIM_FIRST_HANDLE;
+        reply(sim, AOK_RESP);
+    } else if (startsWith(line, DEFINE_SERVICE_UUID)) {
+        reply(sim, addAttribute(sim, line + strlen(DEFINE_SERVICE_UUID), true) ? AOK_RESP : ERR_RESP);
+    } else if (startsWith(line, DEFINE_CHARACT_UUID)) {
+        reply(sim, addAttribute(sim, line + strlen(DEFINE_CHARACT_UUID), false) ? AOK_RESP : ERR_RESP);
+    } else if (strcmp(line, LIST_SERVICES_AND_CHARS) == 0) {
+        listServices(sim);
+    } else if (startsWith(line, WRITE_LOCAL_CHARACT)) {
+        const char* next;
+        simAttribute_t* attr = findAttribute(sim, (uint16_t)parseHex(line + strlen(WRITE_LOCAL_CHARACT), &next));
+        bool notify = attr != NULL && attr->subscribed && sim->connected;
+        if (notify && linkLimited(sim) && sim->linkQueued >= SIM_LINK_QUEUE) {
+            sim->notifyRejected++; // No room for the notification
+            reply(sim, ERR_RESP);
+            return;
+        }
+        bool ok = attr != NULL && *next == ',' && storeHexValue(attr, next + 1);
+        if (ok && notify) {
+            sim->notifications++; // Value goes out to the central
+            if (linkLimited(sim)) {
+                sim->linkQueued++;
+            } else {
+                sim->linkPackets++;
+            }
+            if (sim->central != NULL) {
+                sim->central(sim->centralCtx, attr->handle, attr->value, attr->valueLen);
+            }
+        }
+        reply(sim, ok ? AOK_RESP : ERR_RESP);
+    } else if (startsWith(line, READ_LOCAL_CHARACT)) {
+        simAttribute_t* attr = findAttribute(sim, (uint16_t)parseHex(line + strlen(READ_LOCAL_CHARACT), NULL));
+        if (attr == NULL) {
+            reply(sim, ERR_RESP);
+        } else {
+            for (uint8_t i = 0; i < attr->valueLen; i++) {
+                snprintf(&value[i * 2], 3, "%02X", attr->value[i]);
+            }
+            value[attr->valueLen * 2] = '\0';
+            reply(sim, value);
+        }
+    } else if (strcmp(line, GET_CONNECTION_STATUS) == 0) {
+        if (sim->connected) {
+            snprintf(value, sizeof(value), "%s,0,0", sim->mac);
+            reply(sim, value);
+        } else {
+            reply(sim, NONE_RESP);
+        }
+    } else if (strcmp(line, GET_DEVICE_NAME) == 0) {
+        reply(sim, sim->name);
+    } else if (strcmp(line, DISPLAY_FW_VERSION) == 0) {
+        reply(sim, "RN4871 V1.40 7/9/2019 (c)Microchip Technology Inc");
+    } else if (startsWith(line, SET_SERIALIZED_NAME) || startsWith(line, SET_DEVICE_NAME)) {
+        const char* name = strchr(line, ',') + 1;
+        snprintf(sim->name, sizeof(sim->name), "%s", name);
+        reply(sim, AOK_RESP);
+    } else if (startsWith(line, SET_SUPPORTED_FEATURES)) {
+        long bitmap = parseHex(line + strlen(SET_SUPPORTED_FEATURES), NULL);
+        if (bitmap >= 0) sim->features = (uint16_t)bitmap;
+        reply(sim, bitmap >= 0 ? AOK_RESP : ERR_RESP);
+    } else if (startsWith(line, SET_DEFAULT_SERVICES)) {
+        long bitmap = parseHex(line + strlen(SET_DEFAULT_SERVICES), NULL);
+        if (bitmap >= 0) sim->services = (uint8_t)bitmap;
+        reply(sim, bitmap >= 0 ? AOK_RESP : ERR_RESP);
+    } else if (strcmp(line, START_DEFAULT_ADV) == 0 || startsWith(line, START_CUSTOM_ADV)) {
+        sim->advertising = true;
+        reply(sim, AOK_RESP);
+    } else if (strcmp(line, STOP_ADV) == 0) {
+        sim->advertising = false;
+        reply(sim, AOK_RESP);
+    } else if (strcmp(line, START_DEFAULT_SCAN) == 0 || startsWith(line, START_CUSTOM_SCAN)) {
+        sim->scanning = true;
+        reply(sim, SCANNING_RESP);
+    } else if (strcmp(line, STOP_SCAN) == 0) {
+        sim->scanning = false;
+        reply(sim, AOK_RESP);
+    } else if (strcmp(line, KILL_CONNECTION) == 0) {
+        bool wasConnected = sim->connected;
+        reply(sim, AOK_RESP);
+        if (wasConnected) simDisconnect(sim);
+    } else if (strcmp(line, CLEAR_SCRIPT) == 0) {
+        sim->scriptLen = 0;
+        sim->script[0] = '\0';
+        reply(sim, AOK_RESP);
+    } else if (strcmp(line, ENTER_SCRIPT_INPUT) == 0) {
+        sim->mode = simScriptInput;
+    } else if (strcmp(line, START_SCRIPT) == 0 || strcmp(line, STOP_SCRIPT) == 0) {
+        sim->scriptRunning = strcmp(line, START_SCRIPT) == 0;
+        reply(sim, AOK_RESP);
+    } else if (strcmp(line, LIST_SCRIPT) == 0) {
+        for (uint16_t i = 0; i < sim->scriptLen; i++) {
+            char c[2] = { sim->script[i], '\0' };
+            simEmit(sim, c[0] == '\n' ? CRLF : c);
+        }
+        reply(sim, PROMPT_END);
+    } else if (startsWith(line, SET_ADV_POWER) || startsWith(line, SET_CONN_POWER) ||
+               startsWith(line, SET_BEACON_FEATURES) || startsWith(line, SET_SETTINGS) ||
+               startsWith(line, "SO,") || line[0] == 'I' || line[0] == 'N') {
+        reply(sim, AOK_RESP); // Accepted settings without simulated effect
+    } else {
+        reply(sim, ERR_RESP);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Simulator initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: void
+// Resets the simulator to a factory-new module in data mode.
+// -----------------------------------------------------------------------------------
+void simInit(rn4871Sim_t* sim) {
+    memset(sim, 0, sizeof(*sim));
+    sim->mode = simDataMode;
+    sim->nextHandle = SIM_FIRST_HANDLE;
+    sim->services = DEVICE_INFO_SERVICE | UART_TRANSP_SERVICE;
+    sim->advertising = true;
+    sim->packetsPerEvent = SIM_PACKETS_PER_EVENT;
+    snprintf(sim->name, sizeof(sim->name), "RN4871-SIM");
+    snprintf(sim->mac, sizeof(sim->mac), "001122334455");
+}
+
+// -----------------------------------------------------------------------------------
+// Receive byte procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, data - Byte sent by the MCU
+// Output: void
+// Processes one byte from the MCU according to the current operation mode.
+// -----------------------------------------------------------------------------------
+void simReceive(rn4871Sim_t* sim, uint8_t data) {
+    if (sim->rebooting) return; // UART is not listening during boot
+
+    switch (sim->mode) {
+        case simDataMode:
+            if (data == CMD_CHAR) {
+                if (++sim->dollarCount == 3) {
+                    sim->dollarCount = 0;
+                    sim->mode = simCmdMode;
+                    sim->lineLen = 0;
+                    reply(sim, NULL); // Command mode entered
+                }
+                return;
+            }
+            sim->dollarCount = 0;
+            sim->dataBytes++;
+            queueData(sim, data);
+            if (sim->echoData) {
+                char c[2] = { (char)data, '\0' };
+                simEmit(sim, c);
+            }
+            return;
+
+        case simScriptInput:
+            if (data == SIM_ESC) {
+                sim->mode = simCmdMode;
+                reply(sim, NULL);
+            } else if (data == CR) {
+                if (sim->scriptLen > 0 && sim->script[sim->scriptLen - 1] != '\n' &&
+                    sim->scriptLen < SIM_SCRIPT_SIZE - 1) {
+                    sim->script[sim->scriptLen++] = '\n';
+                }
+            } else if (data != LF && sim->scriptLen < SIM_SCRIPT_SIZE - 1) {
+                sim->script[sim->scriptLen++] = (char)data;
+            }
+            sim->script[sim->scriptLen] = '\0';
+            return;
+
+        case simCmdMode:
+            if (data == CR) {
+                sim->line[sim->lineLen] = '\0';
+                sim->lineLen = 0;
+                executeCommand(sim, sim->line);
+            } else if (data != LF && sim->lineLen < SIM_LINE_SIZE - 1) {
+                sim->line[sim->lineLen++] = (char)data;
+                if (sim->lineLen == 3 && strncmp(sim->line, ENTER_CMD, 3) == 0) {
+                    sim->lineLen = 0; // $$$ while in command mode only prompts
+                    reply(sim, NULL);
+                }
+            }
+            return;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Pending output procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: int - Number of bytes waiting to be sent to the MCU
+// -----------------------------------------------------------------------------------
+int simPending(const rn4871Sim_t* sim) {
+    return (sim->outHead - sim->outTail) & (SIM_OUTPUT_SIZE - 1);
+}
+
+// -----------------------------------------------------------------------------------
+// Transmit procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, data - Destination, length - Maximum number of bytes
+// Output: int - Number of bytes taken from the output queue
+// Takes bytes the module sends to the MCU.
+// -----------------------------------------------------------------------------------
+int simTransmit(rn4871Sim_t* sim, uint8_t* data, int length) {
+    int count = 0;
+    while (count < length && sim->outTail != sim->outHead) {
+        data[count++] = sim->out[sim->outTail];
+        sim->outTail = (sim->outTail + 1) & (SIM_OUTPUT_SIZE - 1);
+    }
+    return count;
+}
+
+// -----------------------------------------------------------------------------------
+// Connect procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, mac - Address of the simulated central or NULL
+// Output: void
+// Simulates a central connecting, which stops advertising and raises the event.
+// -----------------------------------------------------------------------------------
+void simConnect(rn4871Sim_t* sim, const char* mac) {
+    char event[40];
+    if (mac != NULL) {
+        snprintf(sim->mac, sizeof(sim->mac), "%s", mac);
+    }
+    sim->connected = true;
+    sim->advertising = false;
+    sim->linkQueued = 0;
+    sim->linkPartial = 0;
+    sim->nextConnEvent = sim->now + sim->connInterval;
+    snprintf(event, sizeof(event), "%%CONNECT,0,%s%%", sim->mac);
+    simEmit(sim, event);
+}
+
+// -----------------------------------------------------------------------------------
+// Disconnect procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator
+// Output: void
+// Simulates the central disconnecting; the module resumes advertising.
+// -----------------------------------------------------------------------------------
+void simDisconnect(rn4871Sim_t* sim) {
+    sim->connected = false;
+    sim->advertising = true;
+    for (uint8_t i = 0; i < sim->attrCount; i++) {
+        sim->attrs[i].subscribed = false; // Subscriptions end with the connection
+    }
+    simEmit(sim, "%DISCONNECT%");
+}
+
+// -----------------------------------------------------------------------------------
+// Central write procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, handle - Characteristic handle, hexValue - Value as hex
+// Output: bool - True if the write was accepted, false otherwise
+// Simulates a connected central writing a local characteristic, raising the write
+// event towards the MCU.
+// -----------------------------------------------------------------------------------
+bool simCentralWrite(rn4871Sim_t* sim, uint16_t handle, const char* hexValue) {
+    char event[SIM_MAX_VALUE_LEN * 2 + 16];
+    simAttribute_t* attr = findAttribute(sim, handle);
+    if (!sim->connected || attr == NULL || !storeHexValue(attr, hexValue)) {
+        return false;
+    }
+    snprintf(event, sizeof(event), "%%WV,%04X,%s%%", handle, hexValue);
+    simEmit(sim, event);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Central subscribe procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, handle - Characteristic value handle, enable - Subscribe
+//         or unsubscribe
+// Output: bool - True if the characteristic can notify or indicate, false otherwise
+// Simulates a connected central writing the client configuration descriptor, which
+// follows the value handle, raising the descriptor write event towards the MCU.
+// -----------------------------------------------------------------------------------
+bool simCentralSubscribe(rn4871Sim_t* sim, uint16_t handle, bool enable) {
+    char event[24];
+    simAttribute_t* attr = findAttribute(sim, handle);
+    if (!sim->connected || attr == NULL || !(attr->property & (NOTIFY_PROPERTY | INDICATE_PROPERTY))) {
+        return false;
+    }
+    attr->subscribed = enable;
+    snprintf(event, sizeof(event), "%%WC,%04X,%s%%", handle + 1, enable ? "0100" : "0000");
+    simEmit(sim, event);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Serve file descriptor procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, fd - Non-blocking descriptor connected to the MCU side
+// Output: bool - False once the descriptor is closed, true otherwise
+// Feeds received bytes into the simulator and writes pending output without
+// blocking. Call whenever the descriptor is readable or output is pending.
+// -----------------------------------------------------------------------------------
+bool simServe(rn4871Sim_t* sim, int fd) {
+    uint8_t buffer[256];
+    ssize_t n;
+
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        if (sim->tap != NULL) {
+            sim->tap(sim->tapCtx, true, buffer, (uint16_t)n);
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            simReceive(sim, buffer[i]);
+        }
+    }
+    if (n == 0) return false; // Peer closed
+
+    while (simPending(sim) > 0) {
+        uint16_t tail = sim->outTail;
+        int chunk = simTransmit(sim, buffer, sizeof(buffer));
+        n = write(fd, buffer, chunk);
+        if (n > 0 && sim->tap != NULL) {
+            sim->tap(sim->tapCtx, false, buffer, (uint16_t)n);
+        }
+        if (n < chunk) {
+            sim->outTail = (tail + (n > 0 ? n : 0)) & (SIM_OUTPUT_SIZE - 1); // Keep unsent bytes
+            break;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Simulator task procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, now - Current time in ms
+// Output: void
+// Advances the simulator clock and completes a pending boot.
+// -----------------------------------------------------------------------------------
+void simTask(rn4871Sim_t* sim, uint32_t now) {
+    sim->now = now;
+    if (sim->rebooting && (int32_t)(now - sim->rebootDue) >= 0) {
+        sim->rebooting = false;
+        simEmit(sim, REBOOT_EVENT);
+    }
+    runConnEvents(sim, now);
+}
+
+// -----------------------------------------------------------------------------------
+// Time to next event procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, now - Current time in ms
+// Output: int32_t - Milliseconds until simTask has work, -1 if nothing is scheduled
+// -----------------------------------------------------------------------------------
+int32_t simTimeToEvent(const rn4871Sim_t* sim, uint32_t now) {
+    int32_t next = -1;
+
+    if (sim->rebooting) {
+        int32_t left = (int32_t)(sim->rebootDue - now);
+        next = left > 0 ? left : 0;
+    }
+    if (linkLimited(sim) && (sim->linkQueued > 0 || sim->linkPartial > 0)) {
+        int32_t left = (int32_t)(sim->nextConnEvent - now);
+        left = left > 0 ? left : 0;
+        if (next < 0 || left < next) next = left;
+    }
+    return next;
+}
+
+// -----------------------------------------------------------------------------------
+// Open pseudo-terminal procedure
+// -----------------------------------------------------------------------------------
+// Input : slavePath - Receives the path of the terminal side, size - Path buffer size
+// Output: int - Non-blocking master descriptor or -1 on failure
+// Creates a pseudo-terminal pair; the library opens the slave like a USB-UART.
+// -----------------------------------------------------------------------------------
+int simOpenPty(char* slavePath, size_t size) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) return -1;
+    if (grantpt(master) != 0 || unlockpt(master) != 0 || ptsname_r(master, slavePath, size) != 0) {
+        close(master);
+        return -1;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+// -----------------------------------------------------------------------------------
+// Serve many simulators procedure
+// -----------------------------------------------------------------------------------
+// Input : sims - Initialized simulators, masters - Master sides of the pty pairs,
+//         count - Number of pairs
+// Output: void
+// Serves one simulator per pty from a single epoll loop until every terminal side
+// is closed. Intended as the main loop of a child process.
+// -----------------------------------------------------------------------------------
+void simServeMany(rn4871Sim_t* sims, const int* masters, int count) {
+    struct epoll_event ready[64];
+    int epfd = epoll_create1(0);
+    int open = count;
+
+    for (int i = 0; i < count; i++) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, masters[i], &ev);
+    }
+    while (open > 0) {
+        uint32_t now = millis();
+        int wait = -1;
+        for (int i = 0; i < count; i++) {
+            int32_t left = simTimeToEvent(&sims[i], now);
+            if (left >= 0 && (wait < 0 || left < wait)) wait = (int)left;
+        }
+
+        int n = epoll_wait(epfd, ready, 64, wait);
+        now = millis();
+        for (int i = 0; i < n; i++) {
+            int index = ready[i].data.u32;
+            simTask(&sims[index], now);
+            if (!simServe(&sims[index], masters[index]) || (ready[i].events & EPOLLHUP)) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, masters[index], NULL); // Terminal side closed
+                open--;
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            if (simTimeToEvent(&sims[i], now) == 0) {
+                simTask(&sims[i], now);
+                simServe(&sims[i], masters[i]); // Deliver the reboot event
+            }
+        }
+    }
+    close(epfd);
+}
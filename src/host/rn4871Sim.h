@@ -0,0 +1,119 @@
+/*
+ * rn4871Sim.h
+ *
+ * Created: 18-10-2026 05:49:57
+ * Author: Subrata
+ * Description: Header file for the RN4871 module simulator used with the Linux
+ *              port. Emulates the ASCII command interface, GATT table, operation
+ *              modes and events so the library can be driven without hardware.
+ */
+
+#ifndef RN4871SIM_H_
+#define RN4871SIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum number of services and characteristics held by the simulator
+#define SIM_MAX_ATTRIBUTES 32
+// Maximum characteristic value length in bytes
+#define SIM_MAX_VALUE_LEN  20
+// Command line buffer size
+#define SIM_LINE_SIZE      128
+// Output queue size towards the MCU (power of 2)
+#define SIM_OUTPUT_SIZE    4096
+// Script storage size
+#define SIM_SCRIPT_SIZE    512
+// First handle assigned to a user defined service
+#define SIM_FIRST_HANDLE   0x0071
+// Packets the module buffers towards the central
+#define SIM_LINK_QUEUE     8
+// Payload bytes per packet at the default MTU
+#define SIM_PACKET_SIZE    20
+// Packets sent per connection event unless configured otherwise
+#define SIM_PACKETS_PER_EVENT 4
+
+typedef enum {
+    simDataMode,   // Transparent UART data mode
+    simCmdMode,    // Command mode
+    simScriptInput // Script input mode entered with WW
+} simMode_t;
+
+typedef struct {
+    bool isService;                   // Service or characteristic entry
+    char uuid[33];                    // 16-bit or 128-bit UUID as hex string
+    uint16_t handle;                  // Value handle (declaration handle for services)
+    uint8_t property;                 // Characteristic property bitmap
+    uint8_t octetLen;                 // Maximum value length
+    uint8_t value[SIM_MAX_VALUE_LEN]; // Current value
+    uint8_t valueLen;                 // Current value length
+    bool subscribed;                  // Central enabled notifications or indications
+} simAttribute_t;
+
+// Observer of the served byte stream, transmit is true for bytes from the MCU
+typedef void (*simTap_t)(void* ctx, bool transmit, const uint8_t* data, uint16_t length);
+// Observer of values accepted for the central: notifications with their value handle,
+// transparent UART data with handle 0
+typedef void (*simCentral_t)(void* ctx, uint16_t handle, const uint8_t* data, uint16_t length);
+
+typedef struct {
+    simMode_t mode;                             // Current operation mode
+    char line[SIM_LINE_SIZE];                   // Command line being received
+    uint8_t lineLen;                            // Characters in the command line
+    uint8_t dollarCount;                        // Consecutive '$' received in data mode
+    simAttribute_t attrs[SIM_MAX_ATTRIBUTES];   // GATT table
+    uint8_t attrCount;                          // Entries in the GATT table
+    uint16_t nextHandle;                        // Next free handle
+    char name[21];                              // Device name
+    uint16_t features;                          // Supported features bitmap (SR)
+    uint8_t services;                           // Default services bitmap (SS)
+    char mac[13];                               // Simulated peer address
+    bool connected;                             // A central is connected
+    bool advertising;                           // Advertising is active
+    bool scanning;                              // Scanning is active
+    bool echoData;                              // Echo data mode bytes back to the MCU
+    uint16_t rebootTime;                        // Simulated boot time in ms, 0 for instant
+    bool rebooting;                             // Boot in progress, input is ignored
+    uint32_t rebootDue;                         // Time the boot completes
+    uint32_t now;                               // Time of the last simTask call
+    simTap_t tap;                               // Byte stream observer of simServe, may be NULL
+    void* tapCtx;                               // Observer context
+    char script[SIM_SCRIPT_SIZE];               // Stored script, lines ended by '\n'
+    uint16_t scriptLen;                         // Characters in the script
+    bool scriptRunning;                         // Script execution is active
+    uint8_t out[SIM_OUTPUT_SIZE];               // Output queue towards the MCU
+    uint16_t outHead;                           // Output queue write index
+    uint16_t outTail;                           // Output queue read index
+    uint32_t commands;                          // Commands processed
+    uint32_t dataBytes;                         // Data mode bytes received from the MCU
+    uint32_t notifications;                     // Values accepted for a subscribed central
+    uint16_t connInterval;                      // Connection interval in ms, 0 for an unlimited link
+    uint8_t packetsPerEvent;                    // Packets sent per connection event
+    uint8_t linkQueued;                         // Packets waiting for a connection event
+    uint8_t linkPartial;                        // Data mode bytes of the packet being filled
+    uint32_t nextConnEvent;                     // Time of the next connection event
+    uint32_t linkPackets;                       // Packets sent over the air
+    uint32_t linkDropped;                       // Data mode bytes lost on a full link queue
+    uint32_t notifyRejected;                    // Notifications refused on a full link queue
+    simCentral_t central;                       // Observer of values for the central, may be NULL
+    void* centralCtx;                           // Observer context
+} rn4871Sim_t;
+
+void simInit(rn4871Sim_t* sim);
+void simReceive(rn4871Sim_t* sim, uint8_t data);
+int simPending(const rn4871Sim_t* sim);
+int simTransmit(rn4871Sim_t* sim, uint8_t* data, int length);
+void simEmit(rn4871Sim_t* sim, const char* str);
+void simConnect(rn4871Sim_t* sim, const char* mac);
+void simDisconnect(rn4871Sim_t* sim);
+bool simCentralWrite(rn4871Sim_t* sim, uint16_t handle, const char* hexValue);
+bool simCentralSubscribe(rn4871Sim_t* sim, uint16_t handle, bool enable);
+const simAttribute_t* simFindHandle(const rn4871Sim_t* sim, uint16_t handle);
+bool simServe(rn4871Sim_t* sim, int fd);
+void simTask(rn4871Sim_t* sim, uint32_t now);
+int32_t simTimeToEvent(const rn4871Sim_t* sim, uint32_t now);
+int simOpenPty(char* slavePath, size_t size);
+void simServeMany(rn4871Sim_t* sims, const int* masters, int count);
+
+#endif /* RN4871SIM_H_ */
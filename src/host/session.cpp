@@ -0,0 +1,467 @@
+/*
+ * session.cpp
+ *
+ * Created: 18-10-2026 06:03:17
+ * Author: Subrata
+ * Description: Implementation of session recording and replay for the Linux port.
+ *              During replay the session acts as the module: transmitted bytes are
+ *              matched against the recording and received bytes are released with
+ *              the recorded delay after the record they followed, measured on the
+ *              virtual clock, which skips idle time.
+ */
+
+#include "session.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------------
+// Write escaped bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : file - Destination, data - Bytes, length - Number of bytes
+// Output: void
+// -----------------------------------------------------------------------------------
+static void writeEscaped(FILE* file, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (c == '\r') {
+            fputs("\\r", file);
+        } else if (c == '\n') {
+            fputs("\\n", file);
+        } else if (c == '\t') {
+            fputs("\\t", file);
+        } else if (c == '\\') {
+            fputs("\\\\", file);
+        } else if (c < 0x20 || c > 0x7E) {
+            fprintf(file, "\\x%02X", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Flush pending record procedure
+// -----------------------------------------------------------------------------------
+// Input : rec - Recorder
+// Output: void
+// Writes the merged byte record, if any.
+// -----------------------------------------------------------------------------------
+static void flushPending(sessionRecorder_t* rec) {
+    if (rec->pendingLen == 0) return;
+
+    fprintf(rec->file, "%c %lu ", rec->pendingDir == sessionTx ? 'T' : 'R', (unsigned long)rec->pendingTime);
+    writeEscaped(rec->file, rec->pending, rec->pendingLen);
+    fputc('\n', rec->file);
+    rec->pendingLen = 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Open recording procedure
+// -----------------------------------------------------------------------------------
+// Input : rec - Recorder, path - Session file to create
+// Output: bool - True if the file was created
+// Starts a session; record times are relative to this call.
+// -----------------------------------------------------------------------------------
+bool sessionRecordOpen(sessionRecorder_t* rec, const char* path) {
+    memset(rec, 0, sizeof(*rec));
+    rec->file = fopen(path, "w");
+    if (rec->file == NULL) return false;
+
+    rec->origin = millis();
+    fputs("# rn4871 session v1\n", rec->file);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Record bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : rec - Recorder, transmit - True for bytes sent to the module, data - Bytes,
+//         length - Number of bytes, time - ms since the start of the session
+// Output: void
+// Appends bytes, merging chunks of the same direction and millisecond into one record.
+// -----------------------------------------------------------------------------------
+void sessionRecordBytes(sessionRecorder_t* rec, bool transmit, const uint8_t* data, uint16_t length, uint32_t time) {
+    sessionDir_t dir = transmit ? sessionTx : sessionRx;
+
+    if (rec->file == NULL) return;
+    for (uint16_t i = 0; i < length; i++) {
+        if (rec->pendingLen > 0 && (rec->pendingDir != dir || rec->pendingTime != time ||
+                                    rec->pendingLen == SESSION_RECORD_SIZE)) {
+            flushPending(rec);
+        }
+        rec->pendingDir = dir;
+        rec->pendingTime = time;
+        rec->pending[rec->pendingLen++] = data[i];
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Record API result procedure
+// -----------------------------------------------------------------------------------
+// Input : rec - Recorder, name - Library call, value - Result as text without spaces
+// Output: void
+// -----------------------------------------------------------------------------------
+void sessionRecordApi(sessionRecorder_t* rec, const char* name, const char* value) {
+    if (rec->file == NULL) return;
+
+    flushPending(rec);
+    fprintf(rec->file, "A %lu %s ", (unsigned long)(millis() - rec->origin), name);
+    writeEscaped(rec->file, (const uint8_t*)value, (uint16_t)strlen(value));
+    fputc('\n', rec->file);
+}
+
+// -----------------------------------------------------------------------------------
+// Close recording procedure
+// -----------------------------------------------------------------------------------
+// Input : rec - Recorder
+// Output: void
+// -----------------------------------------------------------------------------------
+void sessionRecordClose(sessionRecorder_t* rec) {
+    if (rec->file == NULL) return;
+
+    flushPending(rec);
+    fclose(rec->file);
+    rec->file = NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Serial tap procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Recorder, transmit - Direction, data - Bytes, length - Number of bytes
+// Output: void
+// bleTap_t adapter recording the host port's byte stream with millis() timestamps.
+// -----------------------------------------------------------------------------------
+void sessionTap(void* ctx, bool transmit, const uint8_t* data, uint16_t length) {
+    sessionRecorder_t* rec = (sessionRecorder_t*)ctx;
+    sessionRecordBytes(rec, transmit, data, length, millis() - rec->origin);
+}
+
+// -----------------------------------------------------------------------------------
+// Decode escaped bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : text - Escaped text, data - Destination, size - Destination size
+// Output: uint16_t - Number of decoded bytes
+// -----------------------------------------------------------------------------------
+static uint16_t decodeEscaped(const char* text, uint8_t* data, uint16_t size) {
+    uint16_t length = 0;
+
+    while (*text != '\0' && length < size) {
+        if (*text != '\\') {
+            data[length++] = (uint8_t)*text++;
+            continue;
+        }
+        text++;
+        switch (*text) {
+            case 'r': data[length++] = '\r'; text++; break;
+            case 'n': data[length++] = '\n'; text++; break;
+            case 't': data[length++] = '\t'; text++; break;
+            case 'x': {
+                unsigned int value = 0;
+                sscanf(text + 1, "%2x", &value);
+                data[length++] = (uint8_t)value;
+                text += (text[1] != '\0' && text[2] != '\0') ? 3 : 1;
+                break;
+            }
+            case '\0': break;
+            default: data[length++] = (uint8_t)*text++; break;
+        }
+    }
+    return length;
+}
+
+// -----------------------------------------------------------------------------------
+// Next record procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session, from - First index to consider, dir - Record type
+// Output: uint32_t - Index of the next record of that type, or count if none
+// -----------------------------------------------------------------------------------
+static uint32_t nextRecord(const session_t* session, uint32_t from, sessionDir_t dir) {
+    while (from < session->count && session->records[from].dir != dir) from++;
+    return from;
+}
+
+// -----------------------------------------------------------------------------------
+// Load session procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session, path - Session file
+// Output: bool - True if the file was read
+// -----------------------------------------------------------------------------------
+bool sessionLoad(session_t* session, const char* path) {
+    char line[SESSION_RECORD_SIZE * 4 + 64];
+    uint8_t data[SESSION_RECORD_SIZE * 2];
+    uint32_t capacity = 0;
+
+    memset(session, 0, sizeof(*session));
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char type;
+        unsigned long time;
+        int offset;
+
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || sscanf(line, "%c %lu %n", &type, &time, &offset) < 2) continue;
+        if (type != 'T' && type != 'R' && type != 'A') continue;
+
+        if (session->count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            session->records = (sessionRecord_t*)realloc(session->records, capacity * sizeof(sessionRecord_t));
+        }
+        sessionRecord_t* record = &session->records[session->count++];
+        record->dir = type == 'T' ? sessionTx : type == 'R' ? sessionRx : sessionApi;
+        record->time = (uint32_t)time;
+        record->length = decodeEscaped(line + offset, data, sizeof(data));
+        record->data = (uint8_t*)malloc(record->length + 1);
+        memcpy(record->data, data, record->length);
+        record->data[record->length] = '\0';
+        if (record->dir == sessionApi) session->apiCount++;
+    }
+    fclose(file);
+
+    session->actual = (uint32_t*)calloc(session->count + 1, sizeof(uint32_t));
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Free session procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session
+// Output: void
+// -----------------------------------------------------------------------------------
+void sessionFree(session_t* session) {
+    for (uint32_t i = 0; i < session->count; i++) {
+        free(session->records[i].data);
+    }
+    free(session->records);
+    free(session->actual);
+    memset(session, 0, sizeof(*session));
+}
+
+// -----------------------------------------------------------------------------------
+// Fail replay procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session, message - Description of the divergence
+// Output: void
+// Keeps the first divergence; the replay stops delivering bytes afterwards.
+// -----------------------------------------------------------------------------------
+static void failReplay(session_t* session, const char* message) {
+    if (session->failed) return;
+
+    session->failed = true;
+    snprintf(session->error, sizeof(session->error), "%s", message);
+}
+
+// -----------------------------------------------------------------------------------
+// Receive record due time procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session, index - Receive record
+// Output: uint32_t - Virtual time the record arrives
+// A received record keeps its recorded distance to the byte record before it: the
+// arrival of a previous received record, or the completion of a transmitted one.
+// -----------------------------------------------------------------------------------
+static uint32_t dueTime(const session_t* session, uint32_t index) {
+    uint32_t prev = index;
+    while (prev > 0) {
+        prev--;
+        if (session->records[prev].dir != sessionApi) {
+            return session->actual[prev] + (session->records[index].time - session->records[prev].time);
+        }
+    }
+    return session->records[index].time;
+}
+
+// -----------------------------------------------------------------------------------
+// Receive record ready procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session
+// Output: bool - True if the next receive record only waits for its due time
+// A received record is held back until every byte transmitted before it matched.
+// -----------------------------------------------------------------------------------
+static bool rxReady(const session_t* session) {
+    return !session->failed && session->rxRecord < session->count && session->txRecord > session->rxRecord;
+}
+
+// -----------------------------------------------------------------------------------
+// Replay read procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Session, data - Destination, length - Maximum number of bytes
+// Output: int - Bytes delivered
+// Delivers received bytes whose arrival time has been reached.
+// -----------------------------------------------------------------------------------
+static int replayRead(void* ctx, uint8_t* data, int length) {
+    session_t* session = (session_t*)ctx;
+    int delivered = 0;
+
+    while (delivered < length && rxReady(session)) {
+        sessionRecord_t* record = &session->records[session->rxRecord];
+        uint32_t due = dueTime(session, session->rxRecord);
+        if ((int32_t)(session->clock.now - due) < 0) break;
+
+        session->actual[session->rxRecord] = due;
+        uint16_t chunk = record->length - session->rxOffset;
+        if (chunk > length - delivered) chunk = (uint16_t)(length - delivered);
+        memcpy(&data[delivered], &record->data[session->rxOffset], chunk);
+        vclockActivity(&session->clock);
+        delivered += chunk;
+        session->rxOffset += chunk;
+        if (session->rxOffset == record->length) {
+            session->rxRecord = nextRecord(session, session->rxRecord + 1, sessionRx);
+            session->rxOffset = 0;
+        }
+    }
+    return delivered;
+}
+
+// -----------------------------------------------------------------------------------
+// Replay write procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Session, data - Bytes sent by the library, length - Number of bytes
+// Output: int - Bytes accepted
+// Matches transmitted bytes against the recording byte by byte.
+// -----------------------------------------------------------------------------------
+static int replayWrite(void* ctx, const uint8_t* data, int length) {
+    session_t* session = (session_t*)ctx;
+    char message[128];
+
+    for (int i = 0; i < length && !session->failed; i++) {
+        if (session->txRecord >= session->count) {
+            snprintf(message, sizeof(message), "unexpected transmit 0x%02X at %lu ms", data[i],
+                     (unsigned long)session->clock.now);
+            failReplay(session, message);
+            break;
+        }
+        sessionRecord_t* record = &session->records[session->txRecord];
+        if (record->data[session->txOffset] != data[i]) {
+            snprintf(message, sizeof(message), "transmit mismatch in record %lu: expected \"%s\" byte %u, got 0x%02X",
+                     (unsigned long)session->txRecord + 1, (const char*)record->data, session->txOffset, data[i]);
+            failReplay(session, message);
+            break;
+        }
+        if (++session->txOffset == record->length) {
+            session->actual[session->txRecord] = session->clock.now;
+            session->txRecord = nextRecord(session, session->txRecord + 1, sessionTx);
+            session->txOffset = 0;
+        }
+    }
+    return length;
+}
+
+// -----------------------------------------------------------------------------------
+// Replay wait procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Session, forWrite - Waiting for transmit room, timeout - Longest wait
+// Output: void
+// Returns at once while received bytes are due, otherwise waits on the virtual clock,
+// which lands on the next arrival. Writes never wait.
+// -----------------------------------------------------------------------------------
+static void replayWait(void* ctx, bool forWrite, int timeout) {
+    session_t* session = (session_t*)ctx;
+
+    if (forWrite) return;
+    if (rxReady(session) && (int32_t)(dueTime(session, session->rxRecord) - session->clock.now) <= 0) return;
+    vclockWait(&session->clock, (uint32_t)timeout);
+}
+
+// -----------------------------------------------------------------------------------
+// Arrival time procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Session, now - Virtual time
+// Output: int32_t - ms until the next received record arrives, -1 if it is held back
+// Event source callback of the virtual clock.
+// -----------------------------------------------------------------------------------
+static int32_t replayTimeToEvent(void* ctx, uint32_t now) {
+    session_t* session = (session_t*)ctx;
+
+    if (!rxReady(session)) return -1;
+    int32_t left = (int32_t)(dueTime(session, session->rxRecord) - now);
+    return left > 0 ? left : 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Start replay procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Loaded session
+// Output: void
+// Attaches the session as the serial transport and clock of the library. Virtual
+// time starts at 0 like the recording.
+// -----------------------------------------------------------------------------------
+void sessionReplayStart(session_t* session) {
+    vclockInit(&session->clock);
+    vclockAddSource(&session->clock, replayTimeToEvent, NULL, session); // Arrived bytes wait for the library
+    session->txRecord = nextRecord(session, 0, sessionTx);
+    session->rxRecord = nextRecord(session, 0, sessionRx);
+    session->apiRecord = nextRecord(session, 0, sessionApi);
+    session->txOffset = session->rxOffset = 0;
+    session->apiChecked = 0;
+    session->failed = false;
+    session->error[0] = '\0';
+
+    session->transport.read = replayRead;
+    session->transport.write = replayWrite;
+    session->transport.wait = replayWait;
+    session->transport.ctx = session;
+    vclockInstall(&session->clock);
+    bleSetTransport(&session->transport);
+}
+
+// -----------------------------------------------------------------------------------
+// Stop replay procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session
+// Output: void
+// Returns the library to the real clock and serial port.
+// -----------------------------------------------------------------------------------
+void sessionReplayStop(session_t* session) {
+    bleSetTransport(NULL);
+    vclockUninstall(&session->clock);
+}
+
+// -----------------------------------------------------------------------------------
+// Check API result procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session, name - Library call, value - Result seen in the replay
+// Output: bool - True if it matches the next recorded result
+// Sessions without API records only check the byte stream.
+// -----------------------------------------------------------------------------------
+bool sessionCheckApi(session_t* session, const char* name, const char* value) {
+    char expected[SESSION_RECORD_SIZE + 64];
+    char actual[SESSION_RECORD_SIZE + 64];
+    char message[128];
+
+    if (session->apiCount == 0) return true;
+    if (session->apiRecord >= session->count) {
+        snprintf(message, sizeof(message), "unexpected call %s", name);
+        failReplay(session, message);
+        return false;
+    }
+
+    snprintf(expected, sizeof(expected), "%s", (const char*)session->records[session->apiRecord].data);
+    snprintf(actual, sizeof(actual), "%s %s", name, value);
+    session->apiRecord = nextRecord(session, session->apiRecord + 1, sessionApi);
+    session->apiChecked++;
+    if (strcmp(expected, actual) != 0) {
+        snprintf(message, sizeof(message), "API mismatch: expected \"%.40s\", got \"%.40s\"", expected, actual);
+        failReplay(session, message);
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Replay result procedure
+// -----------------------------------------------------------------------------------
+// Input : session - Session
+// Output: bool - True if the replay matched the whole recording
+// Every recorded transmission and API result must have been reproduced; trailing
+// received bytes the application never read are allowed.
+// -----------------------------------------------------------------------------------
+bool sessionReplayPassed(session_t* session) {
+    if (!session->failed && session->txRecord < session->count) {
+        failReplay(session, "recorded transmissions not reproduced");
+    }
+    if (!session->failed && session->apiRecord < session->count) {
+        failReplay(session, "recorded API calls not reproduced");
+    }
+    return !session->failed;
+}
@@ -0,0 +1,84 @@
+/*
+ * session.h
+ *
+ * Created: 18-10-2026 06:02:09
+ * Author: Subrata
+ * Description: Header file for session recording and replay on the Linux port.
+ *              A session file holds every byte exchanged with the module in both
+ *              directions with its timestamp, plus the API results seen by the
+ *              application. Replay feeds a session back into the library under
+ *              virtual time and checks the API results against the recording.
+ *
+ *              File format, one record per line:
+ *                T <ms> <bytes>        bytes sent to the module
+ *                R <ms> <bytes>        bytes received from the module
+ *                A <ms> <name> <value> result of a library call
+ *              Bytes are printable ASCII with \r, \n, \t, \\ and \xHH escapes;
+ *              lines starting with # are comments.
+ */
+
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "bleSerial.h"
+#include "vclock.h"
+
+// Longest record payload in bytes
+#define SESSION_RECORD_SIZE 256
+
+typedef enum {
+    sessionTx,  // MCU to module
+    sessionRx,  // Module to MCU
+    sessionApi  // Library call result
+} sessionDir_t;
+
+typedef struct {
+    sessionDir_t dir; // Record type
+    uint32_t time;    // ms since the start of the session
+    uint8_t* data;    // Bytes, or "name value" for API records
+    uint16_t length;  // Bytes in data
+} sessionRecord_t;
+
+typedef struct {
+    FILE* file;                            // Destination file
+    uint32_t origin;                       // millis() at the start of the session
+    sessionDir_t pendingDir;               // Direction of the record being merged
+    uint32_t pendingTime;                  // Time of the record being merged
+    uint8_t pending[SESSION_RECORD_SIZE];  // Bytes of the record being merged
+    uint16_t pendingLen;                   // Bytes waiting to be written
+} sessionRecorder_t;
+
+typedef struct {
+    sessionRecord_t* records; // Loaded records in file order
+    uint32_t count;           // Number of records
+    uint32_t apiCount;        // Number of API records
+    uint32_t* actual;         // Replay time each byte record completed or arrived
+    uint32_t txRecord;        // Next transmit record to match
+    uint16_t txOffset;        // Bytes of it already matched
+    uint32_t rxRecord;        // Next receive record to deliver
+    uint16_t rxOffset;        // Bytes of it already delivered
+    uint32_t apiRecord;       // Next API record to compare
+    uint32_t apiChecked;      // API results compared so far
+    bool failed;              // Replay diverged from the recording
+    char error[128];          // Description of the first divergence
+    bleTransport_t transport; // Transport handed to bleSerial
+    vclock_t clock;           // Virtual clock of the replay
+} session_t;
+
+bool sessionRecordOpen(sessionRecorder_t* rec, const char* path);
+void sessionRecordBytes(sessionRecorder_t* rec, bool transmit, const uint8_t* data, uint16_t length, uint32_t time);
+void sessionRecordApi(sessionRecorder_t* rec, const char* name, const char* value);
+void sessionRecordClose(sessionRecorder_t* rec);
+void sessionTap(void* ctx, bool transmit, const uint8_t* data, uint16_t length);
+
+bool sessionLoad(session_t* session, const char* path);
+void sessionFree(session_t* session);
+void sessionReplayStart(session_t* session);
+void sessionReplayStop(session_t* session);
+bool sessionCheckApi(session_t* session, const char* name, const char* value);
+bool sessionReplayPassed(session_t* session);
+
+#endif /* SESSION_H_ */
@@ -0,0 +1,102 @@
+/*
+ * simPort.cpp
+ *
+ * Created: 18-10-2026 06:08:10
+ * Author: Subrata
+ * Description: Implementation of the in-process simulator port. The simulator is
+ *              an event source of the virtual clock, so a pending reboot is where
+ *              an idle wait of the library lands.
+ */
+
+#include "simPort.h"
+
+// -----------------------------------------------------------------------------------
+// Simulator event callbacks for the virtual clock
+// -----------------------------------------------------------------------------------
+static int32_t portTimeToEvent(void* ctx, uint32_t now) {
+    return simTimeToEvent((rn4871Sim_t*)ctx, now);
+}
+
+static void portRun(void* ctx, uint32_t now) {
+    simTask((rn4871Sim_t*)ctx, now);
+}
+
+// -----------------------------------------------------------------------------------
+// Port read procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Port, data - Destination, length - Maximum number of bytes
+// Output: int - Bytes taken from the simulator output
+// -----------------------------------------------------------------------------------
+static int portRead(void* ctx, uint8_t* data, int length) {
+    simPort_t* port = (simPort_t*)ctx;
+
+    simTask(port->sim, port->clock->now);
+    int n = simTransmit(port->sim, data, length);
+    if (n > 0) {
+        vclockActivity(port->clock);
+    }
+    return n;
+}
+
+// -----------------------------------------------------------------------------------
+// Port write procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Port, data - Bytes sent by the library, length - Number of bytes
+// Output: int - Bytes accepted, always all of them
+// -----------------------------------------------------------------------------------
+static int portWrite(void* ctx, const uint8_t* data, int length) {
+    simPort_t* port = (simPort_t*)ctx;
+
+    simTask(port->sim, port->clock->now);
+    for (int i = 0; i < length; i++) {
+        simReceive(port->sim, data[i]);
+    }
+    return length;
+}
+
+// -----------------------------------------------------------------------------------
+// Port wait procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Port, forWrite - Waiting for transmit room, timeout - Longest wait
+// Output: void
+// Returns at once while the simulator has output, otherwise waits on the virtual
+// clock. Writes never wait.
+// -----------------------------------------------------------------------------------
+static void portWait(void* ctx, bool forWrite, int timeout) {
+    simPort_t* port = (simPort_t*)ctx;
+
+    if (forWrite || simPending(port->sim) > 0) return;
+    vclockWait(port->clock, (uint32_t)timeout);
+}
+
+// -----------------------------------------------------------------------------------
+// Attach port procedure
+// -----------------------------------------------------------------------------------
+// Input : port - Port, sim - Initialized simulator, clock - Initialized virtual clock
+// Output: void
+// Makes the simulator the library's module and installs the virtual clock.
+// -----------------------------------------------------------------------------------
+void simPortAttach(simPort_t* port, rn4871Sim_t* sim, vclock_t* clock) {
+    port->sim = sim;
+    port->clock = clock;
+    port->transport.read = portRead;
+    port->transport.write = portWrite;
+    port->transport.wait = portWait;
+    port->transport.ctx = port;
+
+    vclockAddSource(clock, portTimeToEvent, portRun, sim);
+    vclockInstall(clock);
+    bleSetTransport(&port->transport);
+}
+
+// -----------------------------------------------------------------------------------
+// Detach port procedure
+// -----------------------------------------------------------------------------------
+// Input : port - Port
+// Output: void
+// Returns the library to the real serial port and clock.
+// -----------------------------------------------------------------------------------
+void simPortDetach(simPort_t* port) {
+    bleSetTransport(NULL);
+    vclockUninstall(port->clock);
+}
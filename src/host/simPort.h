@@ -0,0 +1,28 @@
+/*
+ * simPort.h
+ *
+ * Created: 18-10-2026 06:07:33
+ * Author: Subrata
+ * Description: Header file for the in-process simulator port of the Linux port.
+ *              Connects the library directly to an RN4871 simulator on a virtual
+ *              clock, without a pseudo-terminal, so complete sessions including
+ *              reboots and timeouts run in microseconds of wall time.
+ */
+
+#ifndef SIMPORT_H_
+#define SIMPORT_H_
+
+#include "bleSerial.h"
+#include "rn4871Sim.h"
+#include "vclock.h"
+
+typedef struct {
+    rn4871Sim_t* sim;         // Simulated module
+    vclock_t* clock;          // Virtual clock shared with the library
+    bleTransport_t transport; // Transport handed to bleSerial
+} simPort_t;
+
+void simPortAttach(simPort_t* port, rn4871Sim_t* sim, vclock_t* clock);
+void simPortDetach(simPort_t* port);
+
+#endif /* SIMPORT_H_ */
@@ -0,0 +1,228 @@
+/*
+ * traceLog.cpp
+ *
+ * Created: 18-10-2026 06:25:59
+ * Author: Subrata
+ * Description: Implementation of the binary trace log for the Linux port. Segments
+ *              are preallocated and mapped once; records are copied straight into
+ *              the mapping and the header is updated after each record, so the
+ *              page cache holds a readable log even if the process dies. A single
+ *              thread, normally the gateway's, must do all writing.
+ */
+
+#include "traceLog.h"
+#include "wiring.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(traceSegmentHeader_t) == 64, "segment header layout");
+static_assert(sizeof(traceRecord_t) == 12, "record header layout");
+static_assert(sizeof(traceIndex_t) == 16, "index entry layout");
+
+// -----------------------------------------------------------------------------------
+// Wall clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint64_t - Milliseconds since the Unix epoch
+// -----------------------------------------------------------------------------------
+static uint64_t unixMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000L);
+}
+
+// -----------------------------------------------------------------------------------
+// Close segment procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log
+// Output: void
+// Marks the open segment complete and unmaps it. The kernel writes it back.
+// -----------------------------------------------------------------------------------
+static void closeSegment(traceLog_t* log) {
+    if (log->base == NULL) return;
+
+    log->header->closed = 1;
+    munmap(log->base, log->segmentSize);
+    log->base = NULL;
+    log->header = NULL;
+    log->block = NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Open segment procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log, number - Segment number
+// Output: bool - True if the segment is mapped and ready
+// Creates and preallocates a new segment file, so writes into the mapping can never
+// fault on a full disk, and populates the mapping so page faults are taken here
+// rather than on the gateway's hot path.
+// -----------------------------------------------------------------------------------
+static bool openSegment(traceLog_t* log, uint32_t number) {
+    char path[TRACE_PATH_SIZE + 32];
+
+    snprintf(path, sizeof(path), TRACE_FILE_FORMAT, log->dir, number);
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    if (posix_fallocate(fd, 0, log->segmentSize) != 0) {
+        close(fd);
+        unlink(path);
+        return false;
+    }
+    void* base = mmap(NULL, log->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd); // The mapping keeps the file
+    if (base == MAP_FAILED) {
+        unlink(path);
+        return false;
+    }
+
+    log->base = (uint8_t*)base;
+    log->header = (traceSegmentHeader_t*)base;
+    log->block = NULL;
+    log->segment = number;
+    memset(log->header, 0, sizeof(*log->header));
+    memcpy(log->header->magic, TRACE_MAGIC, sizeof(log->header->magic));
+    log->header->version = TRACE_VERSION;
+    log->header->segment = number;
+    log->header->startUnixMs = unixMillis();
+    log->header->startMillis = (uint32_t)millis();
+    log->header->size = log->segmentSize;
+    log->header->recordEnd = sizeof(traceSegmentHeader_t);
+    madvise(base, log->segmentSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Next segment number procedure
+// -----------------------------------------------------------------------------------
+// Input : dir - Trace directory
+// Output: uint32_t - One past the highest segment number found, 0 if none
+// Lets a restarted writer continue the sequence instead of overwriting.
+// -----------------------------------------------------------------------------------
+static uint32_t nextSegmentNumber(const char* dir) {
+    DIR* d = opendir(dir);
+    uint32_t next = 0;
+    struct dirent* entry;
+
+    if (d == NULL) return 0;
+    while ((entry = readdir(d)) != NULL) {
+        unsigned number;
+        char suffix[8];
+        if (sscanf(entry->d_name, "trace-%u.%7s", &number, suffix) == 2 &&
+            strcmp(suffix, "rnt") == 0 && number + 1 > next) {
+            next = number + 1;
+        }
+    }
+    closedir(d);
+    return next;
+}
+
+// -----------------------------------------------------------------------------------
+// Trace log open procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log, dir - Directory for the segments, created if missing,
+//         segmentSize - Segment file size, 0 for TRACE_SEGMENT_SIZE
+// Output: bool - True if the first segment was created, false otherwise
+// -----------------------------------------------------------------------------------
+bool traceLogOpen(traceLog_t* log, const char* dir, uint32_t segmentSize) {
+    memset(log, 0, sizeof(*log));
+    if (segmentSize == 0) segmentSize = TRACE_SEGMENT_SIZE;
+    if (segmentSize < TRACE_SEGMENT_MIN || strlen(dir) >= sizeof(log->dir)) return false;
+
+    snprintf(log->dir, sizeof(log->dir), "%s", dir);
+    log->segmentSize = segmentSize & ~(uint32_t)(TRACE_INDEX_STRIDE - 1); // Whole pages
+    mkdir(dir, 0755);
+    return openSegment(log, nextSegmentNumber(dir));
+}
+
+// -----------------------------------------------------------------------------------
+// Trace log close procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log
+// Output: void
+// -----------------------------------------------------------------------------------
+void traceLogClose(traceLog_t* log) {
+    closeSegment(log);
+}
+
+// -----------------------------------------------------------------------------------
+// Trace log write procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log, type - traceType_t, module - Module id, flags - Type
+//         specific, data - Payload, length - Payload bytes
+// Output: bool - True if the record was stored
+// Appends one record, opening an index block every TRACE_INDEX_STRIDE bytes and
+// moving to a new segment when records would run into the index.
+// -----------------------------------------------------------------------------------
+bool traceLogWrite(traceLog_t* log, uint8_t type, uint16_t module, uint8_t flags,
+                   const void* data, uint16_t length) {
+    uint32_t size = (sizeof(traceRecord_t) + length + 3) & ~3U;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (log->base == NULL && !openSegment(log, log->segment + 1)) break;
+
+        traceSegmentHeader_t* header = log->header;
+        uint32_t offset = header->recordEnd;
+        bool newBlock = log->block == NULL || offset - log->block->offset >= TRACE_INDEX_STRIDE;
+        uint32_t indexBytes = (header->indexCount + (newBlock ? 1 : 0)) * sizeof(traceIndex_t);
+
+        if (offset + size + indexBytes > header->size) {
+            if (header->recordCount == 0) break; // Record larger than a segment
+            closeSegment(log);
+            continue;
+        }
+
+        uint32_t now = (uint32_t)millis() - header->startMillis;
+        traceRecord_t* record = (traceRecord_t*)(log->base + offset);
+        record->time = now;
+        record->module = module;
+        record->type = type;
+        record->flags = flags;
+        record->length = length;
+        record->reserved = 0;
+        if (length > 0) memcpy(record + 1, data, length);
+
+        if (newBlock) {
+            log->block = (traceIndex_t*)(log->base + header->size) - (header->indexCount + 1);
+            log->block->time = now;
+            log->block->offset = offset;
+            log->block->modules = 0;
+            header->indexCount++;
+        }
+        if (module < 64) log->block->modules |= 1ULL << module;
+
+        if (header->recordCount == 0) header->firstTime = now;
+        header->lastTime = now;
+        header->recordCount++;
+        __atomic_store_n(&header->recordEnd, offset + size, __ATOMIC_RELEASE); // Publish the record last
+        log->records++;
+        log->bytes += size;
+        return true;
+    }
+    log->dropped++;
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Trace command procedure
+// -----------------------------------------------------------------------------------
+// Input : log - Trace log, module - Module id, status - cmdStatus_t, latency - Round
+//         trip in ms, command - Command text
+// Output: bool - True if the record was stored
+// Payload: 32-bit latency followed by the command text without terminator.
+// -----------------------------------------------------------------------------------
+bool traceLogCommand(traceLog_t* log, uint16_t module, uint8_t status, uint32_t latency, const char* command) {
+    uint8_t payload[sizeof(uint32_t) + 128];
+    size_t length = strlen(command);
+
+    if (length > sizeof(payload) - sizeof(uint32_t)) length = sizeof(payload) - sizeof(uint32_t);
+    memcpy(payload, &latency, sizeof(latency));
+    memcpy(payload + sizeof(latency), command, length);
+    return traceLogWrite(log, traceCommand, module, status, payload, (uint16_t)(sizeof(latency) + length));
+}
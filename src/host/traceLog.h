@@ -0,0 +1,108 @@
+/*
+ * traceLog.h
+ *
+ * Created: 18-10-2026 06:24:55
+ * Author: Subrata
+ * Description: Header file for the binary trace log of the Linux port. Module traffic,
+ *              events, command round trips, connection changes and statistics are
+ *              appended to fixed-size segment files through a shared memory mapping,
+ *              so logging costs a copy per record and no system call except when a
+ *              segment is rolled. Each segment carries a sparse index at its tail
+ *              that lets a reader seek by time and skip blocks without a module.
+ *
+ *              Segment layout: traceSegmentHeader_t, records growing upward, index
+ *              entries growing downward from the end of the file. Records start on
+ *              4-byte boundaries; all fields are little-endian host order.
+ */
+
+#ifndef TRACELOG_H_
+#define TRACELOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// File identification of a segment
+#define TRACE_MAGIC          "RN4871TR"
+#define TRACE_VERSION        1
+// Default segment file size
+#define TRACE_SEGMENT_SIZE   (16UL * 1024UL * 1024UL)
+// Smallest accepted segment file size
+#define TRACE_SEGMENT_MIN    (64UL * 1024UL)
+// Record bytes covered by one index entry
+#define TRACE_INDEX_STRIDE   4096
+// Maximum directory path length including the terminator
+#define TRACE_PATH_SIZE      256
+// Segment file name pattern, formatted with the directory and the segment number
+#define TRACE_FILE_FORMAT    "%s/trace-%06u.rnt"
+
+typedef enum {
+    traceRx = 1,     // Bytes received from the module
+    traceTx,         // Bytes written to the module
+    traceEvent,      // Event text without % delimiters
+    traceCommand,    // Completed command: flags = cmdStatus_t, payload = latency + command text
+    traceConnection, // Connection change: flags = 1 connected, 0 disconnected
+    traceStats       // Module statistics snapshot, payload = traceStats_t
+} traceType_t;
+
+typedef struct {
+    char magic[8];         // TRACE_MAGIC without terminator
+    uint32_t version;      // TRACE_VERSION
+    uint32_t segment;      // Segment number, increasing across files
+    uint64_t startUnixMs;  // Wall clock at segment creation
+    uint32_t startMillis;  // millis() at segment creation, origin of record times
+    uint32_t size;         // Segment file size
+    uint32_t recordEnd;    // Offset past the last complete record
+    uint32_t recordCount;  // Records in the segment
+    uint32_t indexCount;   // Index entries at the end of the segment
+    uint32_t firstTime;    // Time of the first record
+    uint32_t lastTime;     // Time of the last record
+    uint32_t closed;       // 1 once the writer moved on, 0 while live or after a crash
+    uint8_t reserved[8];   // Pads the header to 64 bytes
+} traceSegmentHeader_t;
+
+typedef struct {
+    uint32_t time;         // ms since the segment's startMillis
+    uint16_t module;       // Module id
+    uint8_t type;          // traceType_t
+    uint8_t flags;         // Type specific
+    uint16_t length;       // Payload bytes following the record header
+    uint16_t reserved;     // Zero
+} traceRecord_t;
+
+typedef struct {
+    uint32_t time;         // Time of the first record of the block
+    uint32_t offset;       // Offset of the first record of the block
+    uint64_t modules;      // Bit n set if module n has a record in the block
+} traceIndex_t;
+
+typedef struct {
+    uint32_t commands;     // Commands completed
+    uint32_t errors;       // Commands completed with another response
+    uint32_t timeouts;     // Commands without response
+    uint32_t events;       // Events received
+    uint32_t latencyTotal; // Sum of command round trips in ms
+    uint32_t latencyMax;   // Longest command round trip in ms
+    uint32_t rxBytes;      // Bytes received
+    uint32_t txBytes;      // Bytes written to the port
+    uint32_t txDropped;    // Bytes dropped on transmit buffer overflow
+} traceStats_t;
+
+typedef struct traceLog {
+    char dir[TRACE_PATH_SIZE];     // Directory holding the segments
+    uint32_t segmentSize;          // Size of each segment file
+    uint32_t segment;              // Number of the open segment
+    uint8_t* base;                 // Mapping of the open segment, NULL if none
+    traceSegmentHeader_t* header;  // Header of the open segment
+    traceIndex_t* block;           // Index entry of the current block
+    uint32_t records;              // Records written
+    uint32_t dropped;              // Records lost because no segment could be created
+    uint64_t bytes;                // Record bytes written
+} traceLog_t;
+
+bool traceLogOpen(traceLog_t* log, const char* dir, uint32_t segmentSize);
+void traceLogClose(traceLog_t* log);
+bool traceLogWrite(traceLog_t* log, uint8_t type, uint16_t module, uint8_t flags,
+                   const void* data, uint16_t length);
+bool traceLogCommand(traceLog_t* log, uint16_t module, uint8_t status, uint32_t latency, const char* command);
+
+#endif /* TRACELOG_H_ */
@@ -0,0 +1,181 @@
+/*
+ * vclock.cpp
+ *
+ * Created: 18-10-2026 06:06:50
+ * Author: Subrata
+ * Description: Implementation of the discrete virtual clock of the Linux port.
+ *              Time only moves when the library delays or waits, and then in one
+ *              step to the next point where something can happen.
+ */
+
+#include "vclock.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------------
+// Next event procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock, at - Receives the time of the earliest event
+// Output: bool - True if any source has an event scheduled
+// -----------------------------------------------------------------------------------
+static bool nextEvent(const vclock_t* vc, uint32_t* at) {
+    bool found = false;
+
+    for (uint8_t i = 0; i < vc->sourceCount; i++) {
+        int32_t left = vc->sources[i].timeToEvent(vc->sources[i].ctx, vc->now);
+        if (left >= 0 && (!found || (uint32_t)left < *at - vc->now)) {
+            *at = vc->now + (uint32_t)left;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// -----------------------------------------------------------------------------------
+// Run due events procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock
+// Output: void
+// -----------------------------------------------------------------------------------
+static void runDue(vclock_t* vc) {
+    for (uint8_t i = 0; i < vc->sourceCount; i++) {
+        if (vc->sources[i].run != NULL && vc->sources[i].timeToEvent(vc->sources[i].ctx, vc->now) == 0) {
+            vc->sources[i].run(vc->sources[i].ctx, vc->now);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Clock callbacks for wiring
+// -----------------------------------------------------------------------------------
+static unsigned long vclockMillis(void* ctx) {
+    return ((vclock_t*)ctx)->now;
+}
+
+static void vclockDelay(void* ctx, unsigned long ms) {
+    vclockAdvance((vclock_t*)ctx, (uint32_t)ms);
+}
+
+static void vclockDeadline(void* ctx, unsigned long at) {
+    vclock_t* vc = (vclock_t*)ctx;
+    uint32_t left = (uint32_t)at - vc->now;
+
+    if (!vc->deadlineSet || left < vc->deadline - vc->now) {
+        vc->deadline = (uint32_t)at;
+        vc->deadlineSet = true;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Virtual clock initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock
+// Output: void
+// Starts virtual time at 0 with no event sources.
+// -----------------------------------------------------------------------------------
+void vclockInit(vclock_t* vc) {
+    memset(vc, 0, sizeof(*vc));
+    vc->clock.millis = vclockMillis;
+    vc->clock.delay = vclockDelay;
+    vc->clock.deadline = vclockDeadline;
+    vc->clock.ctx = vc;
+}
+
+// -----------------------------------------------------------------------------------
+// Add event source procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock, timeToEvent - Time to the source's next event,
+//         run - Event handler, NULL if the source only paces time, ctx - Source context
+// Output: bool - True if added, false if the source table is full
+// -----------------------------------------------------------------------------------
+bool vclockAddSource(vclock_t* vc, int32_t (*timeToEvent)(void*, uint32_t), void (*run)(void*, uint32_t), void* ctx) {
+    if (vc->sourceCount >= VCLOCK_MAX_SOURCES) return false;
+
+    vclockSource_t* source = &vc->sources[vc->sourceCount++];
+    source->timeToEvent = timeToEvent;
+    source->run = run;
+    source->ctx = ctx;
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Install procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock
+// Output: void
+// Makes millis, delay, powerDown and timeoutExpired use the virtual clock.
+// -----------------------------------------------------------------------------------
+void vclockInstall(vclock_t* vc) {
+    wiringSetClock(&vc->clock);
+}
+
+// -----------------------------------------------------------------------------------
+// Uninstall procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock
+// Output: void
+// Returns wiring to the monotonic clock.
+// -----------------------------------------------------------------------------------
+void vclockUninstall(vclock_t* vc) {
+    (void)vc; // Kept for symmetry with vclockInstall
+    wiringSetClock(NULL);
+}
+
+// -----------------------------------------------------------------------------------
+// Advance procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock, ms - Time to pass
+// Output: void
+// Lets time pass like a delay, running every event that falls inside it in order.
+// -----------------------------------------------------------------------------------
+void vclockAdvance(vclock_t* vc, uint32_t ms) {
+    uint32_t target = vc->now + ms;
+    uint32_t at;
+
+    runDue(vc);
+    while (nextEvent(vc, &at) && (int32_t)(target - at) >= 0 && at != vc->now) {
+        vc->now = at;
+        runDue(vc);
+    }
+    vc->now = target;
+    runDue(vc);
+}
+
+// -----------------------------------------------------------------------------------
+// Activity procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock
+// Output: void
+// Called by transports when bytes are delivered: the loop that reported a deadline
+// has made progress and may be finished, so the deadline is forgotten.
+// -----------------------------------------------------------------------------------
+void vclockActivity(vclock_t* vc) {
+    vc->deadlineSet = false;
+}
+
+// -----------------------------------------------------------------------------------
+// Idle wait procedure
+// -----------------------------------------------------------------------------------
+// Input : vc - Virtual clock, timeout - Longest wait the caller asked for
+// Output: void
+// Called when the library has nothing to read. Jumps to the next event or, when a
+// polling loop reported its deadline, to whichever comes first; the caller's own
+// short timeout only applies when neither is known.
+// -----------------------------------------------------------------------------------
+void vclockWait(vclock_t* vc, uint32_t timeout) {
+    uint32_t target = vc->now + timeout;
+    uint32_t at;
+
+    if (vc->deadlineSet && (int32_t)(vc->deadline - vc->now) > 0) {
+        target = vc->deadline;
+    }
+    if (nextEvent(vc, &at) && (int32_t)(at - target) < 0) {
+        target = at;
+    }
+    vc->deadlineSet = false;
+
+    if (target != vc->now) {
+        vc->jumps++;
+        vc->skipped += target - vc->now;
+    }
+    vclockAdvance(vc, target - vc->now);
+}
@@ -0,0 +1,48 @@
+/*
+ * vclock.h
+ *
+ * Created: 18-10-2026 06:06:07
+ * Author: Subrata
+ * Description: Header file for the discrete virtual clock of the Linux port.
+ *              Installed in place of the monotonic clock, it never sleeps: delays
+ *              and idle waits jump straight to the next scheduled event or to the
+ *              deadline of the loop that is waiting, so simulated sessions run
+ *              far faster than real time.
+ */
+
+#ifndef VCLOCK_H_
+#define VCLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiring.h"
+
+// Maximum number of event sources per clock
+#define VCLOCK_MAX_SOURCES 8
+
+typedef struct {
+    int32_t (*timeToEvent)(void* ctx, uint32_t now); // ms until the next event, -1 if none
+    void (*run)(void* ctx, uint32_t now);            // Handles events due at now, may be NULL
+    void* ctx;                                       // Source context
+} vclockSource_t;
+
+typedef struct {
+    uint32_t now;                                 // Virtual time in ms
+    vclockSource_t sources[VCLOCK_MAX_SOURCES];   // Event sources, e.g. simulators
+    uint8_t sourceCount;                          // Sources in use
+    bool deadlineSet;                             // A polling loop reported its deadline
+    uint32_t deadline;                            // Nearest reported deadline
+    uint32_t jumps;                               // Idle waits that skipped time
+    uint32_t skipped;                             // Total virtual time skipped in ms
+    wiringClock_t clock;                          // Clock handed to wiring
+} vclock_t;
+
+void vclockInit(vclock_t* vc);
+bool vclockAddSource(vclock_t* vc, int32_t (*timeToEvent)(void*, uint32_t), void (*run)(void*, uint32_t), void* ctx);
+void vclockInstall(vclock_t* vc);
+void vclockUninstall(vclock_t* vc);
+void vclockAdvance(vclock_t* vc, uint32_t ms);
+void vclockActivity(vclock_t* vc);
+void vclockWait(vclock_t* vc, uint32_t timeout);
+
+#endif /* VCLOCK_H_ */
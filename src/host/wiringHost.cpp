@@ -0,0 +1,169 @@
+/*
+ * wiringHost.cpp
+ *
+ * Created: 18-10-2026 05:49:06
+ * Author: Subrata
+ * Description: Linux port of the timing functions for the RN4871 BLE library,
+ *              providing millisecond timing from the monotonic clock.
+ */
+
+#include "wiring.h"
+#include "cpuLoad.h"
+#include "energyModel.h"
+#include <time.h>
+
+static struct timespec clockOrigin;
+static bool clockStarted = false;
+static const wiringClock_t* injected = NULL;
+static uint16_t analogValues[8]; // Conversion results returned by analogRead
+
+// -----------------------------------------------------------------------------------
+// Set clock procedure
+// -----------------------------------------------------------------------------------
+// Input : clock - Replacement clock, NULL to return to the monotonic clock
+// Output: void
+// Routes millis, delay and powerDown through another time source, e.g. the virtual
+// time of a session replay.
+// -----------------------------------------------------------------------------------
+void wiringSetClock(const wiringClock_t* clock) {
+    injected = clock;
+}
+
+// -----------------------------------------------------------------------------------
+// Monotonic milliseconds procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: unsigned long - Milliseconds of the monotonic clock
+// Reads CLOCK_MONOTONIC, which is unaffected by wall clock adjustments.
+// -----------------------------------------------------------------------------------
+static unsigned long monotonicMillis(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000UL + (unsigned long)(now.tv_nsec / 1000000L);
+}
+
+// -----------------------------------------------------------------------------------
+// Get millisecond count procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: unsigned long - Milliseconds since initMillis or the first call
+// Returns the elapsed time of the monotonic clock, wrapping like the AVR counter.
+// -----------------------------------------------------------------------------------
+unsigned long millis(void) {
+    if (injected != NULL) {
+        return injected->millis(injected->ctx);
+    }
+    if (!clockStarted) {
+        initMillis();
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ns = (int64_t)(now.tv_sec - clockOrigin.tv_sec) * 1000000000LL +
+                 (now.tv_nsec - clockOrigin.tv_nsec);
+    return (unsigned long)(uint32_t)(ns / 1000000LL);
+}
+
+// -----------------------------------------------------------------------------------
+// Initialize clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Sets the origin of the millisecond count to the current monotonic time.
+// -----------------------------------------------------------------------------------
+void initMillis(void) {
+    clock_gettime(CLOCK_MONOTONIC, &clockOrigin);
+    clockStarted = true;
+}
+
+// -----------------------------------------------------------------------------------
+// Sleep procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time to wait in milliseconds
+// Output: void
+// Sleeps until the monotonic clock has advanced by the given time.
+// -----------------------------------------------------------------------------------
+static void sleepFor(unsigned long ms) {
+    if (injected != NULL) {
+        injected->delay(injected->ctx, ms);
+        return;
+    }
+    unsigned long start = monotonicMillis();
+    struct timespec request = { (time_t)(ms / 1000UL), (long)(ms % 1000UL) * 1000000L };
+
+    while (nanosleep(&request, &request) != 0 && monotonicMillis() - start < ms); // Resume after signals
+}
+
+// -----------------------------------------------------------------------------------
+// Delay procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time to wait in milliseconds
+// Output: void
+// Stands for the AVR busy-wait delay.
+// -----------------------------------------------------------------------------------
+void delay(unsigned long ms) {
+    CPU_WAIT_SCOPE();
+    sleepFor(ms);
+}
+
+// -----------------------------------------------------------------------------------
+// Timeout check procedure
+// -----------------------------------------------------------------------------------
+// Input : start - millis() at the start of the wait, timeout - Allowed time in ms
+// Output: bool - True once the timeout has elapsed
+// Deadline test used by all polling loops of the library. A pending deadline is
+// reported to an injected clock, so a virtual clock can skip straight to it.
+// -----------------------------------------------------------------------------------
+bool timeoutExpired(unsigned long start, unsigned long timeout) {
+    if (millis() - start >= timeout) return true;
+
+    if (injected != NULL && injected->deadline != NULL) {
+        injected->deadline(injected->ctx, start + timeout);
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Free SRAM procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint16_t - Always 0, a host process has no fixed SRAM to measure
+// -----------------------------------------------------------------------------------
+uint16_t freeSram(void) {
+    return 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Set analog value procedure
+// -----------------------------------------------------------------------------------
+// Input : channel - ADC channel 0 to 7, value - Result analogRead returns for it
+// Output: void
+// Stands in for the signal at an analog input of the AVR.
+// -----------------------------------------------------------------------------------
+void wiringSetAnalog(uint8_t channel, uint16_t value) {
+    if (channel < sizeof(analogValues) / sizeof(analogValues[0])) {
+        analogValues[channel] = value & 0x3FF; // 10-bit converter
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Analog read procedure
+// -----------------------------------------------------------------------------------
+// Input : channel - ADC channel 0 to 7
+// Output: uint16_t - Value set with wiringSetAnalog, 0 for an invalid channel
+// -----------------------------------------------------------------------------------
+uint16_t analogRead(uint8_t channel) {
+    return channel < sizeof(analogValues) / sizeof(analogValues[0]) ? analogValues[channel] : 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Power-down sleep procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time to sleep in milliseconds
+// Output: void
+// Host equivalent of the AVR power-down: the process simply sleeps.
+// -----------------------------------------------------------------------------------
+void powerDown(unsigned long ms) {
+    CPU_SLEEP_SCOPE();
+    sleepFor(ms);
+    ENERGY_SLEEP(ms);
+}
@@ -0,0 +1,172 @@
+/*
+ * lsParser.cpp
+ *
+ * Created: 18-10-2026 06:13:10
+ * Author: Subrata
+ * Description: Implementation of the streaming LS listing parser. Characteristic
+ *              lines have the form "  UUID,HHHH,PP": the UUID is compared with
+ *              the target as it arrives and the handle and property are decoded
+ *              digit by digit, so every character is looked at exactly once.
+ */
+
+#include "lsParser.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------------
+// Hex digit procedure
+// -----------------------------------------------------------------------------------
+// Input : c - Character
+// Output: int8_t - Value of the hex digit, -1 if c is not one
+// -----------------------------------------------------------------------------------
+static int8_t hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// -----------------------------------------------------------------------------------
+// Upper case procedure
+// -----------------------------------------------------------------------------------
+// Input : c - Character
+// Output: char - c converted to upper case
+// -----------------------------------------------------------------------------------
+static char upper(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// -----------------------------------------------------------------------------------
+// Start line procedure
+// -----------------------------------------------------------------------------------
+// Input : parser - LS parser
+// Output: void
+// -----------------------------------------------------------------------------------
+static void startLine(lsParser_t* parser) {
+    parser->field = 0;
+    parser->digits = 0;
+    parser->leading = true;
+    parser->uuidMatch = true;
+    parser->hexValid = true;
+    parser->endMatch = true;
+    parser->handle = 0;
+    parser->property = 0;
+}
+
+// -----------------------------------------------------------------------------------
+// End line procedure
+// -----------------------------------------------------------------------------------
+// Input : parser - LS parser
+// Output: void
+// Records the line's handle if it is a complete characteristic line for the target.
+// -----------------------------------------------------------------------------------
+static void endLine(lsParser_t* parser) {
+    if (parser->field == 2 && parser->digits < 2) {
+        parser->hexValid = false; // Property cut short
+    }
+    if (parser->field >= 2 && parser->uuidMatch && parser->hexValid &&
+        parser->property == parser->targetProperty) {
+        parser->found = parser->handle;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Parser initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : parser - LS parser, targetUuid - Characteristic UUID to find,
+//         targetProperty - Property bitmap to find
+// Output: void
+// The UUID is compared case-insensitively and must match the whole first field.
+// -----------------------------------------------------------------------------------
+void lsParserInit(lsParser_t* parser, const char* targetUuid, uint8_t targetProperty) {
+    parser->target = targetUuid;
+    parser->targetLen = strlen(targetUuid);
+    parser->targetProperty = targetProperty;
+    parser->lines = 0;
+    parser->found = 0;
+    startLine(parser);
+}
+
+// -----------------------------------------------------------------------------------
+// Parser feed procedure
+// -----------------------------------------------------------------------------------
+// Input : parser - LS parser, c - Next character of the listing
+// Output: bool - True once the END line is complete
+// -----------------------------------------------------------------------------------
+bool lsParserFeed(lsParser_t* parser, char c) {
+    if (c == '\r') {
+        return false; // Lines end with CR LF, the LF alone is enough
+    }
+    if (c == '\n') {
+        bool end = parser->endMatch && !parser->leading && parser->digits == 3 && parser->field == 0;
+        if (!parser->leading) {
+            endLine(parser);
+            parser->lines++;
+        }
+        startLine(parser);
+        return end;
+    }
+    if (parser->leading) {
+        if (c == ' ' || c == '\t') {
+            return false; // Indentation of characteristic lines
+        }
+        parser->leading = false;
+    }
+
+    if (c == ',') {
+        if (parser->field == 0) {
+            parser->uuidMatch = parser->uuidMatch && parser->digits == parser->targetLen;
+        } else if (parser->digits < (parser->field == 1 ? 4 : 2)) {
+            parser->hexValid = false; // Handle or property cut short
+        }
+        parser->endMatch = false;
+        if (parser->field < 3) parser->field++;
+        parser->digits = 0;
+        return false;
+    }
+
+    switch (parser->field) {
+        case 0:
+            if (parser->digits < 3) {
+                parser->endMatch = parser->endMatch && c == "END"[parser->digits];
+            } else {
+                parser->endMatch = false;
+            }
+            if (parser->digits >= parser->targetLen || upper(c) != upper(parser->target[parser->digits])) {
+                parser->uuidMatch = false;
+            }
+            break;
+        case 1:
+            if (parser->digits < 4) { // Handle is the first 4 digits
+                int8_t v = hexValue(c);
+                if (v < 0) parser->hexValid = false;
+                parser->handle = (parser->handle << 4) | (uint8_t)v;
+            }
+            break;
+        case 2:
+            if (parser->digits < 2) { // Property is the first 2 digits
+                int8_t v = hexValue(c);
+                if (v < 0) parser->hexValid = false;
+                parser->property = (parser->property << 4) | (uint8_t)v;
+            }
+            break;
+        default:
+            break; // Further fields are ignored
+    }
+    if (parser->digits < 0xFF) parser->digits++;
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Parser finish procedure
+// -----------------------------------------------------------------------------------
+// Input : parser - LS parser
+// Output: void
+// Evaluates a last line that was cut off before its line feed.
+// -----------------------------------------------------------------------------------
+void lsParserFinish(lsParser_t* parser) {
+    if (!parser->leading) {
+        endLine(parser);
+        parser->lines++;
+    }
+    startLine(parser);
+}
@@ -0,0 +1,38 @@
+/*
+ * lsParser.h
+ *
+ * Created: 18-10-2026 06:12:17
+ * Author: Subrata
+ * Description: Header file for the streaming parser of the RN4871 LS listing.
+ *              Consumes the listing one character at a time in a single pass
+ *              with a fixed-size state, so listings of any length and lines of
+ *              any length are handled without a line buffer.
+ */
+
+#ifndef LSPARSER_H_
+#define LSPARSER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    const char* target;     // Characteristic UUID to find
+    uint8_t targetLen;      // Length of the UUID
+    uint8_t targetProperty; // Property bitmap to find
+    uint8_t field;          // Comma separated field of the current line
+    uint8_t digits;         // Characters seen in the current field
+    bool leading;           // Still skipping the indentation of the line
+    bool uuidMatch;         // Field 0 matches the target so far
+    bool hexValid;          // Handle and property digits are all hex so far
+    bool endMatch;          // Line matches "END" so far
+    uint16_t handle;        // Handle of the current line
+    uint8_t property;       // Property of the current line
+    uint16_t lines;         // Lines completed
+    uint16_t found;         // Handle of the last matching line, 0 if none
+} lsParser_t;
+
+void lsParserInit(lsParser_t* parser, const char* targetUuid, uint8_t targetProperty);
+bool lsParserFeed(lsParser_t* parser, char c);
+void lsParserFinish(lsParser_t* parser);
+
+#endif /* LSPARSER_H_ */
@@ -0,0 +1,148 @@
+/*
+ * memInfo.cpp
+ *
+ * Created: 18-10-2026 07:04:17
+ * Author: Subrata
+ * Description: Implementation of SRAM instrumentation for the RN4871 BLE library.
+ *              The paint runs from .init3, after the stack pointer is set and
+ *              before the data and bss sections are initialised, and covers
+ *              everything from the end of bss to the stack pointer. On the Linux
+ *              port the stack figures are 0 and only the buffer table is
+ *              meaningful; the host UART never overruns its ring.
+ */
+
+#include "memInfo.h"
+
+static_assert(MEM_BUFFER_TOTAL <= MEM_BUFFER_BUDGET, "library buffers exceed MEM_BUFFER_BUDGET");
+static_assert(BLE_BUFFER_SIZE <= 128, "ring indices and high-water marks are 8 bit");
+static_assert(MAX_DEVICE_NAME_LEN > 20, "device name buffer shorter than the module's name limit");
+#if defined(__AVR__)
+static_assert(MEM_BUFFER_BUDGET + MEM_STACK_MARGIN <= MEM_SRAM_SIZE, "buffer budget and stack margin exceed the SRAM");
+#endif
+
+const memBuffer_t memBuffers[] = {
+    { "bleRx",         BLE_BUFFER_SIZE },
+    { "bleTx",         BLE_BUFFER_SIZE },
+    { "uartBuffer",    DEFAULT_INPUT_BUFFER_SIZE },
+    { "deviceName",    MAX_DEVICE_NAME_LEN },
+    { "eventLine",     EVENT_LINE_SIZE },
+    { "commandStats",  sizeof(commandStats_t) },
+    { "advController", sizeof(advController_t) },
+    { "beacon",        sizeof(beacon_t) },
+    { "diagService",   sizeof(diagService_t) },
+    { "tputService",   sizeof(tputService_t) },
+    { "sensorBridge",  sizeof(sensorBridge_t) }
+};
+const uint8_t memBufferCount = sizeof(memBuffers) / sizeof(memBuffers[0]);
+
+#if defined(__AVR__)
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+extern uint8_t* __brkval;
+
+void memPaint(void) __attribute__((naked, used, section(".init3")));
+
+// -----------------------------------------------------------------------------------
+// Paint free SRAM procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Runs before main() from .init3; naked, so nothing is pushed onto the stack that
+// is being painted.
+// -----------------------------------------------------------------------------------
+void memPaint(void) {
+    uint8_t* p = &__heap_start;
+
+    while (p <= (uint8_t*)SP) {
+        *p++ = MEM_PAINT_BYTE;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Heap top procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint8_t* - First byte above the heap
+// -----------------------------------------------------------------------------------
+static uint8_t* heapTop(void) {
+    return __brkval != 0 ? __brkval : &__heap_start;
+}
+#endif
+
+// -----------------------------------------------------------------------------------
+// Stack unused procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint16_t - Bytes above the heap that still hold the paint pattern
+// Scans upwards from the heap until the first byte the stack has overwritten. A
+// value near 0 means the stack has reached the heap or the statics at some point.
+// -----------------------------------------------------------------------------------
+uint16_t memStackUnused(void) {
+#if defined(__AVR__)
+    const uint8_t* p = heapTop();
+    const uint8_t* sp = (const uint8_t*)SP;
+
+    while (p <= sp && *p == MEM_PAINT_BYTE) {
+        p++;
+    }
+    return (uint16_t)(p - heapTop());
+#else
+    return 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------------
+// Memory report procedure
+// -----------------------------------------------------------------------------------
+// Input : report - Destination
+// Output: void
+// Fills the report with the section sizes, stack figures, ring statistics and line
+// buffer overflows.
+// -----------------------------------------------------------------------------------
+void memInfoGet(memReport_t* report) {
+#if defined(__AVR__)
+    uint16_t unused = memStackUnused();
+
+    report->staticSize = (uint16_t)(&__heap_start - &__data_start);
+    report->heapSize = (uint16_t)(heapTop() - &__heap_start);
+    report->stackPeak = (uint16_t)((uint8_t*)RAMEND - heapTop()) + 1 - unused;
+    report->stackUnused = unused;
+#else
+    report->staticSize = 0;
+    report->heapSize = 0;
+    report->stackPeak = 0;
+    report->stackUnused = 0;
+#endif
+    report->freeNow = freeSram();
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli(); // Receive interrupt updates the buffer statistics
+#endif
+    report->rxHighWater = ble.rxHighWater;
+    report->txHighWater = ble.txHighWater;
+    report->rxOverruns = ble.rxOverruns;
+#if defined(__AVR__)
+    SREG = oldSREG;
+#endif
+    report->lineOverflows = getCommandStats()->overflows;
+}
+
+// -----------------------------------------------------------------------------------
+// Memory check procedure
+// -----------------------------------------------------------------------------------
+// Input : report - Report from memInfoGet
+// Output: bool - True if statics and heap leave MEM_STACK_MARGIN bytes for the stack,
+//                the stack kept that margin free and neither the receive ring nor
+//                a line buffer overflowed, false otherwise
+// -----------------------------------------------------------------------------------
+bool memCheck(const memReport_t* report) {
+#if defined(__AVR__)
+    if ((uint32_t)report->staticSize + report->heapSize + MEM_STACK_MARGIN > MEM_SRAM_SIZE) {
+        return false; // Over budget before the stack is counted
+    }
+    if (report->stackUnused < MEM_STACK_MARGIN) {
+        return false; // Stack came too close to the heap
+    }
+#endif
+    return report->rxOverruns == 0 && report->lineOverflows == 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * memInfo.h
+ *
+ * Created: 18-10-2026 07:03:15
+ * Author: Subrata
+ * Description: Header file for SRAM instrumentation of the RN4871 BLE library.
+ *              The free region between the heap and the stack is painted with a
+ *              known pattern before main() runs; the first overwritten byte marks
+ *              the deepest the stack has ever reached. Together with the static
+ *              size of the library buffers and the UART ring high-water marks
+ *              this shows how much of the 2 KB is really in use. The buffer
+ *              budget is checked at compile time, so growing a buffer beyond it
+ *              fails the build on the host as well as the AVR; on the AVR the
+ *              budget and stack margin must also fit the device's SRAM, and
+ *              memCheck compares the linked statics against it at run time.
+ *              memCheck also fails when a response or event line overflowed its
+ *              buffer, so a host run shows whether shrunk buffers still suffice.
+ */
+
+#ifndef MEMINFO_H_
+#define MEMINFO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "advController.h"
+#include "beacon.h"
+#include "bleSerial.h"
+#include "diagService.h"
+#include "rn4871.h"
+#include "sensorBridge.h"
+#include "tputService.h"
+
+// Byte written to the free SRAM at startup
+#define MEM_PAINT_BYTE      0xC5
+// Stack bytes that must never have been touched, below this memCheck() fails
+#ifndef MEM_STACK_MARGIN
+#define MEM_STACK_MARGIN    128
+#endif
+// Bytes the library buffers may occupy together
+#ifndef MEM_BUFFER_BUDGET
+#define MEM_BUFFER_BUDGET   640
+#endif
+#if defined(__AVR__)
+// SRAM of the device in bytes
+#define MEM_SRAM_SIZE       (RAMEND - RAMSTART + 1)
+#endif
+// Bytes of the library buffers listed in memBuffers
+#define MEM_BUFFER_TOTAL    (2 * BLE_BUFFER_SIZE + DEFAULT_INPUT_BUFFER_SIZE + \
+                             MAX_DEVICE_NAME_LEN + EVENT_LINE_SIZE + \
+                             sizeof(commandStats_t) + sizeof(advController_t) + \
+                             sizeof(beacon_t) + sizeof(diagService_t) + sizeof(tputService_t) + \
+                             sizeof(sensorBridge_t))
+
+typedef struct {
+    const char* name; // Buffer name
+    uint16_t size;    // Bytes reserved
+} memBuffer_t;
+
+typedef struct {
+    uint16_t staticSize;    // .data and .bss in bytes
+    uint16_t heapSize;      // Bytes allocated from the heap
+    uint16_t stackPeak;     // Deepest stack use since startup in bytes
+    uint16_t stackUnused;   // Free bytes the stack has never reached
+    uint16_t freeNow;       // Bytes between heap and stack at the call
+    uint8_t rxHighWater;    // Most bytes ever waiting in the receive ring
+    uint8_t txHighWater;    // Most bytes ever waiting in the transmit ring
+    uint16_t rxOverruns;    // Bytes lost because the receive ring was full
+    uint16_t lineOverflows; // Response and event bytes dropped from over-long lines
+} memReport_t;
+
+extern const memBuffer_t memBuffers[];
+extern const uint8_t memBufferCount;
+
+uint16_t memStackUnused(void);
+void memInfoGet(memReport_t* report);
+bool memCheck(const memReport_t* report);
+
+#endif /* MEMINFO_H_ */
@@ -0,0 +1,110 @@
+/*
+ * moduleConfig.cpp
+ *
+ * Created: 18-10-2026 06:47:26
+ * Author: Subrata
+ * Description: Implementation of configuration fingerprints for the RN4871 BLE
+ *              module. The module side is fingerprinted from the LS listing, which
+ *              covers every service and characteristic with its handle; the
+ *              application side is whatever the application hashes its settings
+ *              into, e.g. with crc16String over its UUIDs and name.
+ */
+
+#include "moduleConfig.h"
+#include "moduleScript.h"
+#include "rn4871.h"
+#include "crc16.h"
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#else
+#include <string.h>
+
+static configRecord_t hostRecord; // Stands in for the EEPROM on the Linux port
+#endif
+
+// -----------------------------------------------------------------------------------
+// Record check procedure
+// -----------------------------------------------------------------------------------
+// Input : record - Configuration record
+// Output: uint16_t - CRC-16 over the magic and both fingerprints
+// -----------------------------------------------------------------------------------
+static uint16_t recordCheck(const configRecord_t* record) {
+    const uint8_t* data = (const uint8_t*)record;
+    uint16_t crc = CRC16_INIT;
+
+    for (uint8_t i = 0; i < sizeof(*record) - sizeof(record->check); i++) {
+        crc = crc16Update(crc, data[i]);
+    }
+    return crc;
+}
+
+// -----------------------------------------------------------------------------------
+// Load record procedure
+// -----------------------------------------------------------------------------------
+// Input : record - Destination
+// Output: bool - True if a valid record is stored, false otherwise
+// -----------------------------------------------------------------------------------
+static bool loadRecord(configRecord_t* record) {
+#if defined(__AVR__)
+    eeprom_read_block(record, (const void*)CONFIG_EEPROM_ADDRESS, sizeof(*record));
+#else
+    memcpy(record, &hostRecord, sizeof(*record));
+#endif
+    return record->magic == CONFIG_RECORD_MAGIC && record->check == recordCheck(record);
+}
+
+// -----------------------------------------------------------------------------------
+// Read configuration fingerprint procedure
+// -----------------------------------------------------------------------------------
+// Input : fingerprint - Destination for the fingerprint of the module configuration
+// Output: bool - True if the listing was read completely, false otherwise
+// Lists the services and characteristics of the module and fingerprints the listing.
+// The module must be in command mode.
+// -----------------------------------------------------------------------------------
+bool configReadFingerprint(uint16_t* fingerprint) {
+    return readListingFingerprint(LIST_SERVICES_AND_CHARS, fingerprint);
+}
+
+// -----------------------------------------------------------------------------------
+// Configuration current procedure
+// -----------------------------------------------------------------------------------
+// Input : appFingerprint - Fingerprint of the configuration the application wants
+// Output: bool - True if the module holds that configuration, false otherwise
+// True only if the stored record was written for the same application fingerprint
+// and the module still lists the services it had when the record was saved. The
+// module must be in command mode.
+// -----------------------------------------------------------------------------------
+bool configIsCurrent(uint16_t appFingerprint) {
+    configRecord_t record;
+    uint16_t module;
+
+    if (!loadRecord(&record) || record.app != appFingerprint) {
+        return false; // Never configured or configured differently
+    }
+    return configReadFingerprint(&module) && module == record.module;
+}
+
+// -----------------------------------------------------------------------------------
+// Save configuration procedure
+// -----------------------------------------------------------------------------------
+// Input : appFingerprint - Fingerprint of the configuration just applied
+// Output: bool - True if the record was stored, false if the listing failed
+// Fingerprints the module configuration and stores it with the application
+// fingerprint. Call after the module was configured and rebooted, in command mode.
+// -----------------------------------------------------------------------------------
+bool configSave(uint16_t appFingerprint) {
+    configRecord_t record;
+
+    if (!configReadFingerprint(&record.module)) {
+        return false;
+    }
+    record.magic = CONFIG_RECORD_MAGIC;
+    record.app = appFingerprint;
+    record.check = recordCheck(&record);
+#if defined(__AVR__)
+    eeprom_update_block(&record, (void*)CONFIG_EEPROM_ADDRESS, sizeof(record)); // Writes changed bytes only
+#else
+    memcpy(&hostRecord, &record, sizeof(record));
+#endif
+    return true;
+}
@@ -0,0 +1,38 @@
+/*
+ * moduleConfig.h
+ *
+ * Created: 18-10-2026 06:46:25
+ * Author: Subrata
+ * Description: Header file for configuration fingerprints of the RN4871 BLE module.
+ *              After a successful configuration the application stores the
+ *              fingerprint of its settings together with the fingerprint of the
+ *              module's service listing in EEPROM. On the next start both are
+ *              compared, so a module that still holds the same configuration is
+ *              neither configured nor rebooted again.
+ */
+
+#ifndef MODULECONFIG_H_
+#define MODULECONFIG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// EEPROM address of the stored configuration record
+#ifndef CONFIG_EEPROM_ADDRESS
+#define CONFIG_EEPROM_ADDRESS 0
+#endif
+// Marks a valid record, erased EEPROM reads 0xFFFF
+#define CONFIG_RECORD_MAGIC   0x4E43
+
+typedef struct {
+    uint16_t magic;   // CONFIG_RECORD_MAGIC
+    uint16_t app;     // Fingerprint of the requested configuration
+    uint16_t module;  // Fingerprint of the module's LS listing after configuration
+    uint16_t check;   // CRC-16 of the fields above
+} configRecord_t;
+
+bool configReadFingerprint(uint16_t* fingerprint);
+bool configIsCurrent(uint16_t appFingerprint);
+bool configSave(uint16_t appFingerprint);
+
+#endif /* MODULECONFIG_H_ */
@@ -0,0 +1,287 @@
+/*
+ * moduleScript.cpp
+ *
+ * Created: 18-10-2026 05:45:42
+ * Author: Subrata
+ * Description: Implementation of script management for the RN4871 on-module
+ *              script engine. Uploads, verifies, starts and stops scripts from the
+ *              ATmega328PB so periodic tasks can run on the module while the MCU
+ *              sleeps.
+ */
+
+#include "moduleScript.h"
+#include "rn4871.h"
+#include "crc16.h"
+
+typedef struct {
+    uint16_t crc;     // Running fingerprint
+    uint16_t lineCrc; // Fingerprint before the current line
+    uint8_t lineLen;  // Characters in the current line
+    bool isEnd;       // Current line still matches "END"
+    bool isPrompt;    // Current line still matches the command prompt
+} scriptFingerprint_t;
+
+// -----------------------------------------------------------------------------------
+// Fingerprint initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : fp - Fingerprint state
+// Output: void
+// Resets the streaming fingerprint state before the first script character.
+// -----------------------------------------------------------------------------------
+static void fingerprintInit(scriptFingerprint_t* fp) {
+    fp->crc = CRC16_INIT;
+    fp->lineCrc = CRC16_INIT;
+    fp->lineLen = 0;
+    fp->isEnd = true;
+    fp->isPrompt = true;
+}
+
+// -----------------------------------------------------------------------------------
+// Fingerprint end of line procedure
+// -----------------------------------------------------------------------------------
+// Input : fp - Fingerprint state
+// Output: bool - True if the line terminated a listing, false otherwise
+// Commits the current line to the fingerprint. Empty lines are skipped and the "END"
+// trailer of a listing is removed so local and listed scripts fingerprint alike.
+// -----------------------------------------------------------------------------------
+static bool fingerprintEndLine(scriptFingerprint_t* fp) {
+    bool listingEnd = false;
+
+    if (fp->lineLen > 0) {
+        if (fp->isEnd && fp->lineLen == 3) {
+            fp->crc = fp->lineCrc; // Drop the END trailer
+            listingEnd = true;
+        } else {
+            fp->crc = crc16Update(fp->crc, '\n'); // Normalized line separator
+        }
+    }
+    fp->lineCrc = fp->crc;
+    fp->lineLen = 0;
+    fp->isEnd = true;
+    fp->isPrompt = true;
+    return listingEnd;
+}
+
+// -----------------------------------------------------------------------------------
+// Fingerprint feed procedure
+// -----------------------------------------------------------------------------------
+// Input : fp - Fingerprint state, c - Next script or listing character
+// Output: bool - True if the end of a listing was detected, false otherwise
+// Feeds one character into the fingerprint without buffering the line. Carriage
+// returns are ignored so CR+LF and LF separated scripts fingerprint alike.
+// -----------------------------------------------------------------------------------
+static bool fingerprintFeed(scriptFingerprint_t* fp, char c) {
+    if (c == CR) return false;
+    if (c == LF) return fingerprintEndLine(fp);
+
+    fp->isEnd = fp->isEnd && fp->lineLen < 3 && c == PROMPT_END[fp->lineLen];
+    fp->isPrompt = fp->isPrompt && fp->lineLen < 4 && c == PROMPT[fp->lineLen];
+    fp->crc = crc16Update(fp->crc, (uint8_t)c);
+    if (fp->lineLen < 0xFF) {
+        fp->lineLen++;
+    }
+
+    if (fp->isPrompt && fp->lineLen == 4) {
+        fp->crc = fp->lineCrc; // Drop the trailing prompt
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Drain until quiet procedure
+// -----------------------------------------------------------------------------------
+// Input : quietTime - Idle time in ms that ends the drain
+// Output: void
+// Discards received bytes until the UART has been idle for the given time.
+// -----------------------------------------------------------------------------------
+static void drainUntilQuiet(uint16_t quietTime) {
+    uint32_t last = millis();
+    while (!timeoutExpired(last, quietTime)) {
+        if (!bleAvailable()) {
+            continue; // Lets the transport wait for input
+        }
+        if (bleRead() != -1) {
+            last = millis(); // Restart the idle window
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Script fingerprint procedure
+// -----------------------------------------------------------------------------------
+// Input : script - Script lines separated by '\n'
+// Output: uint16_t - Fingerprint of the script
+// Computes the CRC-16 fingerprint of a script with normalized line separators.
+// -----------------------------------------------------------------------------------
+uint16_t scriptFingerprint(const char* script) {
+    scriptFingerprint_t fp;
+    fingerprintInit(&fp);
+    while (*script) {
+        fingerprintFeed(&fp, *script++);
+    }
+    fingerprintEndLine(&fp); // Terminate a last line without separator
+    return fp.crc;
+}
+
+// -----------------------------------------------------------------------------------
+// Read listing fingerprint procedure
+// -----------------------------------------------------------------------------------
+// Input : command - Command that prints a listing ending with END or the prompt,
+//         fingerprint - Destination for the fingerprint of the listing
+// Output: bool - True if the listing was read completely, false otherwise
+// Fingerprints the listing on the fly, so it never needs to fit in SRAM.
+// -----------------------------------------------------------------------------------
+bool readListingFingerprint(const char* command, uint16_t* fingerprint) {
+    scriptFingerprint_t fp;
+    fingerprintInit(&fp);
+
+    sendCommand(command); // Send listing command
+    uint32_t last = millis();
+    while (!timeoutExpired(last, DEFAULT_CMD_TIMEOUT)) {
+        if (!bleAvailable()) {
+            continue; // Lets the transport wait for input
+        }
+        int c = bleRead();
+        if (c == -1) {
+            continue;
+        }
+        last = millis();
+        commandOutcome(true); // Listing started
+        if (fingerprintFeed(&fp, (char)c)) {
+            *fingerprint = fp.crc; // END or prompt received
+            return true;
+        }
+    }
+    commandOutcome(false); // Nothing arrived
+    return false; // Timeout
+}
+
+// -----------------------------------------------------------------------------------
+// Read script fingerprint procedure
+// -----------------------------------------------------------------------------------
+// Input : fingerprint - Destination for the fingerprint of the module script
+// Output: bool - True if the listing was read completely, false otherwise
+// Lists the script stored on the RN4871 and fingerprints it.
+// -----------------------------------------------------------------------------------
+bool scriptReadFingerprint(uint16_t* fingerprint) {
+    return readListingFingerprint(LIST_SCRIPT, fingerprint);
+}
+
+// -----------------------------------------------------------------------------------
+// Upload script procedure
+// -----------------------------------------------------------------------------------
+// Input : script - Script lines separated by '\n'
+// Output: bool - True if the script was transferred, false otherwise
+// Clears the module script and writes the new one line by line in script input mode.
+// The transfer is not verified; use scriptSync for a verified upload.
+// -----------------------------------------------------------------------------------
+bool scriptUpload(const char* script) {
+    if (!scriptClear()) {
+        return false;
+    }
+
+    sendCommand(ENTER_SCRIPT_INPUT); // Enter script input mode
+    commandUncounted(); // Script input mode sends no response
+    drainUntilQuiet(SCRIPT_QUIET_TIME);
+
+    uint8_t lineLen = 0;
+    for (; *script; script++) {
+        char c = *script;
+        if (c == CR) {
+            continue;
+        }
+        if (c == LF) {
+            if (lineLen > 0) {
+                while (!blePrintChar(CR)); // Terminate script line
+                drainUntilQuiet(SCRIPT_QUIET_TIME); // Let the module store the line
+            }
+            lineLen = 0;
+            continue;
+        }
+        while (!blePrintChar(c)); // Send character, wait if buffer full
+        lineLen++;
+    }
+    if (lineLen > 0) {
+        while (!blePrintChar(CR));
+        drainUntilQuiet(SCRIPT_QUIET_TIME);
+    }
+
+    while (!blePrintChar(SCRIPT_INPUT_END)); // Leave script input mode
+    drainUntilQuiet(SCRIPT_QUIET_TIME);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Synchronize script procedure
+// -----------------------------------------------------------------------------------
+// Input : script - Script lines separated by '\n'
+// Output: scriptSyncResult_t - Outcome of the synchronization
+// Compares the fingerprint of the module script with the requested one and only
+// rewrites the script when they differ, verifying the result by listing it again.
+// -----------------------------------------------------------------------------------
+scriptSyncResult_t scriptSync(const char* script) {
+    uint16_t wanted = scriptFingerprint(script);
+    uint16_t current;
+
+    if (scriptReadFingerprint(&current) && current == wanted) {
+        return scriptSyncUnchanged; // Avoid rewriting the module script
+    }
+
+    scriptStop(); // Script may not be running, result ignored
+    if (!scriptUpload(script)) {
+        return scriptSyncFailed;
+    }
+    if (!scriptReadFingerprint(&current) || current != wanted) {
+        return scriptSyncFailed; // Verification failed
+    }
+    return scriptSyncWritten;
+}
+
+// -----------------------------------------------------------------------------------
+// Clear script procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if successful, false otherwise
+// Erases the script stored on the RN4871 module.
+// -----------------------------------------------------------------------------------
+bool scriptClear(void) {
+    sendCommand(CLEAR_SCRIPT); // Send clear script command
+    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+}
+
+// -----------------------------------------------------------------------------------
+// Start script procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if successful, false otherwise
+// Starts execution of the script stored on the RN4871 module.
+// -----------------------------------------------------------------------------------
+bool scriptStart(void) {
+    sendCommand(START_SCRIPT); // Send start script command
+    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+}
+
+// -----------------------------------------------------------------------------------
+// Stop script procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if successful, false otherwise
+// Stops execution of the script running on the RN4871 module.
+// -----------------------------------------------------------------------------------
+bool scriptStop(void) {
+    sendCommand(STOP_SCRIPT); // Send stop script command
+    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+}
+
+// -----------------------------------------------------------------------------------
+// Enable script auto-run procedure
+// -----------------------------------------------------------------------------------
+// Input : features - Supported features bitmap to keep
+// Output: bool - True if successful, false otherwise
+// Sets the supported features with the run-script-after-power-on bit added, so the
+// module starts its script on every boot (effective after reboot).
+// -----------------------------------------------------------------------------------
+bool scriptEnableAutoRun(uint16_t features) {
+    return setSupportedFeatures(features | RUN_SCRIPT_AFTER_POWER_ON_BMP);
+}
@@ -0,0 +1,36 @@
+/*
+ * moduleScript.h
+ *
+ * Created: 18-10-2026 05:45:27
+ * Author: Subrata
+ * Description: Header file for managing scripts on the RN4871 on-module script
+ *              engine. Scripts are given as a single string with one script line
+ *              per '\n' and are fingerprinted so unchanged scripts are not rewritten.
+ */
+
+#ifndef MODULESCRIPT_H_
+#define MODULESCRIPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Time without received bytes after which a script response is considered complete (ms)
+#define SCRIPT_QUIET_TIME 30
+
+typedef enum {
+    scriptSyncUnchanged, // Module already holds the script, nothing written
+    scriptSyncWritten,   // Script uploaded and verified
+    scriptSyncFailed     // Upload or verification failed
+} scriptSyncResult_t;
+
+uint16_t scriptFingerprint(const char* script);
+bool readListingFingerprint(const char* command, uint16_t* fingerprint);
+bool scriptReadFingerprint(uint16_t* fingerprint);
+bool scriptUpload(const char* script);
+scriptSyncResult_t scriptSync(const char* script);
+bool scriptClear(void);
+bool scriptStart(void);
+bool scriptStop(void);
+bool scriptEnableAutoRun(uint16_t features);
+
+#endif /* MODULESCRIPT_H_ */
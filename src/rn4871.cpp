@@ -9,17 +9,31 @@
  */
 
 #include "rn4871.h"
-#include <avr/io.h>
-#include <util/delay.h>
+#include "lsParser.h"
+#include "cpuLoad.h"
+#include "energyModel.h"
 #include <stdio.h>
 #include <string.h>
 
-#define DEFAULT_INPUT_BUFFER_SIZE 128
 char uartBuffer[DEFAULT_INPUT_BUFFER_SIZE];
 int uartBufferLen = DEFAULT_INPUT_BUFFER_SIZE;
 char deviceName[MAX_DEVICE_NAME_LEN];
 
-operationMode_t operationMode = dataMode;
+operationMode_t operationMode = unknownMode;
+static uint32_t lastTxTime = 0; // millis() when the last command or data left the MCU
+
+// Longest wait in ms for the rest of a prompt before a command is sent
+#define ARM_PROMPT_WAIT 10
+// Longest wait in ms for the prompt after $$$
+#define ENTER_CMD_TIMEOUT 30
+static eventHandler_t eventHandler = NULL;
+static char eventLine[EVENT_LINE_SIZE];
+static uint8_t eventLen = 0;
+static bool inEvent = false;
+static bool rebootSeen = false; // %REBOOT% received since the last reboot command
+static commandStats_t commandStats;
+static bool commandPending = false; // Sent command still waits for its first response line
+static uint32_t commandStart = 0;   // millis() when the pending command was queued
 
 // -----------------------------------------------------------------------------------
 // Hardware initialization procedure
@@ -33,60 +47,325 @@ void hwInit(uint8_t rstPin, volatile uint8_t *ddr, volatile uint8_t *port) {
     if (rstPin != -1) {
         *ddr |= (1 << rstPin); // Set reset pin as output
         *port &= ~(1 << rstPin); // Pull reset pin low
-        _delay_ms(1); // Hold low for 1ms
+        delay(1); // Hold low for 1ms
         *port |= (1 << rstPin); // Pull reset pin high
-        _delay_ms(500); // Wait for module stabilization
+        delay(500); // Wait for module stabilization
     }
 }
 
 // -----------------------------------------------------------------------------------
-// Expect response procedure
+// Set event handler procedure
 // -----------------------------------------------------------------------------------
-// Input : expectedResponse - The response string to expect, timeout - Timeout in ms
-// Output: bool - True if response matches, false otherwise
-// Reads UART data into a buffer and checks for the expected response within the
-// specified timeout period, returning true if found.
+// Input : handler - Called with each event (without % delimiters) and each unsolicited
+//         line received ahead of a command, NULL to discard them
+// Output: void
 // -----------------------------------------------------------------------------------
-bool expectResponse(const char* expectedResponse, uint16_t timeout) {
-    uint8_t index = 0;
-    uint32_t start;
+void setEventHandler(eventHandler_t handler) {
+    eventHandler = handler;
+}
 
-    bleRxFlush(); // Clear receive buffer
-    memset(uartBuffer, 0, sizeof(uartBuffer)); // Initialize buffer
+// -----------------------------------------------------------------------------------
+// Dispatch event procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Hands the assembled event or unsolicited line to the event handler and resets it.
+// -----------------------------------------------------------------------------------
+static void dispatchEvent(void) {
+    eventLine[eventLen] = '\0';
+    if (eventLen > 0) {
+        ENERGY_EVENT(eventLine);
+        if (eventHandler != NULL) {
+            eventHandler(eventLine);
+        }
+    }
+    eventLen = 0;
+}
 
-    start = millis();
-    while (millis() - start < timeout) {
-        if (bleAvailable()) {
-            char c = bleRead();
-            if (c != -1) {
-                if (c == '\n') {
-                    uartBuffer[index] = '\0';
-                    if (strstr(uartBuffer, expectedResponse) != NULL) {
-                        return true; // Response found
-                    }
-                    return false; // Complete message, no match
-                } else if (index < sizeof(uartBuffer) - 1) {
-                    uartBuffer[index++] = c;
+// -----------------------------------------------------------------------------------
+// Feed event procedure
+// -----------------------------------------------------------------------------------
+// Input : c - Received byte, lineStart - True if no byte of a line is pending
+// Output: bool - True if the byte belongs to an event and was consumed
+// Events start with % at the beginning of a line and end with the next %, as in the
+// command engine, so they are recognized even in the middle of a response. A reboot
+// event puts the tracked mode back to data mode.
+// -----------------------------------------------------------------------------------
+static bool feedEvent(char c, bool lineStart) {
+    if (inEvent) {
+        if (c == '%') {
+            inEvent = false;
+            if (eventLen == sizeof(REBOOT_EVENT) - 3 && memcmp(eventLine, REBOOT_EVENT + 1, eventLen) == 0) {
+                operationMode = dataMode; // The module always boots in data mode
+                rebootSeen = true;
+            }
+            dispatchEvent();
+        } else if (eventLen < EVENT_LINE_SIZE - 1) {
+            eventLine[eventLen++] = c;
+        } else {
+            commandStats.overflows++;
+        }
+        return true;
+    }
+    if (c == '%' && lineStart) {
+        inEvent = true; // Start of an asynchronous event
+        eventLen = 0;
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Arm response procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Must run before the first byte of a command is queued. Everything already received
+// cannot belong to the coming response: prompts are consumed and mark command mode,
+// events and other lines are passed to the event handler. Every byte received afterwards is left for the
+// response reader, so nothing that arrives while the command is still being sent is
+// lost.
+// -----------------------------------------------------------------------------------
+static void armResponse(void) {
+    CPU_WAIT_SCOPE();
+    uint32_t start = millis();
+
+    for (;;) {
+        int c;
+        while ((c = bleRead()) != -1) { // Never waits for more data
+            if (feedEvent((char)c, eventLen == 0)) {
+                continue;
+            }
+            if (c == CR) {
+                continue;
+            }
+            if (c == LF) {
+                eventLine[eventLen] = '\0';
+                if (strcmp(eventLine, PROMPT_END) == 0) {
+                    eventLen = 0; // Prompt consumed
+                }
+                dispatchEvent(); // Unsolicited line
+            } else if (eventLen < EVENT_LINE_SIZE - 1) {
+                eventLine[eventLen++] = (char)c;
+                if (eventLen == sizeof(PROMPT) - 1 && memcmp(eventLine, PROMPT, sizeof(PROMPT) - 1) == 0) {
+                    eventLen = 0; // Prompt consumed
+                    operationMode = cmdMode;
                 }
+            } else {
+                commandStats.overflows++;
+            }
+        }
+        // A prompt still arriving would otherwise run into the response
+        bool partialPrompt = !inEvent && eventLen > 0 && eventLen < sizeof(PROMPT) - 1 &&
+                             memcmp(eventLine, PROMPT, eventLen) == 0;
+        if (!partialPrompt || timeoutExpired(start, ARM_PROMPT_WAIT)) {
+            break;
+        }
+        bleAvailable(); // Poll the receiver
+    }
+    if (!inEvent) {
+        dispatchEvent(); // Stale partial line
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Command outcome procedure
+// -----------------------------------------------------------------------------------
+// Input : answered - True if the response has started, false if none came in time
+// Output: void
+// Settles the command sent last in the statistics; later calls for the same command
+// are ignored. readResponseLine calls it, readers that parse the response themselves
+// call it at the first response byte and when they give up.
+// -----------------------------------------------------------------------------------
+void commandOutcome(bool answered) {
+    if (!commandPending) {
+        return; // Already settled
+    }
+    commandPending = false;
+    if (!answered) {
+        commandStats.timeouts++;
+        return;
+    }
+
+    uint32_t latency = millis() - commandStart;
+    uint16_t ms = latency > 0xFFFF ? 0xFFFF : (uint16_t)latency;
+    commandStats.answered++;
+    commandStats.latencyTotal += ms;
+    if (ms > commandStats.latencyMax) {
+        commandStats.latencyMax = ms;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Uncounted command procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Removes the command sent last from the statistics, for commands the module does
+// not answer.
+// -----------------------------------------------------------------------------------
+void commandUncounted(void) {
+    if (commandPending) {
+        commandPending = false;
+        commandStats.commands--;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Read response line procedure
+// -----------------------------------------------------------------------------------
+// Input : timeout - Timeout in ms
+// Output: int16_t - Length of the line in the UART buffer, -1 on timeout
+// Assembles the next non-empty response line in the UART buffer. CR is dropped, a
+// prompt at the start of the line is consumed and events are passed to the event
+// handler.
+// -----------------------------------------------------------------------------------
+static int16_t readResponseLine(uint16_t timeout) {
+    CPU_WAIT_SCOPE();
+    uint8_t index = 0;
+    uint32_t start = millis();
+
+    memset(uartBuffer, 0, sizeof(uartBuffer)); // Command builders rely on a clean buffer
+    while (!timeoutExpired(start, timeout)) {
+        if (!bleAvailable()) {
+            continue;
+        }
+        int c = bleRead();
+        if (c == -1) {
+            continue;
+        }
+        if (feedEvent((char)c, index == 0)) {
+            continue;
+        }
+        if (c == CR) {
+            continue;
+        }
+        if (c == LF) {
+            if (index > 0) {
+                uartBuffer[index] = '\0';
+                commandOutcome(true);
+                return index; // Complete line
+            }
+        } else if (index < sizeof(uartBuffer) - 1) {
+            uartBuffer[index++] = (char)c;
+            if (index == sizeof(PROMPT) - 1 && memcmp(uartBuffer, PROMPT, sizeof(PROMPT) - 1) == 0) {
+                index = 0; // Prompt consumed
+                operationMode = cmdMode;
+            }
+        } else {
+            commandStats.overflows++;
+        }
+    }
+    uartBuffer[index] = '\0';
+    commandOutcome(false);
+    return -1; // Timeout occurred
+}
+
+// -----------------------------------------------------------------------------------
+// Wait for prompt procedure
+// -----------------------------------------------------------------------------------
+// Input : timeout - Timeout in ms
+// Output: bool - True if a command prompt was received, false on timeout
+// Accepts both the "CMD> " prompt and the "CMD" line of older firmware; lines in
+// between are skipped and events are passed to the event handler. A reboot event
+// ends the wait early, as a module that just booted answers nothing it was sent
+// before.
+// -----------------------------------------------------------------------------------
+static bool waitPrompt(uint16_t timeout) {
+    CPU_WAIT_SCOPE();
+    uint8_t index = 0;
+    uint32_t start = millis();
+    bool booted = rebootSeen;
+
+    while (!timeoutExpired(start, timeout) && rebootSeen == booted) {
+        if (!bleAvailable()) {
+            continue;
+        }
+        int c = bleRead();
+        if (c == -1) {
+            continue;
+        }
+        if (feedEvent((char)c, index == 0)) {
+            continue;
+        }
+        if (c == CR) {
+            continue;
+        }
+        if (c == LF) {
+            if (index == sizeof(PROMPT_CR) - 3 && memcmp(uartBuffer, PROMPT_CR, index) == 0) {
+                operationMode = cmdMode;
+                return true; // Prompt line
+            }
+            index = 0;
+        } else if (index < sizeof(uartBuffer) - 1) {
+            uartBuffer[index++] = (char)c;
+            if (index == sizeof(PROMPT) - 1 && memcmp(uartBuffer, PROMPT, sizeof(PROMPT) - 1) == 0) {
+                operationMode = cmdMode;
+                return true; // Prompt
             }
         }
     }
     return false; // Timeout occurred
 }
 
+// -----------------------------------------------------------------------------------
+// Expect response procedure
+// -----------------------------------------------------------------------------------
+// Input : expectedResponse - The response string to expect, timeout - Timeout in ms
+// Output: bool - True if response matches, false otherwise
+// Reads the next response line into the UART buffer and checks it for the expected
+// response within the specified timeout period, returning true if found. Bytes
+// received since the command was armed are kept, so a fast response is not lost.
+// -----------------------------------------------------------------------------------
+bool expectResponse(const char* expectedResponse, uint16_t timeout) {
+    if (readResponseLine(timeout) < 0) {
+        return false; // Timeout occurred
+    }
+    return strstr(uartBuffer, expectedResponse) != NULL;
+}
+
 // -----------------------------------------------------------------------------------
 // Send command procedure
 // -----------------------------------------------------------------------------------
 // Input : command - The ASCII command string to send
 // Output: void
-// Sends a command to the RN4871 module via UART, appending a carriage return,
-// and flushes transmit/receive buffers for clean communication.
+// Sends a command to the RN4871 module via UART, appending a carriage return. Stale
+// received data is routed to the event path before the first byte is queued, and
+// nothing received after that is discarded.
 // -----------------------------------------------------------------------------------
 void sendCommand(const char* command) {
     bleTxFlush(); // Clear transmit buffer
-    bleRxFlush(); // Clear receive buffer
+    armResponse(); // Route stale data, keep everything from here on
+    commandOutcome(false); // The previous command's response was never read
+    commandStart = millis();
+    commandPending = true;
+    commandStats.commands++;
     blePrintString(command); // Send command
-    blePrintChar(CR); // Append carriage return
+    while (!blePrintChar(CR)); // Append carriage return
+    lastTxTime = millis();
+}
+
+// -----------------------------------------------------------------------------------
+// Get command statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: const commandStats_t* - Counters since the last reset
+// Latencies cover commands sent with sendCommand, from queuing the command to the
+// first line of its response.
+// -----------------------------------------------------------------------------------
+const commandStats_t* getCommandStats(void) {
+    return &commandStats;
+}
+
+// -----------------------------------------------------------------------------------
+// Reset command statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// -----------------------------------------------------------------------------------
+void resetCommandStats(void) {
+    memset(&commandStats, 0, sizeof(commandStats));
+    commandPending = false; // A command sent before the reset is not counted
 }
 
 // -----------------------------------------------------------------------------------
@@ -101,6 +380,29 @@ void sendData(const char* data, uint16_t dataLen) {
     for (uint16_t i = 0; i < dataLen; i++) {
         while (!blePrintChar(data[i])); // Send byte, wait if buffer full
     }
+    lastTxTime = millis();
+}
+
+// -----------------------------------------------------------------------------------
+// Wait for reboot event procedure
+// -----------------------------------------------------------------------------------
+// Input : timeout - Timeout in ms
+// Output: bool - True if the reboot event was received, false on timeout
+// Other bytes are discarded; a booting module sends nothing else of interest.
+// -----------------------------------------------------------------------------------
+static bool waitReboot(uint16_t timeout) {
+    CPU_WAIT_SCOPE();
+    uint32_t start = millis();
+
+    while (!rebootSeen && !timeoutExpired(start, timeout)) {
+        if (bleAvailable()) {
+            int c = bleRead();
+            if (c != -1) {
+                feedEvent((char)c, true);
+            }
+        }
+    }
+    return rebootSeen;
 }
 
 // -----------------------------------------------------------------------------------
@@ -108,16 +410,20 @@ void sendData(const char* data, uint16_t dataLen) {
 // -----------------------------------------------------------------------------------
 // Input : None
 // Output: bool - True if reboot successful, false otherwise
-// Sends the reboot command to the RN4871 and waits for the reboot response,
-// including a delay for module stabilization.
+// Sends the reboot command to the RN4871 and waits for the reboot response, then
+// for the reboot event that marks the module ready in data mode. The wait ends
+// after RESET_CMD_TIMEOUT if the event is not seen.
 // -----------------------------------------------------------------------------------
 bool reboot(void) {
     sendCommand(REBOOT); // Send reboot command
-    if (expectResponse(REBOOTING_RESP, RESET_CMD_TIMEOUT)) {
-        _delay_ms(RESET_CMD_TIMEOUT); // Wait for reboot completion
-        return true;
+    rebootSeen = false;
+    if (!expectResponse(REBOOTING_RESP, RESET_CMD_TIMEOUT)) {
+        return false;
     }
-    return false;
+
+    waitReboot(RESET_CMD_TIMEOUT);
+    operationMode = dataMode; // Rebooted even if the event was missed
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -147,21 +453,15 @@ operationMode_t getOperationMode(void) {
 // -----------------------------------------------------------------------------------
 // Input : None
 // Output: bool - True if initialization successful, false otherwise
-// Initializes the RN4871 module by rebooting and setting it to data mode,
-// retrying if already in command mode.
+// Brings the RN4871 module into data mode without rebooting it. The probe leaves a
+// responding module in command mode, whatever state it was found in, so it only has
+// to leave command mode again. Call reboot() first where a clean start is wanted.
 // -----------------------------------------------------------------------------------
 bool swInit(void) {
-    bool initOk = false;
-    if (reboot()) {
-        setOperationMode(dataMode); // Set to data mode
-        initOk = true;
-    } else if (enterCommandMode()) {
-        if (reboot()) {
-            setOperationMode(dataMode);
-            initOk = true;
-        }
+    if (probeModule() == moduleSilent) {
+        return false;
     }
-    return initOk;
+    return enterDataMode();
 }
 
 // -----------------------------------------------------------------------------------
@@ -180,7 +480,8 @@ void flush(void) {
 // -----------------------------------------------------------------------------------
 // Input : None
 // Output: void
-// Reads and discards all available data in the UART receive buffer.
+// Reads and discards all available data in the UART receive buffer. Commands do not
+// need this; sendCommand routes stale data to the event handler instead.
 // -----------------------------------------------------------------------------------
 void cleanInputBuffer(void) {
     while (bleAvailable() > 0) {
@@ -192,12 +493,64 @@ void cleanInputBuffer(void) {
 // Enter data mode procedure
 // -----------------------------------------------------------------------------------
 // Input : None
-// Output: void
-// Sends the exit command to switch the RN4871 to data mode and updates the internal state.
-// -----------------------------------------------------------------------------------
-void enterDataMode(void) {
-    sendCommand(EXIT_CMD); // Send exit command
+// Output: bool - True if the module is in data mode, false otherwise
+// Sends the exit command to switch the RN4871 to data mode and waits for its
+// acknowledgement. Nothing is sent if the module is known to be in data mode. Without
+// the acknowledgement the mode is unknown, so the next enterCommandMode probes.
+// -----------------------------------------------------------------------------------
+bool enterDataMode(void) {
+    if (operationMode == dataMode) {
+        return true; // Already in data mode
+    }
+    sendCommand(EXIT_CMD); // Send exit command, the appended CR ends the line
+    if (!expectResponse(PROMPT_END, DEFAULT_CMD_TIMEOUT)) { // Wait for END
+        setOperationMode(unknownMode);
+        return false;
+    }
     setOperationMode(dataMode); // Update mode
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Command mode sequence procedure
+// -----------------------------------------------------------------------------------
+// Input : completeLine - Send a CR if $$$ is not answered
+// Output: moduleState_t - moduleDataMode if $$$ was answered, moduleCmdMode if only the
+//         CR was, moduleSilent if neither
+// Waits out what is left of the guard time since the last transmission, then sends
+// $$$. A module already in command mode takes $$$ as the start of a command line, so
+// the CR completes that line and its prompt confirms command mode. A reboot event
+// instead of the prompt means $$$ was lost to a boot and the module is in data mode,
+// so no CR is sent.
+// -----------------------------------------------------------------------------------
+static moduleState_t commandSequence(bool completeLine) {
+    bool booted = rebootSeen;
+
+    if (!RingBuffer_is_empty(&ble.tx_buffer)) {
+        bleTxWait(); // Let pending data leave the UART
+        lastTxTime = millis();
+    }
+    uint32_t idle = millis() - lastTxTime;
+    if (idle < DELAY_BEFORE_CMD) {
+        delay(DELAY_BEFORE_CMD - idle); // Remainder of the guard time
+    }
+
+    flush(); // Clear UART buffer
+    armResponse(); // Route stale data to the event handler
+    blePrintString(ENTER_CMD); // Send $$$ to enter command mode
+    lastTxTime = millis();
+    if (waitPrompt(ENTER_CMD_TIMEOUT)) {
+        return moduleDataMode;
+    }
+
+    if (completeLine && rebootSeen == booted) {
+        while (!blePrintChar(CR)); // Complete a pending $$$ command line
+        lastTxTime = millis();
+        if (waitPrompt(DEFAULT_CMD_TIMEOUT)) {
+            return moduleCmdMode;
+        }
+    }
+    return moduleSilent;
 }
 
 // -----------------------------------------------------------------------------------
@@ -206,23 +559,39 @@ void enterDataMode(void) {
 // Input : None
 // Output: bool - True if command mode entered, false otherwise
 // Sends the command mode entry sequence ($$$) and waits for the command prompt response.
+// Returns at once if the module is known to be in command mode. If the mode is unknown
+// a missing answer to $$$ is followed by a CR, see commandSequence.
 // -----------------------------------------------------------------------------------
 bool enterCommandMode(void) {
-    _delay_ms(DELAY_BEFORE_CMD); // Wait before sending command
-    flush(); // Clear UART buffer
-    bleTxFlush(); // Clear transmit buffer
-    cleanInputBuffer(); // Clear receive buffer
-    blePrintString(ENTER_CMD); // Send $$$ to enter command mode
-
-    uint32_t start = millis();
-    while ((millis() - start < 30) && (bleAvailable() < 5)) {} // Wait for response
+    if (operationMode == cmdMode) {
+        return true; // Already in command mode
+    }
+    return commandSequence(operationMode == unknownMode) != moduleSilent;
+}
 
-    bleReadBytes(uartBuffer, bleAvailable()); // Read response
-    if (strstr(uartBuffer, PROMPT) != NULL || strstr(uartBuffer, PROMPT_CR) != NULL) {
-        setOperationMode(cmdMode); // Update mode
-        return true;
+// -----------------------------------------------------------------------------------
+// Probe module procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: moduleState_t - State the module was found in
+// Finds out what the module is doing without rebooting it and leaves it in command
+// mode. A module in data mode answers $$$ within a few byte times, one in command
+// mode answers the CR that follows. A module that answers neither may still be
+// booting, e.g. after hwInit, so the probe waits for its reboot event and tries once
+// more. The prompt, not a fixed delay, ends each step.
+// -----------------------------------------------------------------------------------
+moduleState_t probeModule(void) {
+    operationMode = unknownMode;
+    rebootSeen = false;
+
+    moduleState_t state = commandSequence(true);
+    if (state != moduleSilent) {
+        return rebootSeen ? moduleBooting : state;
     }
-    return false;
+    if (!waitReboot(RESET_CMD_TIMEOUT)) {
+        return moduleSilent; // Not responding
+    }
+    return commandSequence(false) != moduleSilent ? moduleBooting : moduleSilent;
 }
 
 // -----------------------------------------------------------------------------------
@@ -246,7 +615,11 @@ bool clearAllServices(void) {
 // -----------------------------------------------------------------------------------
 bool stopAdvertising(void) {
     sendCommand(STOP_ADV); // Send stop advertising command
-    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+    if (!expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_RADIO(energyModuleIdle, 0);
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -380,7 +753,11 @@ bool setAdvPower(uint8_t value) {
     memcpy(uartBuffer, SET_ADV_POWER, len); // Copy command prefix
     memcpy(&uartBuffer[len], c, 1); // Append power level
     sendCommand(uartBuffer); // Send command
-    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+    if (!expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_TX_POWER(value);
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -424,23 +801,9 @@ bool setCharactUUID(const char *uuid, uint8_t property, uint8_t octetLen) {
         return false; // Invalid UUID length
     }
 
-    const uint8_t prefixLen = strlen(DEFINE_CHARACT_UUID);
-    const uint8_t maxUuidLen = (PRIVATE_SERVICE_LEN > PUBLIC_SERVICE_LEN) ? PRIVATE_SERVICE_LEN : PUBLIC_SERVICE_LEN;
-    const uint8_t bufferSize = prefixLen + maxUuidLen + 1 + 2 + 1 + 2 + 1; // prefix + uuid + ',' + prop + ',' + octet + '\0'
-    char cmdBuffer[bufferSize];
-    cmdBuffer[0] = '\0';
-
-    strcpy(cmdBuffer, DEFINE_CHARACT_UUID); // Copy prefix
-    strcat(cmdBuffer, uuid); // Append UUID
-    strcat(cmdBuffer, ","); // Append comma
-    char hex[3];
-    snprintf(hex, sizeof(hex), "%02X", property); // Format property
-    strcat(cmdBuffer, hex); // Append property
-    strcat(cmdBuffer, ","); // Append comma
-    snprintf(hex, sizeof(hex), "%02X", octetLen); // Format octet length
-    strcat(cmdBuffer, hex); // Append octet length
-
-    sendCommand(cmdBuffer); // Send command
+    // Built in the shared UART buffer rather than on the stack
+    snprintf(uartBuffer, sizeof(uartBuffer), "%s%s,%02X,%02X", DEFINE_CHARACT_UUID, uuid, property, octetLen);
+    sendCommand(uartBuffer); // Send command
     return expectResponse(AOK_RESP, 500); // Check for AOK response
 }
 
@@ -483,6 +846,72 @@ bool startCustomAdvertising(uint16_t interval) {
     memcpy(uartBuffer, START_CUSTOM_ADV, len); // Copy command prefix
     memcpy(&uartBuffer[len], parameters, newLen); // Append interval
     sendCommand(uartBuffer); // Send command
+    if (!expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_RADIO(energyAdvertising, interval);
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Set beacon features procedure
+// -----------------------------------------------------------------------------------
+// Input : setting - BEACON_OFF, BEACON_ON or BEACON_ADV_ON
+// Output: bool - True if successful, false otherwise
+// Configures whether the RN4871 sends beacons, alone or alongside advertising.
+// The setting takes effect after a reboot.
+// -----------------------------------------------------------------------------------
+bool setBeaconFeatures(const char* setting) {
+    uint8_t len = strlen(SET_BEACON_FEATURES);
+
+    flush(); // Clear UART buffer
+    memcpy(uartBuffer, SET_BEACON_FEATURES, len); // Copy command prefix
+    memcpy(&uartBuffer[len], setting, strlen(setting)); // Append setting
+    sendCommand(uartBuffer); // Send command
+    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+}
+
+// -----------------------------------------------------------------------------------
+// Start permanent beacon procedure
+// -----------------------------------------------------------------------------------
+// Input : adType - Advertising type, adData - Advertising data
+// Output: bool - True if successful, false otherwise
+// Appends an AD structure to the beacon payload stored permanently on the module.
+// -----------------------------------------------------------------------------------
+bool startPermanentBeacon(uint8_t adType, const char adData[]) {
+    uint8_t len = strlen(START_PERMANENT_BEACON);
+    char c[3];
+    sprintf(c, "%02X", adType); // Format ad type
+    uint8_t newLen = strlen(c);
+
+    flush(); // Clear UART buffer
+    memcpy(uartBuffer, START_PERMANENT_BEACON, len); // Copy command prefix
+    memcpy(&uartBuffer[len], c, newLen); // Append ad type
+    memcpy(&uartBuffer[len + newLen], ",", 1); // Append comma
+    memcpy(&uartBuffer[len + newLen + 1], adData, strlen(adData)); // Append ad data
+    sendCommand(uartBuffer); // Send command
+    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+}
+
+// -----------------------------------------------------------------------------------
+// Start immediate beacon procedure
+// -----------------------------------------------------------------------------------
+// Input : adType - Advertising type, adData - Advertising data
+// Output: bool - True if successful, false otherwise
+// Updates an AD structure of the running beacon payload without storing it.
+// -----------------------------------------------------------------------------------
+bool startImmediateBeacon(uint8_t adType, const char adData[]) {
+    uint8_t len = strlen(START_IMMEDIATE_BEACON);
+    char c[3];
+    sprintf(c, "%02X", adType); // Format ad type
+    uint8_t newLen = strlen(c);
+
+    flush(); // Clear UART buffer
+    memcpy(uartBuffer, START_IMMEDIATE_BEACON, len); // Copy command prefix
+    memcpy(&uartBuffer[len], c, newLen); // Append ad type
+    memcpy(&uartBuffer[len + newLen], ",", 1); // Append comma
+    memcpy(&uartBuffer[len + newLen + 1], adData, strlen(adData)); // Append ad data
+    sendCommand(uartBuffer); // Send command
     return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
 }
 
@@ -505,22 +934,14 @@ const char* getDeviceName() {
 // Queries the RN4871 for its connection status, parsing the response.
 // -----------------------------------------------------------------------------------
 int getConnectionStatus(void) {
-    uint16_t timeout = DEFAULT_CMD_TIMEOUT;
-    unsigned long previous;
-
     sendCommand(GET_CONNECTION_STATUS); // Send connection status command
-    previous = millis();
-    while (millis() - previous < timeout) {
-        if (bleAvailable() > 0) {
-            if (readUntilCR() > 0) {
-                if (strstr(uartBuffer, NONE_RESP) != NULL) {
-                    return 0; // Not connected
-                }
-                return 1; // Connected
-            }
-        }
+    if (readResponseLine(DEFAULT_CMD_TIMEOUT) < 0) {
+        return -1; // Timeout
     }
-    return -1; // Timeout
+    if (strstr(uartBuffer, NONE_RESP) != NULL) {
+        return 0; // Not connected
+    }
+    return 1; // Connected
 }
 
 // -----------------------------------------------------------------------------------
@@ -531,12 +952,13 @@ int getConnectionStatus(void) {
 // Reads UART data into a buffer until a carriage return is encountered or timeout.
 // -----------------------------------------------------------------------------------
 uint16_t readUntilCR(char* buffer, uint16_t size, uint16_t start) {
+    CPU_WAIT_SCOPE();
     uint16_t bytesRead = 0;
     uint32_t startTime = millis();
     const uint16_t timeout = 1000;
 
     while (bytesRead < size - start - 1) {
-        if (millis() - startTime >= timeout) {
+        if (timeoutExpired(startTime, timeout)) {
             break; // Timeout
         }
         if (bleAvailable()) {
@@ -544,6 +966,7 @@ uint16_t readUntilCR(char* buffer, uint16_t size, uint16_t start) {
             if (c == -1) {
                 continue;
             }
+            commandOutcome(true); // Response started
             if (c == CR) {
                 break; // Stop at CR
             }
@@ -552,6 +975,7 @@ uint16_t readUntilCR(char* buffer, uint16_t size, uint16_t start) {
         }
     }
     buffer[start + bytesRead] = '\0'; // Null-terminate
+    commandOutcome(false); // Nothing arrived
     return bytesRead;
 }
 
@@ -596,7 +1020,11 @@ bool writeLocalCharacteristic(uint16_t handle, const char value[]) {
     memcpy(&uartBuffer[len + newLen], ",", 1); // Append comma
     memcpy(&uartBuffer[len + newLen + 1], value, strlen(value)); // Append value
     sendCommand(uartBuffer); // Send command
-    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+    if (!expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_UPDATE();
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -607,9 +1035,6 @@ bool writeLocalCharacteristic(uint16_t handle, const char value[]) {
 // Reads the value of a local characteristic, storing it in the UART buffer.
 // -----------------------------------------------------------------------------------
 bool readLocalCharacteristic(uint16_t handle) {
-    uint16_t timeout = DEFAULT_CMD_TIMEOUT;
-    unsigned long previous;
-
     uint8_t len = strlen(READ_LOCAL_CHARACT);
     char c[5];
     sprintf(c, "%04X", handle); // Format handle
@@ -619,15 +1044,7 @@ bool readLocalCharacteristic(uint16_t handle) {
     memcpy(uartBuffer, READ_LOCAL_CHARACT, len); // Copy command prefix
     memcpy(&uartBuffer[len], c, newLen); // Append handle
     sendCommand(uartBuffer); // Send command
-    previous = millis();
-    while (millis() - previous < timeout) {
-        if (bleAvailable() > 0) {
-            if (readUntilCR() > 0) {
-                return true; // Data read successfully
-            }
-        }
-    }
-    return false; // Timeout
+    return readResponseLine(DEFAULT_CMD_TIMEOUT) > 0; // Data read successfully
 }
 
 // -----------------------------------------------------------------------------------
@@ -638,19 +1055,8 @@ bool readLocalCharacteristic(uint16_t handle) {
 // Queries the RN4871 for its firmware version, storing it in the UART buffer.
 // -----------------------------------------------------------------------------------
 bool getFirmwareVersion(void) {
-    uint16_t timeout = DEFAULT_CMD_TIMEOUT;
-    unsigned long previous;
-
     sendCommand(DISPLAY_FW_VERSION); // Send firmware version command
-    previous = millis();
-    while (millis() - previous < timeout) {
-        if (bleAvailable() > 0) {
-            if (readUntilCR() > 0) {
-                return true; // Version read successfully
-            }
-        }
-    }
-    return false; // Timeout
+    return readResponseLine(DEFAULT_CMD_TIMEOUT) > 0; // Version read successfully
 }
 
 // -----------------------------------------------------------------------------------
@@ -662,7 +1068,11 @@ bool getFirmwareVersion(void) {
 // -----------------------------------------------------------------------------------
 bool startScanning(void) {
     sendCommand(START_DEFAULT_SCAN); // Send scan command
-    return expectResponse(SCANNING_RESP, DEFAULT_CMD_TIMEOUT); // Check for scanning response
+    if (!expectResponse(SCANNING_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_RADIO(energyScanning, 0);
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -674,7 +1084,11 @@ bool startScanning(void) {
 // -----------------------------------------------------------------------------------
 bool startAdvertising(void) {
     sendCommand(START_DEFAULT_ADV); // Send advertising command
-    return expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT); // Check for AOK response
+    if (!expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT)) {
+        return false;
+    }
+    ENERGY_RADIO(energyAdvertising, ENERGY_DEFAULT_ADV_INTERVAL);
+    return true;
 }
 
 // -----------------------------------------------------------------------------------
@@ -683,152 +1097,33 @@ bool startAdvertising(void) {
 // Input : targetUuid - The UUID to match, targetProperty - The property to match
 // Output: uint16_t - The handle if found, 0 otherwise
 // Parses the LS command output to find a characteristic handle matching the specified UUID and property.
+// The listing is parsed as it streams in, and the timeout counts from the last byte
+// received, so listings of any length are handled.
 // -----------------------------------------------------------------------------------
 uint16_t parseLsCmd(const char* targetUuid, uint8_t targetProperty) {
-    uint8_t index = 0;
-    uint16_t timeout = DEFAULT_CMD_TIMEOUT;
+    lsParser_t parser;
     uint32_t start;
-    bool endReceived = false;
-    bool gotCarriageReturn = false;
-    uint16_t foundHandle = 0;
 
-    bleRxFlush(); // Clear receive buffer
     flush(); // Clear UART buffer
+    lsParserInit(&parser, targetUuid, targetProperty);
 
     start = millis();
-    while (millis() - start < timeout && !endReceived) {
+    while (!timeoutExpired(start, DEFAULT_CMD_TIMEOUT)) {
         if (bleAvailable()) {
-            char c = bleRead();
+            int c = bleRead();
             if (c != -1) {
-                if (c == '\r') {
-                    gotCarriageReturn = true;
-                } else if (c == '\n' && gotCarriageReturn) {
-                    uartBuffer[index] = '\0';
-                    if (index > 0) { // Process non-empty lines
-                        if (strstr(uartBuffer, targetUuid) != NULL) {
-                            char* firstComma = strchr(uartBuffer, ',');
-                            if (firstComma != NULL && firstComma[1] != '\0') {
-                                char handleStr[5] = {0};
-                                if (strlen(firstComma + 1) >= 4) {
-                                    strncpy(handleStr, firstComma + 1, 4);
-                                    handleStr[4] = '\0';
-                                    uint16_t handle = 0;
-                                    for (int i = 0; i < 4; i++) {
-                                        handle <<= 4;
-                                        if (handleStr[i] >= '0' && handleStr[i] <= '9') {
-                                            handle |= (handleStr[i] - '0');
-                                        } else if (handleStr[i] >= 'A' && handleStr[i] <= 'F') {
-                                            handle |= (handleStr[i] - 'A' + 10);
-                                        } else if (handleStr[i] >= 'a' && handleStr[i] <= 'f') {
-                                            handle |= (handleStr[i] - 'a' + 10);
-                                        } else {
-                                            handle = 0;
-                                            break;
-                                        }
-                                    }
-                                    char* secondComma = strchr(firstComma + 1, ',');
-                                    if (secondComma != NULL && secondComma[1] != '\0') {
-                                        char propertyStr[3] = {0};
-                                        if (strlen(secondComma + 1) >= 2) {
-                                            strncpy(propertyStr, secondComma + 1, 2);
-                                            propertyStr[2] = '\0';
-                                            uint8_t property = 0;
-                                            for (int i = 0; i < 2; i++) {
-                                                property <<= 4;
-                                                if (propertyStr[i] >= '0' && propertyStr[i] <= '9') {
-                                                    property |= (propertyStr[i] - '0');
-                                                } else if (propertyStr[i] >= 'A' && propertyStr[i] <= 'F') {
-                                                    property |= (propertyStr[i] - 'A' + 10);
-                                                } else if (propertyStr[i] >= 'a' && propertyStr[i] <= 'f') {
-                                                    property |= (propertyStr[i] - 'a' + 10);
-                                                } else {
-                                                    property = 0;
-                                                    break;
-                                                }
-                                            }
-                                            if (property == targetProperty) {
-                                                foundHandle = handle; // Store matching handle
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        if (strcmp(uartBuffer, "END") == 0) {
-                            endReceived = true; // End of LS command output
-                        }
-                    }
-                    flush(); // Clear buffer for next line
-                    index = 0;
-                    gotCarriageReturn = false;
-                } else {
-                    if (gotCarriageReturn) {
-                        if (index < sizeof(uartBuffer) - 1) {
-                            uartBuffer[index++] = '\r';
-                        }
-                        gotCarriageReturn = false;
-                    }
-                    if (index < sizeof(uartBuffer) - 1) {
-                        uartBuffer[index++] = c;
-                    }
+                start = millis(); // Listing still arriving
+                commandOutcome(true); // Listing started
+                if (lsParserFeed(&parser, (char)c)) {
+                    return parser.found; // End of LS command output
                 }
             }
         }
     }
 
-    if (index > 0 && !endReceived) { // Handle incomplete data
-        uartBuffer[index] = '\0';
-        if (strstr(uartBuffer, targetUuid) != NULL) {
-            char* firstComma = strchr(uartBuffer, ',');
-            if (firstComma != NULL && firstComma[1] != '\0') {
-                char handleStr[5] = {0};
-                if (strlen(firstComma + 1) >= 4) {
-                    strncpy(handleStr, firstComma + 1, 4);
-                    handleStr[4] = '\0';
-                    uint16_t handle = 0;
-                    for (int i = 0; i < 4; i++) {
-                        handle <<= 4;
-                        if (handleStr[i] >= '0' && handleStr[i] <= '9') {
-                            handle |= (handleStr[i] - '0');
-                        } else if (handleStr[i] >= 'A' && handleStr[i] <= 'F') {
-                            handle |= (handleStr[i] - 'A' + 10);
-                        } else if (handleStr[i] >= 'a' && handleStr[i] <= 'f') {
-                            handle |= (handleStr[i] - 'a' + 10);
-                        } else {
-                            handle = 0;
-                            break;
-                        }
-                    }
-                    char* secondComma = strchr(firstComma + 1, ',');
-                    if (secondComma != NULL && secondComma[1] != '\0') {
-                        char propertyStr[3] = {0};
-                        if (strlen(secondComma + 1) >= 2) {
-                            strncpy(propertyStr, secondComma + 1, 2);
-                            propertyStr[2] = '\0';
-                            uint8_t property = 0;
-                            for (int i = 0; i < 2; i++) {
-                                property <<= 4;
-                                if (propertyStr[i] >= '0' && propertyStr[i] <= '9') {
-                                    property |= (propertyStr[i] - '0');
-                                } else if (propertyStr[i] >= 'A' && propertyStr[i] <= 'F') {
-                                    property |= (propertyStr[i] - 'A' + 10);
-                                } else if (propertyStr[i] >= 'a' && propertyStr[i] <= 'f') {
-                                    property |= (propertyStr[i] - 'a' + 10);
-                                } else {
-                                    property = 0;
-                                    break;
-                                }
-                            }
-                            if (property == targetProperty) {
-                                foundHandle = handle;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return foundHandle;
+    commandOutcome(false); // Nothing arrived
+    lsParserFinish(&parser); // Handle incomplete data
+    return parser.found;
 }
 
 // -----------------------------------------------------------------------------------
@@ -841,7 +1136,6 @@ uint16_t parseLsCmd(const char* targetUuid, uint8_t targetProperty) {
 // -----------------------------------------------------------------------------------
 uint16_t findHandle(const char* targetUuid, uint8_t targetProperty) {
     sendCommand(LIST_SERVICES_AND_CHARS); // Send LS command
-    _delay_ms(15); // Wait for response
     uint16_t handle = parseLsCmd(targetUuid, targetProperty); // Parse output
     return handle > 0 ? handle : 0; // Return handle or 0 if not found
 }
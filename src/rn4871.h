@@ -15,25 +15,62 @@
 #include "wiring.h"
 #include "rn4871_const.h"
 
+// Bytes of the shared command and response buffer
+#ifndef DEFAULT_INPUT_BUFFER_SIZE
+#define DEFAULT_INPUT_BUFFER_SIZE 128
+#endif
+// Bytes kept of an event or unsolicited line
+#ifndef EVENT_LINE_SIZE
+#define EVENT_LINE_SIZE 48
+#endif
+
 typedef enum {
-    dataMode, // Transparent UART data mode
-    cmdMode   // Command mode for configuration
+    dataMode,   // Transparent UART data mode
+    cmdMode,    // Command mode for configuration
+    unknownMode // Not observed yet, e.g. after an MCU reset
 } operationMode_t;
 
+typedef enum {
+    moduleDataMode, // Was in data mode
+    moduleCmdMode,  // Was in command mode
+    moduleBooting,  // Was booting, e.g. after a hardware reset
+    moduleSilent    // Did not respond
+} moduleState_t;
+
+typedef struct {
+    uint16_t commands;     // Commands sent
+    uint16_t answered;     // Commands with a response line
+    uint16_t timeouts;     // Commands without a response in time
+    uint16_t overflows;    // Response and event bytes dropped from over-long lines
+    uint32_t latencyTotal; // Sum of the round trips of answered commands in ms
+    uint16_t latencyMax;   // Longest round trip in ms
+} commandStats_t;
+
 extern operationMode_t operationMode;
+extern char uartBuffer[DEFAULT_INPUT_BUFFER_SIZE];
+extern char deviceName[MAX_DEVICE_NAME_LEN];
+
+// Receives an event without % delimiters or an unsolicited line
+typedef void (*eventHandler_t)(const char* event);
 
 void hwInit(uint8_t rstPin, volatile uint8_t *ddr, volatile uint8_t *port);
+void setEventHandler(eventHandler_t handler);
 bool expectResponse(const char* expectedResponse, uint16_t timeout);
 void sendCommand(const char* command);
 void sendData(const char* data, uint16_t dataLen);
+const commandStats_t* getCommandStats(void);
+void commandOutcome(bool answered);
+void commandUncounted(void);
+void resetCommandStats(void);
 bool reboot(void);
 void setOperationMode(operationMode_t newMode);
 operationMode_t getOperationMode(void);
 void flush(void);
 bool swInit(void);
 void cleanInputBuffer(void);
-void enterDataMode(void);
+bool enterDataMode(void);
 bool enterCommandMode(void);
+moduleState_t probeModule(void);
 bool clearAllServices(void);
 bool stopAdvertising(void);
 bool clearPermanentAdvertising(void);
@@ -48,6 +85,9 @@ bool setServiceUUID(const char *uuid);
 bool setCharactUUID(const char *uuid, uint8_t property, uint8_t octetLen);
 bool startPermanentAdvertising(uint8_t adType, const char adData[]);
 bool startCustomAdvertising(uint16_t interval);
+bool setBeaconFeatures(const char* setting);
+bool startPermanentBeacon(uint8_t adType, const char adData[]);
+bool startImmediateBeacon(uint8_t adType, const char adData[]);
 const char* getDeviceName(void);
 uint16_t readUntilCR(char* buffer, uint16_t size, uint16_t start = 0);
 uint16_t readUntilCR(void);
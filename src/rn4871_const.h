@@ -21,7 +21,7 @@
 // ------------------- Commands -----------------------
 #define CMD_CHAR              '$'
 #define ENTER_CMD             "$$$"
-#define EXIT_CMD              "---\r"
+#define EXIT_CMD              "---"
 #define ENTER_DATA            (EXIT_CMD)
 #define DATA_LAST_CHAR        '\r'
 
@@ -50,6 +50,7 @@
 #define NO_DUPLICATE_SCAN_BMP 0x0400
 #define PASSIVE_SCAN_BMP      0x0200
 #define UART_TRANSP_NO_ACK_BMP 0x0100
+#define RUN_SCRIPT_AFTER_POWER_ON_BMP 0x0040
 #define MLDP_SUPPORT_BMP      0x0020
 
 #define SET_DEFAULT_SERVICES  "SS,"
@@ -128,6 +129,20 @@
 #define PRIVATE_SERVICE_LEN   32  // 128-bit
 #define PUBLIC_SERVICE_LEN    4   // 16-bit
 
+// --- Script Commands
+#define CLEAR_SCRIPT          "WC"
+#define STOP_SCRIPT           "WP"
+#define START_SCRIPT          "WR"
+#define ENTER_SCRIPT_INPUT    "WW"
+#define LIST_SCRIPT           "LW"
+#define SCRIPT_INPUT_END      0x1B  // ESC leaves script input mode
+#define SCRIPT_EVENT_POWER_ON "@PW_ON"
+#define SCRIPT_EVENT_TIMER1   "@TMR1"
+#define SCRIPT_EVENT_TIMER2   "@TMR2"
+#define SCRIPT_EVENT_TIMER3   "@TMR3"
+#define SCRIPT_EVENT_CONNECT  "@CONN"
+#define SCRIPT_EVENT_DISCONNECT "@DISCON"
+
 // --- Characteristic Access
 #define READ_REMOTE_CHARACT   "CHR,"
 #define WRITE_REMOTE_CHARACT  "CHW,"
@@ -152,6 +167,12 @@
 
 //-- Events
 #define REBOOT_EVENT          "%REBOOT%"
+// Event names as passed to the event handler, without % delimiters
+#define CONNECT_EVENT         "CONNECT"
+#define DISCONNECT_EVENT      "DISCONNECT"
+#define CCCD_WRITE_EVENT      "WC,"  // Client configuration written: handle, value
+#define VALUE_WRITE_EVENT     "WV,"  // Local characteristic written: handle, value
+#define CCCD_DISABLED         0x0000 // Notifications and indications off
 
 
 
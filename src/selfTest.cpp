@@ -0,0 +1,210 @@
+/*
+ * selfTest.cpp
+ *
+ * Created: 18-10-2026 06:50:55
+ * Author: Subrata
+ * Description: Implementation of the UART and command self-benchmark of the RN4871
+ *              BLE library. The loopback relies on the peer echoing data-mode bytes,
+ *              e.g. a central running a UART echo or the simulator with data echo
+ *              enabled; without an echo it ends after SELFTEST_LOOPBACK_IDLE and
+ *              reports zero received bytes.
+ */
+
+#include "selfTest.h"
+#include "bleSerial.h"
+#include "rn4871.h"
+#include "wiring.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint16_t bucketBounds[SELFTEST_LATENCY_BUCKETS - 1] = { 2, 5, 10, 20, 50, 100, 200 };
+
+// -----------------------------------------------------------------------------------
+// Loopback pattern procedure
+// -----------------------------------------------------------------------------------
+// Input : index - Byte position
+// Output: char - Expected byte at that position
+// Uppercase letters only, so the pattern never contains the $$$ escape or an event.
+// -----------------------------------------------------------------------------------
+static char loopbackPattern(uint16_t index) {
+    return (char)('A' + index % 26);
+}
+
+// -----------------------------------------------------------------------------------
+// Record latency procedure
+// -----------------------------------------------------------------------------------
+// Input : latency - Statistics, elapsed - Round trip in ms, ok - Command succeeded
+// Output: void
+// -----------------------------------------------------------------------------------
+static void recordLatency(selfTestLatency_t* latency, uint32_t elapsed, bool ok) {
+    uint16_t ms = elapsed > 0xFFFF ? 0xFFFF : (uint16_t)elapsed;
+    uint8_t bucket = 0;
+
+    if (!ok) {
+        latency->failures++;
+        return; // A timeout says nothing about the round trip
+    }
+    while (bucket < SELFTEST_LATENCY_BUCKETS - 1 && ms > bucketBounds[bucket]) {
+        bucket++;
+    }
+    latency->buckets[bucket]++;
+    latency->count++;
+    latency->total += ms;
+    if (latency->count == 1 || ms < latency->min) latency->min = ms;
+    if (ms > latency->max) latency->max = ms;
+}
+
+// -----------------------------------------------------------------------------------
+// Loopback procedure
+// -----------------------------------------------------------------------------------
+// Input : stats - Statistics, bytes - Number of bytes to send
+// Output: void
+// Sends the pattern in data mode and compares the echo byte by byte. At most
+// SELFTEST_LOOPBACK_WINDOW bytes are outstanding, so the echo never overruns the
+// receive buffer while bytes are still being queued.
+// -----------------------------------------------------------------------------------
+static void runLoopback(selfTestStats_t* stats, uint16_t bytes) {
+    uint16_t sent = 0;
+    uint16_t received = 0;
+
+    if (!enterDataMode()) {
+        return; // Nothing sent, the command rounds still run
+    }
+    uint32_t start = millis(); // After the mode switch, which is not data throughput
+    uint32_t lastRx = start;
+    while (received < bytes) {
+        if (sent < bytes && sent - received < SELFTEST_LOOPBACK_WINDOW) {
+            char c = loopbackPattern(sent);
+            sendData(&c, 1); // Stamps the guard time for the next $$$
+            sent++;
+        }
+
+        int c = bleRead();
+        if (c != -1) {
+            if ((char)c != loopbackPattern(received)) {
+                stats->loopbackErrors++;
+            }
+            received++;
+            lastRx = millis();
+        } else if (sent == bytes || sent - received >= SELFTEST_LOOPBACK_WINDOW) {
+            if (timeoutExpired(lastRx, SELFTEST_LOOPBACK_IDLE)) {
+                break; // Echo stopped or never started
+            }
+            bleAvailable(); // Nothing else to do until the echo arrives
+        }
+    }
+
+    stats->loopbackSent = sent;
+    stats->loopbackReceived = received;
+    stats->loopbackTime = received > 0 ? lastRx - start : 0;
+    if (stats->loopbackTime > 0) {
+        stats->throughput = (uint32_t)received * 1000UL / stats->loopbackTime;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Run self-benchmark procedure
+// -----------------------------------------------------------------------------------
+// Input : stats - Destination, handle - Local characteristic written by SHW,
+//         loopbackBytes - Bytes for the loopback, 0 to skip it, rounds - SHW and GK
+//         commands to time
+// Output: bool - True if the module was back in command mode for the command rounds
+// Resets the buffer statistics, runs the loopback in data mode, then times the
+// command rounds. The module is left in command mode.
+// -----------------------------------------------------------------------------------
+bool selfTestRun(selfTestStats_t* stats, uint16_t handle, uint16_t loopbackBytes, uint8_t rounds) {
+    char value[3];
+
+    memset(stats, 0, sizeof(*stats));
+    bleResetStats();
+
+    if (loopbackBytes > 0) {
+        runLoopback(stats, loopbackBytes);
+    }
+    if (!enterCommandMode()) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < rounds; i++) {
+        uint32_t start = millis();
+        snprintf(value, sizeof(value), "%02X", i); // Changing value, one byte
+        bool ok = writeLocalCharacteristic(handle, value);
+        recordLatency(&stats->shw, millis() - start, ok);
+
+        start = millis();
+        ok = getConnectionStatus() >= 0;
+        recordLatency(&stats->gk, millis() - start, ok);
+    }
+
+#if defined(__AVR__)
+    uint8_t oldSREG = SREG;
+    cli(); // Receive interrupt updates the statistics
+#endif
+    stats->rxHighWater = ble.rxHighWater;
+    stats->txHighWater = ble.txHighWater;
+    stats->rxOverruns = ble.rxOverruns;
+#if defined(__AVR__)
+    SREG = oldSREG;
+#endif
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Advance length procedure
+// -----------------------------------------------------------------------------------
+// Input : size - Buffer size, used - Characters written so far,
+//         written - Return value of the snprintf call that appended
+// Output: uint16_t - New length, clamped to the buffer
+// -----------------------------------------------------------------------------------
+static uint16_t advance(uint16_t size, uint16_t used, int written) {
+    if (written < 0) return used;
+    return used + (uint16_t)written >= size ? size - 1 : used + (uint16_t)written;
+}
+
+// -----------------------------------------------------------------------------------
+// Format latency procedure
+// -----------------------------------------------------------------------------------
+// Input : name - Command name, latency - Statistics, text - Buffer, size - Buffer size,
+//         used - Characters written so far
+// Output: uint16_t - New length
+// -----------------------------------------------------------------------------------
+static uint16_t formatLatency(const char* name, const selfTestLatency_t* latency,
+                              char* text, uint16_t size, uint16_t used) {
+    uint32_t average = latency->count > 0 ? latency->total / latency->count : 0;
+
+    used = advance(size, used, snprintf(&text[used], size - used, "%s n=%u fail=%u min=%u avg=%lu max=%u ms |",
+                                        name, latency->count, latency->failures, latency->min,
+                                        (unsigned long)average, latency->max));
+    for (uint8_t i = 0; i < SELFTEST_LATENCY_BUCKETS; i++) {
+        if (i < SELFTEST_LATENCY_BUCKETS - 1) {
+            used = advance(size, used, snprintf(&text[used], size - used, " <=%u:%u", bucketBounds[i], latency->buckets[i]));
+        } else {
+            used = advance(size, used, snprintf(&text[used], size - used, " >%u:%u\r\n",
+                                                bucketBounds[i - 1], latency->buckets[i]));
+        }
+    }
+    return used;
+}
+
+// -----------------------------------------------------------------------------------
+// Format statistics procedure
+// -----------------------------------------------------------------------------------
+// Input : stats - Results of selfTestRun, text - Buffer, size - Buffer size
+// Output: uint16_t - Length of the text, truncated to the buffer
+// Formats the results as CR+LF terminated lines for a debug port. About 256 bytes
+// hold the complete report.
+// -----------------------------------------------------------------------------------
+uint16_t selfTestFormat(const selfTestStats_t* stats, char* text, uint16_t size) {
+    uint16_t used = 0;
+
+    if (size == 0) return 0;
+    text[0] = '\0';
+    used = advance(size, used, snprintf(text, size, "loopback sent=%u echoed=%u errors=%u time=%lu ms rate=%lu B/s\r\n",
+                                        stats->loopbackSent, stats->loopbackReceived, stats->loopbackErrors,
+                                        (unsigned long)stats->loopbackTime, (unsigned long)stats->throughput));
+    used = formatLatency("SHW", &stats->shw, text, size, used);
+    used = formatLatency("GK", &stats->gk, text, size, used);
+    used = advance(size, used, snprintf(&text[used], size - used, "ring rx=%u tx=%u overruns=%u\r\n",
+                                        stats->rxHighWater, stats->txHighWater, stats->rxOverruns));
+    return used;
+}
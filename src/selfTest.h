@@ -0,0 +1,51 @@
+/*
+ * selfTest.h
+ *
+ * Created: 18-10-2026 06:49:38
+ * Author: Subrata
+ * Description: Header file for the UART and command self-benchmark of the RN4871 BLE
+ *              library. Measures the data-mode loopback throughput, the round-trip
+ *              latency of SHW and GK commands and the ring buffer high-water marks,
+ *              and collects the results in one statistics structure that can be
+ *              logged on a debug port or published in a characteristic.
+ */
+
+#ifndef SELFTEST_H_
+#define SELFTEST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Latency histogram buckets, upper bounds 2, 5, 10, 20, 50, 100, 200 ms and overflow
+#define SELFTEST_LATENCY_BUCKETS 8
+// Loopback bytes sent ahead of the echo, stays well below BLE_BUFFER_SIZE
+#define SELFTEST_LOOPBACK_WINDOW 16
+// Loopback ends after this many ms without an echoed byte
+#define SELFTEST_LOOPBACK_IDLE   100
+
+typedef struct {
+    uint16_t count;                              // Commands timed
+    uint16_t failures;                           // Commands without the expected answer
+    uint16_t min;                                // Fastest round trip in ms
+    uint16_t max;                                // Slowest round trip in ms
+    uint32_t total;                              // Sum of all round trips in ms
+    uint16_t buckets[SELFTEST_LATENCY_BUCKETS];  // Round trips per histogram bucket
+} selfTestLatency_t;
+
+typedef struct {
+    uint16_t loopbackSent;      // Bytes sent in data mode
+    uint16_t loopbackReceived;  // Bytes echoed back
+    uint16_t loopbackErrors;    // Echoed bytes that did not match
+    uint32_t loopbackTime;      // ms from the first byte sent to the last byte echoed
+    uint32_t throughput;        // Echoed bytes per second
+    selfTestLatency_t shw;      // SHW round trips
+    selfTestLatency_t gk;       // GK round trips
+    uint8_t rxHighWater;        // Most bytes waiting in the receive buffer
+    uint8_t txHighWater;        // Most bytes waiting in the transmit buffer
+    uint16_t rxOverruns;        // Bytes lost on receive buffer overflow
+} selfTestStats_t;
+
+bool selfTestRun(selfTestStats_t* stats, uint16_t handle, uint16_t loopbackBytes, uint8_t rounds);
+uint16_t selfTestFormat(const selfTestStats_t* stats, char* text, uint16_t size);
+
+#endif /* SELFTEST_H_ */
@@ -0,0 +1,283 @@
+/*
+ * sensorBridge.cpp
+ *
+ * Created: 18-10-2026 07:11:02
+ * Author: Subrata
+ * Description: Implementation of the sensor-to-characteristic bridge for the
+ *              RN4871 BLE module. bridgeTask first samples every row that is due,
+ *              which is fast, and then writes the updates that the row policies
+ *              call for with SHW, at most BRIDGE_BATCH_SIZE per call. The RN4871
+ *              has no command that writes several handles, so a batch is a run of
+ *              SHW commands in one pass; the write pass starts one row further
+ *              each time, so no row waits behind the others for long. Connection
+ *              and subscription changes arrive as events and only set flags.
+ */
+
+#include "sensorBridge.h"
+#include "rn4871.h"
+#include "crc16.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+sensorBridge_t sensorBridge;
+
+// -----------------------------------------------------------------------------------
+// Encoding size procedure
+// -----------------------------------------------------------------------------------
+// Input : encoding - Value encoding
+// Output: uint8_t - Bytes the encoded value occupies in the characteristic
+// -----------------------------------------------------------------------------------
+uint8_t bridgeOctets(bridgeEncoding_t encoding) {
+    switch (encoding) {
+        case bridgeUint8:    return 1;
+        case bridgeUint32Le: return 4;
+        default:             return 2;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Encode sample procedure
+// -----------------------------------------------------------------------------------
+// Input : encoding - Value encoding, sample - Raw sample
+// Output: uint32_t - Sample saturated to the range of the encoding
+// -----------------------------------------------------------------------------------
+static uint32_t encodeSample(bridgeEncoding_t encoding, int32_t sample) {
+    switch (encoding) {
+        case bridgeUint8:
+            return sample < 0 ? 0 : (sample > 0xFF ? 0xFF : (uint32_t)sample);
+        case bridgeInt16Le:
+            if (sample < -32768L) sample = -32768L;
+            if (sample > 32767L) sample = 32767L;
+            return (uint16_t)(int16_t)sample; // Two's complement bit pattern
+        case bridgeUint32Le:
+            return sample < 0 ? 0 : (uint32_t)sample;
+        default:
+            return sample < 0 ? 0 : (sample > 0xFFFF ? 0xFFFF : (uint32_t)sample);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Format value procedure
+// -----------------------------------------------------------------------------------
+// Input : encoding - Value encoding, value - Encoded value, hex - Destination of at
+//         least 9 characters
+// Output: void
+// Writes the value bytes in characteristic order as hex digits for SHW.
+// -----------------------------------------------------------------------------------
+static void formatValue(bridgeEncoding_t encoding, uint32_t value, char* hex) {
+    uint8_t octets = bridgeOctets(encoding);
+
+    for (uint8_t i = 0; i < octets; i++) {
+        uint8_t shift = (encoding == bridgeUint16Be) ? 8 * (octets - 1 - i) : 8 * i;
+        snprintf(&hex[2 * i], 3, "%02X", (uint8_t)(value >> shift));
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Define characteristics procedure
+// -----------------------------------------------------------------------------------
+// Input : rows - Row table, count - Rows in the table
+// Output: bool - True if every characteristic was accepted
+// Adds one characteristic per row, sized for its encoding, to the service defined
+// last. Call while the module is configured, after setServiceUUID.
+// -----------------------------------------------------------------------------------
+bool bridgeDefine(const bridgeRow_t* rows, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!setCharactUUID(rows[i].uuid, rows[i].property, bridgeOctets(rows[i].encoding))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Table fingerprint procedure
+// -----------------------------------------------------------------------------------
+// Input : crc - Running fingerprint, rows - Row table, count - Rows in the table
+// Output: uint16_t - Fingerprint extended by everything bridgeDefine configures
+// -----------------------------------------------------------------------------------
+uint16_t bridgeFingerprint(uint16_t crc, const bridgeRow_t* rows, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        crc = crc16String(crc, rows[i].uuid);
+        crc = crc16Update(crc, rows[i].property);
+        crc = crc16Update(crc, bridgeOctets(rows[i].encoding));
+    }
+    return crc;
+}
+
+// -----------------------------------------------------------------------------------
+// Bridge initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : rows - Row table, states - Run state, one entry per row, both kept by
+//         reference, count - Rows in the table
+// Output: bool - True if the handle of every row was found, false otherwise
+// Looks up the handles, takes the connection state from the module and makes every
+// row due at once. Rows without a handle are skipped by bridgeTask. The module must
+// be in command mode.
+// -----------------------------------------------------------------------------------
+bool bridgeInit(const bridgeRow_t* rows, bridgeState_t* states, uint8_t count) {
+    bool found = true;
+    uint32_t now = millis();
+
+    memset(&sensorBridge, 0, sizeof(sensorBridge));
+    memset(states, 0, count * sizeof(bridgeState_t));
+    sensorBridge.rows = rows;
+    sensorBridge.state = states;
+    sensorBridge.count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        bridgeState_t* state = &states[i];
+        state->handle = findHandle(rows[i].uuid, rows[i].property);
+        state->lastSample = now - rows[i].period; // Due at once
+        found = found && state->handle != 0;
+    }
+    sensorBridge.connected = getConnectionStatus() == 1;
+    return found;
+}
+
+// -----------------------------------------------------------------------------------
+// Handle event procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters, as passed to the event handler
+// Output: bool - True if the event concerned a bridge row
+// Call from the application's event handler. A new connection or subscription makes
+// the current value go out with the next sample, whatever the policy. Sends nothing
+// itself.
+// -----------------------------------------------------------------------------------
+bool bridgeHandleEvent(const char* event) {
+    bool connect = strncmp(event, CONNECT_EVENT, sizeof(CONNECT_EVENT) - 1) == 0;
+
+    if (connect || strncmp(event, DISCONNECT_EVENT, sizeof(DISCONNECT_EVENT) - 1) == 0) {
+        uint32_t now = millis();
+        sensorBridge.connected = connect;
+        for (uint8_t i = 0; i < sensorBridge.count; i++) {
+            bridgeState_t* state = &sensorBridge.state[i];
+            state->written = false; // The new client has seen nothing
+            state->pending = false;
+            state->subscribed = false; // Subscriptions end with the connection
+            state->lastSample = now - sensorBridge.rows[i].period; // Sample at once
+        }
+        return false;
+    }
+    if (strncmp(event, CCCD_WRITE_EVENT, sizeof(CCCD_WRITE_EVENT) - 1) != 0) {
+        return false;
+    }
+
+    char* next;
+    uint16_t handle = (uint16_t)strtoul(event + sizeof(CCCD_WRITE_EVENT) - 1, &next, 16);
+    if (*next != ',') {
+        return false;
+    }
+    for (uint8_t i = 0; i < sensorBridge.count; i++) {
+        bridgeState_t* state = &sensorBridge.state[i];
+        if (state->handle != 0 && handle == state->handle + 1) { // Descriptor follows the value
+            state->subscribed = strtoul(next + 1, NULL, 16) != CCCD_DISABLED;
+            state->written = false;
+            state->pending = false;
+            state->lastSample = millis() - sensorBridge.rows[i].period; // Sample at once
+            return true;
+        }
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Sample row procedure
+// -----------------------------------------------------------------------------------
+// Input : row - Table row, state - Its run state
+// Output: void
+// Takes a sample and decides by the row's policy whether it has to be written.
+// -----------------------------------------------------------------------------------
+static void sampleRow(const bridgeRow_t* row, bridgeState_t* state) {
+    int32_t sample = 0;
+
+    if (row->source == bridgeAdc) {
+        sample = analogRead(row->channel);
+    } else if (row->read != NULL) {
+        sample = row->read(row->channel);
+    }
+    sensorBridge.samples++;
+    state->value = encodeSample(row->encoding, sample);
+
+    bool wanted = sensorBridge.connected && (row->policy != bridgeNotify || state->subscribed);
+    bool changed = !state->written || state->value != state->sent;
+    state->pending = wanted && (row->policy == bridgePeriodic || changed);
+}
+
+// -----------------------------------------------------------------------------------
+// Bridge task procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Call from the main loop while the module is in command mode. Samples the rows that
+// are due and writes up to BRIDGE_BATCH_SIZE pending values. A refused write stays
+// pending and is retried on the next call.
+// -----------------------------------------------------------------------------------
+void bridgeTask(void) {
+    uint32_t now = millis();
+    uint8_t count = sensorBridge.count;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const bridgeRow_t* row = &sensorBridge.rows[i];
+        bridgeState_t* state = &sensorBridge.state[i];
+        if (state->handle == 0 || !timeoutExpired(state->lastSample, row->period)) {
+            continue;
+        }
+        state->lastSample += row->period;
+        if (timeoutExpired(state->lastSample, row->period)) {
+            state->lastSample = now; // Fell behind, do not catch up with a burst
+        }
+        sampleRow(row, state);
+    }
+
+    uint8_t batch = 0;
+    for (uint8_t n = 0; n < count && batch < BRIDGE_BATCH_SIZE; n++) {
+        uint8_t i = (sensorBridge.cursor + n) % count;
+        bridgeState_t* state = &sensorBridge.state[i];
+        if (!state->pending) {
+            continue;
+        }
+        char hex[9];
+        formatValue(sensorBridge.rows[i].encoding, state->value, hex);
+        batch++;
+        if (writeLocalCharacteristic(state->handle, hex)) {
+            state->sent = state->value;
+            state->written = true;
+            state->pending = false;
+            sensorBridge.writes++;
+        } else {
+            sensorBridge.failures++;
+        }
+    }
+    if (count > 0) {
+        sensorBridge.cursor = (sensorBridge.cursor + 1) % count;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Time to due procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint32_t - Time in ms until bridgeTask has work, 0 if it has some now
+// Lets the main loop sleep between samples.
+// -----------------------------------------------------------------------------------
+uint32_t bridgeTimeToDue(void) {
+    uint32_t now = millis();
+    uint32_t wait = 0xFFFFFFFFUL;
+
+    for (uint8_t i = 0; i < sensorBridge.count; i++) {
+        const bridgeState_t* state = &sensorBridge.state[i];
+        if (state->handle == 0) {
+            continue;
+        }
+        uint32_t elapsed = now - state->lastSample;
+        uint16_t period = sensorBridge.rows[i].period;
+        if (state->pending || elapsed >= period) {
+            return 0;
+        }
+        if (period - elapsed < wait) {
+            wait = period - elapsed;
+        }
+    }
+    return wait;
+}
@@ -0,0 +1,91 @@
+/*
+ * sensorBridge.h
+ *
+ * Created: 18-10-2026 07:10:02
+ * Author: Subrata
+ * Description: Header file for the sensor-to-characteristic bridge of the RN4871
+ *              BLE library. A table of rows, one per sensor, gives the sample
+ *              source (ADC channel or callback), the sampling period, the value
+ *              encoding, the target characteristic and the update policy. One task
+ *              samples every row that is due and writes the resulting updates in a
+ *              single pass from the main loop, so a new sensor costs a table row
+ *              rather than more blocking calls. The application supplies the run
+ *              state array next to the table, so SRAM is only spent on its rows.
+ */
+
+#ifndef SENSORBRIDGE_H_
+#define SENSORBRIDGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Characteristic writes per bridgeTask call, further updates wait for the next call
+#ifndef BRIDGE_BATCH_SIZE
+#define BRIDGE_BATCH_SIZE 4
+#endif
+
+// Sample callback, receives the row's channel
+typedef int32_t (*bridgeRead_t)(uint8_t channel);
+
+typedef enum {
+    bridgeAdc,     // analogRead of the row's channel
+    bridgeCallback // Row's callback
+} bridgeSource_t;
+
+typedef enum {
+    bridgeUint8,    // 1 byte
+    bridgeUint16Be, // 2 bytes, most significant first
+    bridgeUint16Le, // 2 bytes, least significant first
+    bridgeInt16Le,  // 2 bytes two's complement, least significant first
+    bridgeUint32Le  // 4 bytes, least significant first
+} bridgeEncoding_t;
+
+typedef enum {
+    bridgePeriodic, // Written every period while connected
+    bridgeOnChange, // Written while connected when the encoded value changed
+    bridgeNotify    // Written on change while the client has notifications enabled
+} bridgePolicy_t;
+
+typedef struct {
+    bridgeSource_t source;     // Where the sample comes from
+    uint8_t channel;           // ADC channel, or argument of the callback
+    bridgeRead_t read;         // Callback for bridgeCallback, NULL otherwise
+    uint16_t period;           // Sampling period in ms
+    bridgeEncoding_t encoding; // Value format in the characteristic
+    const char* uuid;          // Target characteristic UUID
+    uint8_t property;          // Its property bitmap, the handle is looked up by both
+    bridgePolicy_t policy;     // When the value is written
+} bridgeRow_t;
+
+typedef struct {
+    uint16_t handle;     // Value handle, 0 if not found
+    uint32_t lastSample; // millis() the current period started
+    uint32_t value;      // Encoded value of the last sample
+    uint32_t sent;       // Encoded value last written
+    bool written;        // sent is valid
+    bool pending;        // value waits to be written
+    bool subscribed;     // Client enabled notifications
+} bridgeState_t;
+
+typedef struct {
+    const bridgeRow_t* rows; // Row table
+    bridgeState_t* state;    // Run state per row, supplied with the table
+    uint8_t count;           // Rows in the table
+    bool connected;          // A central is connected
+    uint8_t cursor;          // Row the next write pass starts at
+    uint32_t samples;        // Samples taken
+    uint32_t writes;         // Characteristic writes accepted
+    uint32_t failures;       // Characteristic writes refused, retried later
+} sensorBridge_t;
+
+extern sensorBridge_t sensorBridge;
+
+uint8_t bridgeOctets(bridgeEncoding_t encoding);
+bool bridgeDefine(const bridgeRow_t* rows, uint8_t count);
+uint16_t bridgeFingerprint(uint16_t crc, const bridgeRow_t* rows, uint8_t count);
+bool bridgeInit(const bridgeRow_t* rows, bridgeState_t* states, uint8_t count);
+bool bridgeHandleEvent(const char* event);
+void bridgeTask(void);
+uint32_t bridgeTimeToDue(void);
+
+#endif /* SENSORBRIDGE_H_ */
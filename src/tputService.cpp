@@ -0,0 +1,302 @@
+/*
+ * tputService.cpp
+ *
+ * Created: 18-10-2026 06:57:56
+ * Author: Subrata
+ * Description: Implementation of the throughput test service for the RN4871 BLE
+ *              module. Control writes arrive as %WV% events and only record the
+ *              request; tputTask runs the stream from the main loop. A notification
+ *              the module refuses is a flow-control event and is written again after
+ *              a short pause, so every sequence number reaches the central once.
+ */
+
+#include "tputService.h"
+#include "rn4871.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Consecutive refused payloads after which a run is abandoned
+#define TPUT_MAX_RETRIES 20
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+tputService_t tputService = { 0, 0, false, tputIdle, tputIdle, 0, 0, 0, {} };
+
+// -----------------------------------------------------------------------------------
+// Encode bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : bytes - Data, length - Byte count, hex - Destination of length * 2 + 1 chars
+// Output: void
+// -----------------------------------------------------------------------------------
+static void encodeHex(const uint8_t* bytes, uint8_t length, char* hex) {
+    for (uint8_t i = 0; i < length; i++) {
+        hex[i * 2] = hexDigits[bytes[i] >> 4];
+        hex[i * 2 + 1] = hexDigits[bytes[i] & 0x0F];
+    }
+    hex[length * 2] = '\0';
+}
+
+// -----------------------------------------------------------------------------------
+// Decode byte procedure
+// -----------------------------------------------------------------------------------
+// Input : hex - Two hex digits, or fewer at the end of the value
+// Output: uint8_t - Decoded byte, 0 if the value ended
+// -----------------------------------------------------------------------------------
+static uint8_t decodeByte(const char* hex) {
+    char pair[3] = { hex[0], hex[0] != '\0' ? hex[1] : '\0', '\0' };
+    return (uint8_t)strtoul(pair, NULL, 16);
+}
+
+// -----------------------------------------------------------------------------------
+// Define throughput service procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if the service and both characteristics were accepted
+// Adds the service while the module is configured; it takes effect after the next
+// reboot. Include TPUT_SERVICE_UUID in the application's configuration fingerprint.
+// -----------------------------------------------------------------------------------
+bool tputDefine(void) {
+    return setServiceUUID(TPUT_SERVICE_UUID) &&
+           setCharactUUID(TPUT_CONTROL_UUID, TPUT_CONTROL_PROPERTY, TPUT_CONTROL_SIZE) &&
+           setCharactUUID(TPUT_DATA_UUID, TPUT_DATA_PROPERTY, TPUT_PAYLOAD_SIZE);
+}
+
+// -----------------------------------------------------------------------------------
+// Throughput service initialization procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if both characteristics were found, false otherwise
+// Looks up the handles and resets the service. The module must be in command mode.
+// -----------------------------------------------------------------------------------
+bool tputInit(void) {
+    tputService.controlHandle = findHandle(TPUT_CONTROL_UUID, TPUT_CONTROL_PROPERTY);
+    tputService.dataHandle = findHandle(TPUT_DATA_UUID, TPUT_DATA_PROPERTY);
+    tputService.subscribed = false;
+    tputService.request = tputIdle;
+    tputService.mode = tputIdle;
+    return tputService.controlHandle != 0 && tputService.dataHandle != 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Handle event procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters, as passed to the event handler
+// Output: bool - True if the event concerned the throughput service
+// Call from the application's event handler. Tracks the data subscription and
+// records start and stop requests written to the control characteristic. Also
+// called while a run is streaming, so a stop takes effect after the current payload.
+// -----------------------------------------------------------------------------------
+bool tputHandleEvent(const char* event) {
+    if (strncmp(event, DISCONNECT_EVENT, sizeof(DISCONNECT_EVENT) - 1) == 0) {
+        tputService.subscribed = false;
+        tputService.request = tputIdle; // A run ends with the connection
+        return false;
+    }
+    if (tputService.controlHandle == 0) {
+        return false;
+    }
+
+    char* next;
+    if (strncmp(event, CCCD_WRITE_EVENT, sizeof(CCCD_WRITE_EVENT) - 1) == 0) {
+        uint16_t handle = (uint16_t)strtoul(event + sizeof(CCCD_WRITE_EVENT) - 1, &next, 16);
+        if (handle != tputService.dataHandle + 1 || *next != ',') {
+            return false;
+        }
+        tputService.subscribed = strtoul(next + 1, NULL, 16) != CCCD_DISABLED;
+        return true;
+    }
+    if (strncmp(event, VALUE_WRITE_EVENT, sizeof(VALUE_WRITE_EVENT) - 1) == 0) {
+        uint16_t handle = (uint16_t)strtoul(event + sizeof(VALUE_WRITE_EVENT) - 1, &next, 16);
+        if (handle != tputService.controlHandle || *next != ',') {
+            return false;
+        }
+        const char* value = next + 1;
+        uint8_t op = decodeByte(value);
+        uint16_t count = 0;
+        uint8_t gap = 0;
+        if (strlen(value) >= 6) {
+            count = decodeByte(value + 2) | (uint16_t)decodeByte(value + 4) << 8;
+        }
+        if (strlen(value) >= 8) {
+            gap = decodeByte(value + 6);
+        }
+        if (op == TPUT_OP_NOTIFY) {
+            tputStart(tputNotify, count, gap);
+        } else if (op == TPUT_OP_UART) {
+            tputStart(tputUart, count, gap);
+        } else {
+            tputService.request = tputIdle; // TPUT_OP_STOP and unknown opcodes
+        }
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------------
+// Start run procedure
+// -----------------------------------------------------------------------------------
+// Input : mode - Payload path, count - Payloads, 0 = until stopped, gap - Pause
+//         between payloads in ms
+// Output: void
+// Requests a run as the control characteristic does, e.g. to benchmark without a
+// phone app. A transparent UART run cannot be stopped and always has a count.
+// -----------------------------------------------------------------------------------
+void tputStart(tputMode_t mode, uint16_t count, uint8_t gap) {
+    if (mode == tputUart && count == 0) {
+        count = TPUT_UART_DEFAULT;
+    }
+    tputService.request = mode;
+    tputService.count = count;
+    tputService.gap = gap;
+}
+
+// -----------------------------------------------------------------------------------
+// Payload written procedure
+// -----------------------------------------------------------------------------------
+// Input : start - millis() at the start of the run, writeStart - millis() before the
+//         payload was written
+// Output: void
+// -----------------------------------------------------------------------------------
+static void payloadWritten(uint32_t start, uint32_t writeStart) {
+    uint32_t now = millis();
+
+    if (now - writeStart > TPUT_STALL_TIME) {
+        tputService.report.stalls++;
+    }
+    tputService.report.payloads++;
+    tputService.report.bytes += TPUT_PAYLOAD_SIZE;
+    tputService.report.time = now - start;
+    tputService.sequence++;
+    if (tputService.gap > 0) {
+        delay(tputService.gap);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// More payloads procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True while the requested number of payloads is not reached
+// -----------------------------------------------------------------------------------
+static bool morePayloads(void) {
+    return tputService.count == 0 || tputService.report.payloads < tputService.count;
+}
+
+// -----------------------------------------------------------------------------------
+// Notification run procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Writes each payload with SHW; the module notifies the subscribed client. Payload
+// bytes are the little-endian sequence number followed by a counting pattern.
+// Events, including a stop request, are handled while each command is sent.
+// -----------------------------------------------------------------------------------
+static void runNotify(void) {
+    uint8_t payload[TPUT_PAYLOAD_SIZE];
+    char hex[TPUT_PAYLOAD_SIZE * 2 + 1];
+    uint32_t start = millis();
+    uint8_t retries = 0;
+
+    while (tputService.request == tputNotify && tputService.subscribed && morePayloads()) {
+        uint16_t sequence = tputService.sequence;
+        payload[0] = (uint8_t)sequence;
+        payload[1] = (uint8_t)(sequence >> 8);
+        for (uint8_t i = 2; i < TPUT_PAYLOAD_SIZE; i++) {
+            payload[i] = (uint8_t)(sequence + i);
+        }
+        encodeHex(payload, TPUT_PAYLOAD_SIZE, hex);
+
+        uint32_t writeStart = millis();
+        if (!writeLocalCharacteristic(tputService.dataHandle, hex)) {
+            tputService.report.flowEvents++; // Module queue full, or no answer
+            if (++retries >= TPUT_MAX_RETRIES) {
+                break; // Link is gone
+            }
+            delay(TPUT_RETRY_DELAY);
+            continue;
+        }
+        retries = 0;
+        payloadWritten(start, writeStart);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Transparent UART run procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Streams text payloads in data mode: four hex digits of the sequence number, a
+// letter pattern and a line feed, so the stream never contains $$$ or an event
+// delimiter. A payload that does not fit the transmit buffer is a flow-control event.
+// -----------------------------------------------------------------------------------
+static void runUart(void) {
+    char payload[TPUT_PAYLOAD_SIZE];
+    uint32_t start = millis();
+
+    if (!enterDataMode()) {
+        enterCommandMode(); // Mode is unknown, probe it
+        return;
+    }
+    while (morePayloads()) {
+        uint16_t sequence = tputService.sequence;
+        for (uint8_t i = 0; i < 4; i++) {
+            payload[i] = hexDigits[(sequence >> (12 - 4 * i)) & 0x0F];
+        }
+        for (uint8_t i = 4; i < TPUT_PAYLOAD_SIZE - 1; i++) {
+            payload[i] = (char)('a' + (sequence + i) % 26);
+        }
+        payload[TPUT_PAYLOAD_SIZE - 1] = '\n';
+
+        uint32_t writeStart = millis();
+        if (BLE_BUFFER_SIZE - 1 - RingBuffer_available(&ble.tx_buffer) < TPUT_PAYLOAD_SIZE) {
+            tputService.report.flowEvents++; // Has to wait for the UART
+        }
+        sendData(payload, TPUT_PAYLOAD_SIZE);
+        payloadWritten(start, writeStart);
+    }
+    bleTxWait();
+    tputService.report.time = millis() - start;
+    enterCommandMode();
+}
+
+// -----------------------------------------------------------------------------------
+// Throughput task procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Call periodically from the main loop in command mode. Runs a requested stream to
+// its end, which blocks the loop for the duration of the run, then stores the
+// report in the control characteristic for the central to read.
+// -----------------------------------------------------------------------------------
+void tputTask(void) {
+    if (tputService.controlHandle == 0 || tputService.request == tputIdle) return;
+
+    uint8_t bytes[15];
+    char hex[sizeof(bytes) * 2 + 1];
+
+    memset(&tputService.report, 0, sizeof(tputService.report));
+    tputService.mode = tputService.request;
+    tputService.report.mode = (uint8_t)tputService.mode;
+    tputService.sequence = 0;
+    if (tputService.mode == tputNotify) {
+        runNotify();
+    } else {
+        runUart();
+    }
+    tputService.mode = tputIdle;
+    tputService.request = tputIdle;
+
+    const tputReport_t* report = &tputService.report;
+    const uint32_t fields[] = { report->bytes, report->payloads, report->stalls,
+                                report->flowEvents, report->time };
+    const uint8_t widths[] = { 4, 2, 2, 2, 4 };
+    uint8_t n = 0;
+    for (uint8_t f = 0; f < sizeof(widths); f++) {
+        for (uint8_t i = 0; i < widths[f]; i++) {
+            bytes[n++] = (uint8_t)(fields[f] >> (8 * i));
+        }
+    }
+    bytes[n++] = report->mode;
+    encodeHex(bytes, n, hex);
+    writeLocalCharacteristic(tputService.controlHandle, hex);
+}
@@ -0,0 +1,80 @@
+/*
+ * tputService.h
+ *
+ * Created: 18-10-2026 06:57:05
+ * Author: Subrata
+ * Description: Header file for the throughput test service of the RN4871 BLE
+ *              library. A central starts a run by writing the control
+ *              characteristic; the MCU then streams sequence-numbered payloads as
+ *              fast as the notification or transparent UART path accepts them and
+ *              stores a report of bytes sent, stalls and flow-control events in the
+ *              control characteristic. Serves as the reference benchmark for UART,
+ *              connection interval and phone-side tuning.
+ */
+
+#ifndef TPUTSERVICE_H_
+#define TPUTSERVICE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rn4871_const.h"
+
+// Throughput service, control and data characteristics, 128-bit private UUIDs
+#define TPUT_SERVICE_UUID     "D1A60100B5A311EE8C900242AC120002"
+#define TPUT_CONTROL_UUID     "D1A60101B5A311EE8C900242AC120002"
+#define TPUT_DATA_UUID        "D1A60102B5A311EE8C900242AC120002"
+#define TPUT_CONTROL_PROPERTY (READ_PROPERTY | WRITE_PROPERTY)
+#define TPUT_DATA_PROPERTY    NOTIFY_PROPERTY
+// Control value: opcode, payload count (little-endian, 0 = until stopped) and gap in ms
+#define TPUT_CONTROL_SIZE     16
+// Payload size, a single packet at the default MTU
+#define TPUT_PAYLOAD_SIZE     20
+// Payloads of a transparent UART run started without a count
+#define TPUT_UART_DEFAULT     100
+// Payload write slower than this many ms counts as a stall
+#define TPUT_STALL_TIME       50
+// Wait in ms before a refused notification is written again
+#define TPUT_RETRY_DELAY      5
+
+// Opcodes of the control characteristic
+#define TPUT_OP_STOP          0x00
+#define TPUT_OP_NOTIFY        0x01
+#define TPUT_OP_UART          0x02
+
+typedef enum {
+    tputIdle,   // No run active
+    tputNotify, // Payloads as notifications of the data characteristic
+    tputUart    // Payloads through the transparent UART service in data mode
+} tputMode_t;
+
+// Report fields, stored little-endian in the control characteristic in this order
+typedef struct {
+    uint32_t bytes;      // Payload bytes accepted by the module
+    uint16_t payloads;   // Payloads sent
+    uint16_t stalls;     // Payload writes slower than TPUT_STALL_TIME
+    uint16_t flowEvents; // Notifications refused or UART writes that found the buffer full
+    uint32_t time;       // ms from the start of the run to the last payload
+    uint8_t mode;        // tputMode_t of the run
+} tputReport_t;
+
+typedef struct {
+    uint16_t controlHandle; // Control value handle, 0 if the service is not defined
+    uint16_t dataHandle;    // Data value handle
+    bool subscribed;        // Client enabled notifications of the data characteristic
+    tputMode_t request;     // Run requested by the central, tputIdle to stop
+    tputMode_t mode;        // Run in progress
+    uint16_t count;         // Payloads requested, 0 = until stopped
+    uint8_t gap;            // Pause between payloads in ms
+    uint16_t sequence;      // Sequence number of the next payload
+    tputReport_t report;    // Figures of the current or last run
+} tputService_t;
+
+extern tputService_t tputService;
+
+bool tputDefine(void);
+bool tputInit(void);
+bool tputHandleEvent(const char* event);
+void tputStart(tputMode_t mode, uint16_t count, uint8_t gap);
+void tputTask(void);
+
+#endif /* TPUTSERVICE_H_ */
@@ -8,11 +8,20 @@
  */
 
 #include "wiring.h"
+#include "cpuLoad.h"
+#include "energyModel.h"
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <util/delay.h>
 
 volatile unsigned long timer0_overflow_count = 0;
 volatile unsigned long timer0_millis = 0;
 unsigned char timer0_fract = 0;
 
+// Watchdog timeout periods in ms, indexed like the WDP3..0 prescaler settings
+static const uint16_t wdtPeriods[] PROGMEM = { 16, 32, 64, 125, 250, 500, 1000, 2000, 4000, 8000 };
+
 // -----------------------------------------------------------------------------------
 // Timer0 overflow interrupt handler
 // -----------------------------------------------------------------------------------
@@ -21,6 +30,7 @@ unsigned char timer0_fract = 0;
 // Increments the millisecond counter on Timer0 overflow, handling fractional milliseconds.
 // -----------------------------------------------------------------------------------
 ISR(TIMER0_OVF_vect) {
+    CPU_ISR_ENTER();
     unsigned long m = timer0_millis;
     unsigned char f = timer0_fract;
 
@@ -34,6 +44,7 @@ ISR(TIMER0_OVF_vect) {
     timer0_fract = f;
     timer0_millis = m;
     timer0_overflow_count++;
+    CPU_ISR_LEAVE();
 }
 
 // -----------------------------------------------------------------------------------
@@ -68,3 +79,124 @@ void initMillis(void) {
     TCCR0B |= (1 << CS01) | (1 << CS00); // Prescaler 64
     TIMSK0 |= (1 << TOIE0); // Enable overflow interrupt
 }
+
+
+// -----------------------------------------------------------------------------------
+// Delay procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time to wait in milliseconds
+// Output: void
+// Busy-waits for the given time using calibrated 1 ms delay loops, independent of
+// Timer0 so it can be used before initMillis.
+// -----------------------------------------------------------------------------------
+void delay(unsigned long ms) {
+    CPU_WAIT_SCOPE();
+    while (ms--) {
+        _delay_ms(1);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Timeout check procedure
+// -----------------------------------------------------------------------------------
+// Input : start - millis() at the start of the wait, timeout - Allowed time in ms
+// Output: bool - True once the timeout has elapsed
+// Deadline test used by all polling loops of the library.
+// -----------------------------------------------------------------------------------
+bool timeoutExpired(unsigned long start, unsigned long timeout) {
+    return millis() - start >= timeout;
+}
+
+// -----------------------------------------------------------------------------------
+// Free SRAM procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint16_t - Bytes between the top of the heap and the current stack pointer
+// Reflects the stack depth of the caller; call it from a shallow point of the main
+// loop for a meaningful figure.
+// -----------------------------------------------------------------------------------
+uint16_t freeSram(void) {
+    extern char __heap_start;
+    extern char* __brkval;
+    char top;
+
+    return (uint16_t)(&top - (__brkval != 0 ? __brkval : &__heap_start));
+}
+
+// -----------------------------------------------------------------------------------
+// Analog read procedure
+// -----------------------------------------------------------------------------------
+// Input : channel - ADC channel 0 to 7
+// Output: uint16_t - 10-bit conversion result against AVcc, 0 for an invalid channel
+// Runs a single conversion with the ADC clock at 62.5 kHz and waits for it, about
+// 200 us. Channels 0 to 5 are switched to analog input on port C.
+// -----------------------------------------------------------------------------------
+uint16_t analogRead(uint8_t channel) {
+    if (channel > 7) return 0; // Invalid channel check
+    if (channel < 6) {
+        DDRC &= ~(1 << channel); // Set pin as input
+        DIDR0 |= (1 << channel); // Disable digital input buffer
+    }
+    ADMUX = (1 << REFS0) | channel; // Reference voltage AVcc, select channel
+    ADCSRA = (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0); // Enable ADC, prescaler 128
+    ADCSRA |= (1 << ADSC); // Start conversion
+    while (ADCSRA & (1 << ADSC)); // Wait for completion
+    return ADC;
+}
+
+// -----------------------------------------------------------------------------------
+// Watchdog interrupt handler
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// Wakes the MCU from power-down; the watchdog runs in interrupt mode only. An
+// application with its own watchdog handler defines WIRING_NO_WDT_ISR; that handler
+// must return without resetting or reconfiguring the watchdog.
+// -----------------------------------------------------------------------------------
+#ifndef WIRING_NO_WDT_ISR
+EMPTY_INTERRUPT(WDT_vect);
+#endif
+
+// -----------------------------------------------------------------------------------
+// Power-down sleep procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Time to sleep in milliseconds
+// Output: void
+// Puts the MCU into power-down in watchdog-timed steps and advances the millisecond
+// counter by the slept time, as Timer0 is stopped during power-down. Sleeps are
+// rounded down to a multiple of the 16 ms watchdog step. Each step is counted as a
+// full watchdog period, so only the watchdog may wake the MCU: the caller disables
+// other wake sources (external and pin change interrupts, TWI address match) first,
+// or millis() runs ahead by up to one period per early wake.
+// -----------------------------------------------------------------------------------
+void powerDown(unsigned long ms) {
+    CPU_SLEEP_SCOPE();
+    while (ms >= pgm_read_word(&wdtPeriods[0])) {
+        uint8_t index = sizeof(wdtPeriods) / sizeof(wdtPeriods[0]) - 1;
+        uint16_t period = pgm_read_word(&wdtPeriods[index]);
+        while (period > ms) {
+            period = pgm_read_word(&wdtPeriods[--index]); // Largest watchdog period that fits
+        }
+        uint8_t wdp = (index & 0x07) | ((index & 0x08) ? (1 << WDP3) : 0);
+
+        uint8_t oldSREG = SREG;
+        cli(); // Disable interrupts
+        wdt_reset();
+        MCUSR &= ~(1 << WDRF); // Clear watchdog reset flag
+        WDTCSR = (1 << WDCE) | (1 << WDE); // Timed sequence to change prescaler
+        WDTCSR = (1 << WDIE) | wdp; // Interrupt mode, no reset
+        set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+        sleep_enable();
+        sei(); // Watchdog interrupt must be able to wake the MCU
+        sleep_cpu();
+        sleep_disable();
+        wdt_disable();
+
+        cli();
+        timer0_millis += period; // Account for the stopped Timer0
+        SREG = oldSREG; // Restore interrupt state
+        CPU_CLOCK_STOPPED(period);
+        ENERGY_SLEEP(period);
+        ms -= period;
+    }
+}
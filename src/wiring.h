@@ -11,6 +11,10 @@
 #ifndef WIRING_H_
 #define WIRING_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
@@ -26,8 +30,26 @@
 extern volatile unsigned long timer0_overflow_count;
 extern volatile unsigned long timer0_millis;
 extern unsigned char timer0_fract;
+#endif
 
 unsigned long millis(void);
 void initMillis(void);
+void delay(unsigned long ms);
+void powerDown(unsigned long ms);
+bool timeoutExpired(unsigned long start, unsigned long timeout);
+uint16_t freeSram(void);
+uint16_t analogRead(uint8_t channel);
+
+#if !defined(__AVR__)
+typedef struct {
+    unsigned long (*millis)(void* ctx);          // Current time in ms
+    void (*delay)(void* ctx, unsigned long ms);   // Let the given time pass
+    void (*deadline)(void* ctx, unsigned long at); // A loop waits until this time, may be NULL
+    void* ctx;                                   // Clock context
+} wiringClock_t;
+
+void wiringSetClock(const wiringClock_t* clock);
+void wiringSetAnalog(uint8_t channel, uint16_t value);
+#endif
 
 #endif /* WIRING_H_ */
@@ -0,0 +1,148 @@
+/*
+ * asyncBench.cpp
+ *
+ * Created: 18-10-2026 06:19:14
+ * Author: Subrata
+ * Description: Benchmark and example of the C++20 gateway facade. Serves simulated
+ *              RN4871 modules on pseudo-terminals from a child process and runs
+ *              thousands of concurrent coroutine operations against them on one
+ *              thread, each writing a payload to a characteristic and reading it
+ *              back. Prints one JSON line.
+ *
+ * Build: g++ -std=c++20 -O2 -Isrc -Isrc/host tools/asyncBench.cpp src/host/rn4871Async.cpp
+ *        src/cmdEngine.cpp src/ringBuffer.cpp src/host/gateway.cpp src/host/traceLog.cpp
+ *        src/host/bleSerialHost.cpp src/host/wiringHost.cpp src/host/rn4871Sim.cpp -o asyncBench
+ * Usage: asyncBench [-m modules] [-n operations]
+ */
+
+#include "rn4871Async.h"
+#include "rn4871Sim.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using rn4871host::Gateway;
+using rn4871host::Result;
+using rn4871host::Task;
+
+// Value handle the simulator assigns to the first characteristic
+static const uint16_t benchHandle = 0x0073;
+
+static uint32_t failed = 0;
+static size_t peak = 0;
+
+// -----------------------------------------------------------------------------------
+// Module setup coroutine
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id
+// Output: Task
+// Enters command mode and defines one service with one read/write characteristic.
+// -----------------------------------------------------------------------------------
+static Task setupModule(Gateway& gw, uint16_t id) {
+    Result result = co_await gw.enterCommandMode(id);
+    if (!result.ok()) failed++;
+    result = co_await gw.command(id, CLEAR_ALL_SERVICES);
+    if (!result.ok()) failed++;
+    result = co_await gw.command(id, DEFINE_SERVICE_UUID "AD11CF40063F11E5BE3E0002A5D5C51B");
+    if (!result.ok()) failed++;
+    result = co_await gw.command(id, DEFINE_CHARACT_UUID "AD11CF40163F11E5BE3E0002A5D5C51B,0A,04");
+    if (!result.ok()) failed++;
+}
+
+// -----------------------------------------------------------------------------------
+// Write and verify coroutine
+// -----------------------------------------------------------------------------------
+// Input : gw - Gateway, id - Module id, n - Operation number
+// Output: Task
+// Writes a 4-byte payload and reads it back. Other operations on the same module may
+// run in between, so only the write acknowledgement and the read format are checked.
+// -----------------------------------------------------------------------------------
+static Task writeAndRead(Gateway& gw, uint16_t id, uint32_t n) {
+    const std::byte payload[4] = { std::byte(n >> 24), std::byte(n >> 16), std::byte(n >> 8), std::byte(n) };
+
+    Result written = co_await gw.writeCharacteristic(id, benchHandle, payload, 500ms);
+    Result read = co_await gw.readCharacteristic(id, benchHandle, 500ms);
+    if (!written.ok() || read.status != cmdOk || read.line.size() != 8) failed++;
+    if (gw.pending() > peak) peak = gw.pending();
+}
+
+// -----------------------------------------------------------------------------------
+// Monotonic time procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in seconds
+// -----------------------------------------------------------------------------------
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    static rn4871Sim_t sims[GATEWAY_MAX_MODULES];
+    int masters[GATEWAY_MAX_MODULES];
+    int modules = 16;
+    uint32_t operations = 4000;
+    char path[64];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:")) != -1) {
+        switch (opt) {
+            case 'm': modules = atoi(optarg); break;
+            case 'n': operations = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-m modules] [-n operations]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (modules < 1 || modules > GATEWAY_MAX_MODULES) {
+        fprintf(stderr, "asyncBench: 1 to %d modules\n", GATEWAY_MAX_MODULES);
+        return EXIT_FAILURE;
+    }
+
+    Gateway gw;
+    if (!gw.valid()) return EXIT_FAILURE;
+    for (int i = 0; i < modules; i++) {
+        simInit(&sims[i]);
+        masters[i] = simOpenPty(path, sizeof(path));
+        if (masters[i] < 0 || gw.open(path) != i) {
+            fprintf(stderr, "asyncBench: cannot open pty %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        simServeMany(sims, masters, modules);
+        _exit(0);
+    }
+    for (int i = 0; i < modules; i++) {
+        close(masters[i]);
+    }
+
+    std::vector<Task> tasks;
+    for (int i = 0; i < modules; i++) {
+        tasks.push_back(setupModule(gw, (uint16_t)i));
+    }
+    bool ok = gw.run(tasks);
+    tasks.clear();
+
+    double start = nowSeconds();
+    tasks.reserve(operations);
+    for (uint32_t n = 0; n < operations; n++) {
+        tasks.push_back(writeAndRead(gw, (uint16_t)(n % modules), n));
+    }
+    peak = gw.pending();
+    ok = gw.run(tasks) && ok;
+    double elapsed = nowSeconds() - start;
+
+    printf("{\"modules\":%d,\"operations\":%u,\"concurrent\":%zu,\"failed\":%u,\"elapsed_s\":%.3f,"
+           "\"operations_per_s\":%.0f,\"commands_per_s\":%.0f}\n",
+           modules, operations, peak, failed, elapsed, operations / elapsed, 2 * operations / elapsed);
+
+    kill(child, SIGTERM);
+    waitpid(child, NULL, 0);
+    return ok && failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+/*
+ * bridgeTest.cpp
+ *
+ * Created: 18-10-2026 07:11:31
+ * Author: Subrata
+ * Description: Host check of the sensor bridge against the in-process simulator on
+ *              a virtual clock. Defines an on-change, a notify and a periodic row,
+ *              then runs the main loop of the example while a central connects,
+ *              subscribes, writes and disconnects. Checks that nothing is written
+ *              while disconnected, that on-change rows are written only when their
+ *              value changes, that notifications reach the central only while it is
+ *              subscribed and that the %WC and %WV events reach the application.
+ *              Prints the result as one JSON line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/bridgeTest.cpp src/sensorBridge.cpp src/crc16.cpp
+ *        src/rn4871.cpp src/lsParser.cpp src/ringBuffer.cpp src/host/simPort.cpp
+ *        src/host/vclock.cpp src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o bridgeTest
+ * Usage: bridgeTest
+ */
+
+#include "rn4871.h"
+#include "sensorBridge.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Main loop period of the example while connected (ms)
+#define LOOP_PERIOD 20
+
+static const char* serviceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
+static const char* levelUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+static const char* supplyUUID = "AD11CF40263F11E5BE3E0002A5D5C51B";
+static const char* counterUUID = "AD11CF40463F11E5BE3E0002A5D5C51B";
+static const char* commandUUID = "AD11CF40363F11E5BE3E0002A5D5C51B";
+
+static int32_t supply = 3300;
+static uint32_t counter = 0;
+
+static int32_t readSupply(uint8_t channel) {
+    (void)channel;
+    return supply;
+}
+
+static int32_t readCounter(uint8_t channel) {
+    (void)channel;
+    return (int32_t)++counter;
+}
+
+static const bridgeRow_t rows[] = {
+    { bridgeAdc, 2, NULL, 100, bridgeUint16Be, levelUUID, READ_PROPERTY, bridgeOnChange },
+    { bridgeCallback, 0, readSupply, 500, bridgeUint16Le, supplyUUID,
+      READ_PROPERTY | NOTIFY_PROPERTY, bridgeNotify },
+    { bridgeCallback, 0, readCounter, 1000, bridgeUint32Le, counterUUID, READ_PROPERTY, bridgePeriodic }
+};
+static const uint8_t rowCount = sizeof(rows) / sizeof(rows[0]);
+static bridgeState_t rowState[rowCount];
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+static uint16_t notified = 0;    // Notifications of the supply row seen by the central
+static uint16_t bridgeEvents = 0; // Events bridgeHandleEvent claimed
+static uint16_t valueWrites = 0;  // %WV events of the command characteristic
+
+// -----------------------------------------------------------------------------------
+// Central observer procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Unused, handle - Value handle, data - Value, length - Value length
+// Output: void
+// -----------------------------------------------------------------------------------
+static void onCentral(void* ctx, uint16_t handle, const uint8_t* data, uint16_t length) {
+    (void)ctx;
+    (void)data;
+    (void)length;
+    if (handle != 0 && handle == sensorBridge.state[1].handle) {
+        notified++;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Event handler procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters
+// Output: void
+// -----------------------------------------------------------------------------------
+static void onEvent(const char* event) {
+    if (bridgeHandleEvent(event)) {
+        bridgeEvents++;
+    } else if (strncmp(event, VALUE_WRITE_EVENT, sizeof(VALUE_WRITE_EVENT) - 1) == 0) {
+        valueWrites++;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Run main loop procedure
+// -----------------------------------------------------------------------------------
+// Input : ms - Virtual time to run
+// Output: void
+// The connection poll and bridge task of the example's main loop.
+// -----------------------------------------------------------------------------------
+static void runFor(uint32_t ms) {
+    uint32_t start = millis();
+
+    while (!timeoutExpired(start, ms)) {
+        getConnectionStatus(); // Collects pending events
+        bridgeTask();
+        delay(LOOP_PERIOD);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Stored value procedure
+// -----------------------------------------------------------------------------------
+// Input : row - Row index
+// Output: uint32_t - Value the simulator holds for the row, little-endian
+// -----------------------------------------------------------------------------------
+static uint32_t storedValue(uint8_t row) {
+    const simAttribute_t* attr = simFindHandle(&sim, sensorBridge.state[row].handle);
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; attr != NULL && i < attr->valueLen && i < 4; i++) {
+        value |= (uint32_t)attr->value[i] << (8 * i);
+    }
+    return value;
+}
+
+int main(void) {
+    simInit(&sim);
+    sim.central = onCentral;
+    vclockInit(&virtualClock);
+    simPortAttach(&port, &sim, &virtualClock);
+    setOperationMode(dataMode);
+    setEventHandler(onEvent);
+    wiringSetAnalog(2, 0x0123);
+
+    bool defined = swInit() && enterCommandMode() && setServiceUUID(serviceUUID) &&
+                   bridgeDefine(rows, rowCount) && setCharactUUID(commandUUID, WRITE_PROPERTY, 1) &&
+                   reboot() && enterCommandMode();
+    bool initialized = defined && bridgeInit(rows, rowState, rowCount);
+    uint16_t commandHandle = findHandle(commandUUID, WRITE_PROPERTY);
+
+    // Disconnected: samples are taken, nothing is written
+    runFor(2000);
+    bool idle = sensorBridge.samples > 0 && sensorBridge.writes == 0;
+
+    // Connected: on-change and periodic rows go out, the notify row waits
+    simConnect(&sim, NULL);
+    runFor(1500);
+    uint32_t connectWrites = sensorBridge.writes;
+    bool level = storedValue(0) == 0x2301; // Big-endian 0x0123
+    bool waiting = storedValue(1) == 0; // Not subscribed, not written
+    runFor(1000);
+    bool onChange = sensorBridge.writes == connectWrites + 1; // Counter row only
+    wiringSetAnalog(2, 0x0200);
+    runFor(300);
+    bool changed = storedValue(0) == 0x0002;
+
+    // Subscribed: the supply row is notified on change only
+    simCentralSubscribe(&sim, sensorBridge.state[1].handle, true);
+    runFor(1200);
+    bool firstNotify = notified == 1 && storedValue(1) == 3300;
+    supply = 3000;
+    runFor(600);
+    bool changeNotify = notified == 2 && storedValue(1) == 3000;
+    simCentralWrite(&sim, commandHandle, "05");
+    runFor(100);
+
+    // Disconnected again: writes stop
+    simDisconnect(&sim);
+    runFor(100);
+    uint32_t disconnectWrites = sensorBridge.writes;
+    supply = 2800;
+    wiringSetAnalog(2, 0x0300);
+    runFor(2000);
+    bool stopped = sensorBridge.writes == disconnectWrites && notified == 2;
+
+    bool passed = initialized && idle && level && waiting && onChange && changed && firstNotify &&
+                  changeNotify && stopped && bridgeEvents == 1 && valueWrites == 1 &&
+                  sensorBridge.failures == 0;
+    printf("{\"result\":\"%s\",\"initialized\":%d,\"idle\":%d,\"level\":%d,\"waiting\":%d,"
+           "\"on_change\":%d,\"changed\":%d,\"first_notify\":%d,\"change_notify\":%d,"
+           "\"stopped\":%d,\"bridge_events\":%u,\"value_writes\":%u,\"samples\":%lu,\"writes\":%lu,"
+           "\"failures\":%lu,\"virtual_ms\":%lu}\n",
+           passed ? "pass" : "fail", initialized, idle, level, waiting, onChange, changed,
+           firstNotify, changeNotify, stopped, bridgeEvents, valueWrites, (unsigned long)sensorBridge.samples,
+           (unsigned long)sensorBridge.writes, (unsigned long)sensorBridge.failures,
+           (unsigned long)virtualClock.now);
+    simPortDetach(&port);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
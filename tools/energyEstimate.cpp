@@ -0,0 +1,146 @@
+/*
+ * energyEstimate.cpp
+ *
+ * Created: 18-10-2026 07:08:11
+ * Author: Subrata
+ * Description: Battery life estimate for a firmware configuration. Runs a sensor
+ *              firmware against the in-process simulator on a virtual clock for a
+ *              simulated day or more: advertising at the given interval and power
+ *              level, one characteristic update per update period with power-down
+ *              in between, and a central that connects for a number of seconds
+ *              every hour. The energy model of the library turns the resulting
+ *              state residency into charge and predicted battery life, printed as
+ *              one JSON line, so configurations can be compared without a power
+ *              analyzer. The simulator answers without UART delay, so the MCU
+ *              active time excludes waiting for responses; the transmit time is
+ *              reported separately from the byte count.
+ *
+ * Build: g++ -O2 -DENERGY_MODEL -Isrc -Isrc/host tools/energyEstimate.cpp src/energyModel.cpp
+ *        src/rn4871.cpp src/lsParser.cpp src/ringBuffer.cpp src/host/simPort.cpp
+ *        src/host/vclock.cpp src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o energyEstimate
+ * Usage: energyEstimate [-i adv_interval] [-p power_level] [-u update_ms]
+ *        [-c connected_s_per_hour] [-H hours] [-C capacity_mAh]
+ */
+
+#include "energyModel.h"
+#include "rn4871.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define HOUR_MS 3600000UL
+
+static const char* serviceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
+static const char* sensorCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+
+// -----------------------------------------------------------------------------------
+// Setup procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: uint16_t - Handle of the sensor characteristic, 0 on failure
+// Defines one notifying sensor characteristic and reboots the module.
+// -----------------------------------------------------------------------------------
+static uint16_t setup(void) {
+    if (!enterCommandMode() || !clearAllServices()) return 0;
+    if (!setServiceUUID(serviceUUID)) return 0;
+    if (!setCharactUUID(sensorCharUUID, READ_PROPERTY | NOTIFY_PROPERTY, 2)) return 0;
+    if (!reboot() || !enterCommandMode()) return 0;
+    return findHandle(sensorCharUUID, READ_PROPERTY | NOTIFY_PROPERTY);
+}
+
+int main(int argc, char** argv) {
+    uint16_t interval = ENERGY_DEFAULT_ADV_INTERVAL;
+    uint8_t power = 0;
+    uint32_t updatePeriod = 1000;
+    uint32_t connectedTime = 0;
+    uint32_t hours = 24;
+    uint16_t capacity = 230;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:p:u:c:H:C:")) != -1) {
+        switch (opt) {
+            case 'i': interval = (uint16_t)strtoul(optarg, NULL, 10); break;
+            case 'p': power = (uint8_t)strtoul(optarg, NULL, 10); break;
+            case 'u': updatePeriod = strtoul(optarg, NULL, 10); break;
+            case 'c': connectedTime = strtoul(optarg, NULL, 10) * 1000UL; break;
+            case 'H': hours = strtoul(optarg, NULL, 10); break;
+            case 'C': capacity = (uint16_t)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-i adv_interval] [-p power_level] [-u update_ms] "
+                                "[-c connected_s_per_hour] [-H hours] [-C capacity_mAh]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (connectedTime > HOUR_MS) connectedTime = HOUR_MS;
+
+    simInit(&sim);
+    vclockInit(&virtualClock);
+    simPortAttach(&port, &sim, &virtualClock);
+    setOperationMode(dataMode);
+    energyInit(NULL);
+
+    uint16_t handle = setup();
+    if (handle == 0 || !setAdvPower(power) || !startCustomAdvertising(interval)) {
+        fprintf(stderr, "setup failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // Firmware main loop: update, then power down until the next update or until
+    // the central connects or disconnects
+    uint32_t begin = millis();
+    uint32_t end = hours * HOUR_MS;
+    uint32_t nextUpdate = 0;
+    uint32_t failures = 0;
+    uint32_t now;
+
+    while ((now = millis() - begin) < end) {
+        uint32_t inHour = now % HOUR_MS;
+        bool wantConnected = inHour < connectedTime;
+
+        if (wantConnected != sim.connected) {
+            if (wantConnected) {
+                simConnect(&sim, NULL);
+            } else {
+                simDisconnect(&sim);
+            }
+            getConnectionStatus(); // Delivers the event
+        }
+        if (updatePeriod > 0 && now >= nextUpdate) {
+            char value[5];
+            snprintf(value, sizeof(value), "%04X", (unsigned)(now / updatePeriod) & 0xFFFF);
+            if (!writeLocalCharacteristic(handle, value)) failures++;
+            nextUpdate += updatePeriod;
+        }
+
+        now = millis() - begin;
+        inHour = now % HOUR_MS;
+        uint32_t wake = now - inHour + (inHour < connectedTime ? connectedTime : HOUR_MS);
+        if (updatePeriod > 0 && nextUpdate < wake) wake = nextUpdate;
+        if (wake > end) wake = end;
+        if (wake > now) powerDown(wake - now);
+    }
+
+    energyReport_t report;
+    energyGet(&report);
+    float life = energyLifeHours(&report, capacity);
+    printf("{\"adv_interval\":%u,\"power_level\":%u,\"update_ms\":%lu,\"connected_s_per_h\":%lu,"
+           "\"hours\":%lu,\"residency_s\":{\"mcu_active\":%.1f,\"mcu_sleep\":%.1f,\"idle\":%.1f,"
+           "\"advertising\":%.1f,\"connected\":%.1f,\"scanning\":%.1f,\"uart_tx\":%.1f},"
+           "\"updates\":%lu,\"failures\":%lu,\"charge_mAh\":%.3f,\"average_uA\":%.1f,"
+           "\"capacity_mAh\":%u,\"life_days\":%.1f}\n",
+           interval, power, (unsigned long)updatePeriod, (unsigned long)(connectedTime / 1000),
+           (unsigned long)hours, report.residency[energyMcuActive] / 1000.0,
+           report.residency[energyMcuSleep] / 1000.0, report.residency[energyModuleIdle] / 1000.0,
+           report.residency[energyAdvertising] / 1000.0, report.residency[energyConnected] / 1000.0,
+           report.residency[energyScanning] / 1000.0, report.residency[energyUartTx] / 1000.0,
+           (unsigned long)report.updates, (unsigned long)failures, report.charge / 1000.0,
+           report.averageCurrent, capacity, life / 24.0);
+    simPortDetach(&port);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
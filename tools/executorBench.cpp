@@ -0,0 +1,243 @@
+/*
+ * executorBench.cpp
+ *
+ * Created: 18-10-2026 06:22:58
+ * Author: Subrata
+ * Description: Multi-threaded benchmark and example of the command executor. Serves
+ *              simulated RN4871 modules on pseudo-terminals from a child process,
+ *              then lets several application threads write characteristics on all
+ *              modules at once. Even threads wait on each request like a future, odd
+ *              threads use completion callbacks and check that each module answered
+ *              their requests in submission order. Prints one JSON line.
+ *
+ * Build: g++ -O2 -pthread -Isrc -Isrc/host tools/executorBench.cpp src/host/executor.cpp
+ *        src/host/gateway.cpp src/cmdEngine.cpp src/ringBuffer.cpp src/host/bleSerialHost.cpp
+ *        src/host/traceLog.cpp src/host/wiringHost.cpp src/host/rn4871Sim.cpp -o executorBench
+ * Usage: executorBench [-m modules] [-t threads] [-n commands_per_thread] [-w window]
+ */
+
+#include "executor.h"
+#include "rn4871Sim.h"
+#include "rn4871_const.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Value handle the simulator assigns to the first characteristic
+static const uint16_t benchHandle = 0x0073;
+
+typedef struct {
+    int index;                          // Thread number
+    uint32_t commands;                  // Commands to issue
+    uint32_t window;                    // Requests in flight per thread
+    execRequest_t* requests;            // Request storage, one per command
+    std::atomic<uint32_t> done;         // Completed requests (callback threads)
+    uint32_t lastSeq[GATEWAY_MAX_MODULES]; // Last sequence completed per module + 1
+    std::atomic<uint32_t> failed;       // Requests that did not return AOK
+    uint32_t outOfOrder;                // Completions out of submission order
+} worker_t;
+
+static executor_t* exec;
+static int modules = 8;
+
+// -----------------------------------------------------------------------------------
+// Prepare write procedure
+// -----------------------------------------------------------------------------------
+// Input : request - Request to fill, worker - Owner, seq - Sequence number
+// Output: void
+// Writes the thread and sequence number as the characteristic value.
+// -----------------------------------------------------------------------------------
+static void prepareWrite(execRequest_t* request, worker_t* worker, uint32_t seq) {
+    char command[CMD_COMMAND_SIZE];
+
+    snprintf(command, sizeof(command), WRITE_LOCAL_CHARACT "%04X,%02X%06X", benchHandle,
+             (unsigned)(worker->index & 0xFF), (unsigned)(seq & 0xFFFFFF));
+    executorPrepare(request, (uint16_t)(seq % modules), command, AOK_RESP, cmdMatchLine, 1000);
+}
+
+// -----------------------------------------------------------------------------------
+// Completion callback procedure
+// -----------------------------------------------------------------------------------
+// Input : request - Completed request, status - Result, line - Final line
+// Output: void
+// Runs on the I/O thread. Sequence numbers per module must arrive in increasing order.
+// -----------------------------------------------------------------------------------
+static void onWritten(execRequest_t* request, cmdStatus_t status, const char* line) {
+    worker_t* worker = (worker_t*)request->ctx;
+    uint32_t seq = (uint32_t)(request - worker->requests);
+
+    (void)line;
+    if (status == cmdPending) return;
+    if (status != cmdOk) worker->failed++;
+    if (seq + 1 <= worker->lastSeq[request->module]) worker->outOfOrder++;
+    worker->lastSeq[request->module] = seq + 1;
+    worker->done.fetch_add(1, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------------
+// Worker thread procedure
+// -----------------------------------------------------------------------------------
+// Input : arg - Worker
+// Output: void* - NULL
+// Keeps up to window requests in flight across all modules.
+// -----------------------------------------------------------------------------------
+static void* workerThread(void* arg) {
+    worker_t* worker = (worker_t*)arg;
+    bool callbacks = worker->index & 1;
+    uint32_t oldest = 0;
+
+    for (uint32_t seq = 0; seq < worker->commands; seq++) {
+        execRequest_t* request = &worker->requests[seq];
+
+        if (callbacks) {
+            while (seq - worker->done.load(std::memory_order_acquire) >= worker->window) {
+                sched_yield();
+            }
+        } else if (seq - oldest >= worker->window) {
+            if (!executorWait(&worker->requests[oldest], -1) || worker->requests[oldest].status != cmdOk) {
+                worker->failed++;
+            }
+            oldest++;
+        }
+        prepareWrite(request, worker, seq);
+        if (callbacks) {
+            request->callback = onWritten;
+            request->ctx = worker;
+        }
+        if (!executorSubmit(exec, request)) {
+            worker->failed++;
+            if (callbacks) worker->done.fetch_add(1);
+        }
+    }
+    if (callbacks) {
+        while (worker->done.load(std::memory_order_acquire) < worker->commands) {
+            sched_yield();
+        }
+    } else {
+        for (; oldest < worker->commands; oldest++) {
+            if (!executorWait(&worker->requests[oldest], -1) || worker->requests[oldest].status != cmdOk) {
+                worker->failed++;
+            }
+        }
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Setup command procedure
+// -----------------------------------------------------------------------------------
+// Input : module - Module id, command - Command text, expect - Success substring,
+//         match - Completion rule, flags - CMD_FLAG_* bits
+// Output: bool - True if the module accepted the command
+// -----------------------------------------------------------------------------------
+static bool setupCommand(uint16_t module, const char* command, const char* expect, cmdMatch_t match, uint8_t flags) {
+    execRequest_t request;
+
+    executorPrepare(&request, module, command, expect, match, DEFAULT_CMD_TIMEOUT);
+    request.flags = flags;
+    return executorSubmit(exec, &request) && executorWait(&request, -1) && request.status == cmdOk;
+}
+
+// -----------------------------------------------------------------------------------
+// Monotonic time procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in seconds
+// -----------------------------------------------------------------------------------
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    static rn4871Sim_t sims[GATEWAY_MAX_MODULES];
+    int masters[GATEWAY_MAX_MODULES];
+    int threads = 4;
+    uint32_t commands = 2000;
+    uint32_t window = 16;
+    char path[64];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:t:n:w:")) != -1) {
+        switch (opt) {
+            case 'm': modules = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 'n': commands = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'w': window = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-m modules] [-t threads] [-n commands_per_thread] [-w window]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (modules < 1 || modules > GATEWAY_MAX_MODULES || threads < 1 || threads > 256 || window < 1) {
+        fprintf(stderr, "executorBench: 1 to %d modules, 1 to 256 threads, window >= 1\n", GATEWAY_MAX_MODULES);
+        return EXIT_FAILURE;
+    }
+
+    exec = new executor_t;
+    if (!executorInit(exec)) return EXIT_FAILURE;
+    for (int i = 0; i < modules; i++) {
+        simInit(&sims[i]);
+        masters[i] = simOpenPty(path, sizeof(path));
+        if (masters[i] < 0 || executorOpen(exec, path) != i) {
+            fprintf(stderr, "executorBench: cannot open pty %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        simServeMany(sims, masters, modules);
+        _exit(0);
+    }
+    for (int i = 0; i < modules; i++) {
+        close(masters[i]);
+    }
+    if (!executorStart(exec)) return EXIT_FAILURE;
+
+    bool ok = true;
+    for (int i = 0; i < modules; i++) {
+        ok = setupCommand((uint16_t)i, ENTER_CMD, NULL, cmdMatchPrompt, CMD_FLAG_RAW) && ok;
+        ok = setupCommand((uint16_t)i, CLEAR_ALL_SERVICES, AOK_RESP, cmdMatchLine, 0) && ok;
+        ok = setupCommand((uint16_t)i, DEFINE_SERVICE_UUID "AD11CF40063F11E5BE3E0002A5D5C51B", AOK_RESP, cmdMatchLine, 0) && ok;
+        ok = setupCommand((uint16_t)i, DEFINE_CHARACT_UUID "AD11CF40163F11E5BE3E0002A5D5C51B,0A,04", AOK_RESP, cmdMatchLine, 0) && ok;
+    }
+
+    worker_t* workers = new worker_t[threads];
+    pthread_t* ids = new pthread_t[threads];
+    double start = nowSeconds();
+    for (int i = 0; i < threads; i++) {
+        workers[i].index = i;
+        workers[i].commands = commands;
+        workers[i].window = window;
+        workers[i].requests = new execRequest_t[commands];
+        workers[i].done.store(0);
+        workers[i].failed.store(0);
+        workers[i].outOfOrder = 0;
+        for (int m = 0; m < GATEWAY_MAX_MODULES; m++) workers[i].lastSeq[m] = 0;
+        pthread_create(&ids[i], NULL, workerThread, &workers[i]);
+    }
+    uint32_t failed = 0;
+    uint32_t outOfOrder = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        failed += workers[i].failed;
+        outOfOrder += workers[i].outOfOrder;
+    }
+    double elapsed = nowSeconds() - start;
+    uint32_t total = commands * (uint32_t)threads;
+    executorStop(exec);
+
+    printf("{\"modules\":%d,\"threads\":%d,\"commands\":%u,\"window\":%u,\"failed\":%u,\"out_of_order\":%u,"
+           "\"elapsed_s\":%.3f,\"commands_per_s\":%.0f,\"wakeups\":%u,\"setup_ok\":%s}\n",
+           modules, threads, total, window, failed, outOfOrder, elapsed, total / elapsed, exec->wakeups,
+           ok ? "true" : "false");
+
+    kill(child, SIGTERM);
+    waitpid(child, NULL, 0);
+    return ok && failed == 0 && outOfOrder == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
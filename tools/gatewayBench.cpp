@@ -0,0 +1,198 @@
+/*
+ * gatewayBench.cpp
+ *
+ * Created: 18-10-2026 05:55:42
+ * Author: Subrata
+ * Description: Benchmark of the multi-module gateway engine. Serves N simulated
+ *              RN4871 modules on pseudo-terminal pairs from a child process and
+ *              drives them from one gateway thread, reporting command throughput
+ *              and latency per module count as one JSON object per line. With -l
+ *              all traffic is recorded in a binary trace log in the given directory.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/gatewayBench.cpp src/cmdEngine.cpp
+ *        src/ringBuffer.cpp src/host/gateway.cpp src/host/traceLog.cpp
+ *        src/host/bleSerialHost.cpp src/host/wiringHost.cpp src/host/rn4871Sim.cpp -o gatewayBench
+ * Usage: gatewayBench [-n commands] [-l trace_dir] [modules ...]
+ */
+
+#include "gateway.h"
+#include "rn4871Sim.h"
+#include "rn4871_const.h"
+#include "traceLog.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Value handle the simulator assigns to the first characteristic
+#define BENCH_HANDLE "0073"
+
+typedef struct {
+    gateway_t* gw;      // Gateway driving the module
+    uint16_t id;        // Module id
+    uint32_t remaining; // Writes still to submit
+    uint32_t failed;    // Commands not acknowledged
+} benchModule_t;
+
+static gateway_t gw;
+static benchModule_t bench[GATEWAY_MAX_MODULES];
+static traceLog_t trace;
+static const char* traceDir = NULL;
+
+// -----------------------------------------------------------------------------------
+// Monotonic time procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in seconds
+// -----------------------------------------------------------------------------------
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -----------------------------------------------------------------------------------
+// Write completion procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Benchmark module, status - Result, line - Response
+// Output: void
+// Keeps the module's command queue full by submitting the next write.
+// -----------------------------------------------------------------------------------
+static void onWrite(void* ctx, cmdStatus_t status, const char* line) {
+    benchModule_t* module = (benchModule_t*)ctx;
+    char command[32];
+
+    (void)line;
+    if (status != cmdOk) module->failed++;
+    if (module->remaining == 0) return;
+
+    module->remaining--;
+    snprintf(command, sizeof(command), WRITE_LOCAL_CHARACT BENCH_HANDLE ",%04X", module->remaining & 0xFFFF);
+    gatewaySubmit(module->gw, module->id, command, AOK_RESP, cmdMatchLine, DEFAULT_CMD_TIMEOUT, onWrite, module);
+}
+
+// -----------------------------------------------------------------------------------
+// Setup completion procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Benchmark module, status - Result, line - Response
+// Output: void
+// Counts failed setup commands; the setup itself is queued up front.
+// -----------------------------------------------------------------------------------
+static void onSetup(void* ctx, cmdStatus_t status, const char* line) {
+    (void)line;
+    if (status != cmdOk) ((benchModule_t*)ctx)->failed++;
+}
+
+// -----------------------------------------------------------------------------------
+// Run benchmark procedure
+// -----------------------------------------------------------------------------------
+// Input : count - Number of simulated modules, commands - Writes per module
+// Output: bool - True if all commands were acknowledged
+// Benchmarks one module count and prints the result line.
+// -----------------------------------------------------------------------------------
+static bool runBenchmark(int count, uint32_t commands) {
+    static rn4871Sim_t sims[GATEWAY_MAX_MODULES];
+    int masters[GATEWAY_MAX_MODULES];
+    char path[64];
+
+    if (!gatewayInit(&gw)) return false;
+    if (traceDir != NULL) {
+        if (!traceLogOpen(&trace, traceDir, 0)) {
+            fprintf(stderr, "gatewayBench: cannot create trace log in %s\n", traceDir);
+            return false;
+        }
+        gatewaySetTrace(&gw, &trace);
+    }
+    for (int i = 0; i < count; i++) {
+        simInit(&sims[i]);
+        masters[i] = simOpenPty(path, sizeof(path));
+        if (masters[i] < 0 || gatewayOpen(&gw, path) != i) {
+            fprintf(stderr, "gatewayBench: cannot open pty %d\n", i);
+            return false;
+        }
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        simServeMany(sims, masters, count);
+        _exit(0);
+    }
+    for (int i = 0; i < count; i++) {
+        close(masters[i]);
+    }
+
+    double start = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        benchModule_t* module = &bench[i];
+        module->gw = &gw;
+        module->id = (uint16_t)i;
+        module->remaining = commands;
+        module->failed = 0;
+        gatewayEnterCommandMode(&gw, module->id, onSetup, module);
+        gatewaySubmit(&gw, module->id, CLEAR_ALL_SERVICES, AOK_RESP, cmdMatchLine, DEFAULT_CMD_TIMEOUT, onSetup, module);
+        gatewaySubmit(&gw, module->id, DEFINE_SERVICE_UUID "AD11CF40063F11E5BE3E0002A5D5C51B", AOK_RESP,
+                      cmdMatchLine, DEFAULT_CMD_TIMEOUT, onSetup, module);
+        gatewaySubmit(&gw, module->id, DEFINE_CHARACT_UUID "AD11CF40163F11E5BE3E0002A5D5C51B,02,02", AOK_RESP,
+                      cmdMatchLine, DEFAULT_CMD_TIMEOUT, onWrite, module); // Starts the write chain
+    }
+    while (!gatewayIdle(&gw)) {
+        if (gatewayRun(&gw, 100) < 0) break;
+    }
+    double elapsed = nowSeconds() - start;
+    gatewayTraceStats(&gw);
+
+    uint32_t total = 0, failed = 0, latencyTotal = 0, latencyMax = 0;
+    for (int i = 0; i < count; i++) {
+        const cmdStats_t* stats = &gw.modules[i].engine.stats;
+        total += stats->commands;
+        latencyTotal += stats->latencyTotal;
+        if (stats->latencyMax > latencyMax) latencyMax = stats->latencyMax;
+        failed += bench[i].failed;
+    }
+    printf("{\"modules\":%d,\"commands\":%u,\"failed\":%u,\"elapsed_s\":%.3f,"
+           "\"commands_per_s\":%.0f,\"latency_mean_ms\":%.2f,\"latency_max_ms\":%u,"
+           "\"trace_records\":%u,\"trace_bytes\":%llu,\"trace_dropped\":%u}\n",
+           count, total, failed, elapsed, total / elapsed,
+           total ? (double)latencyTotal / total : 0.0, latencyMax,
+           trace.records, (unsigned long long)trace.bytes, trace.dropped);
+    fflush(stdout);
+
+    kill(child, SIGTERM);
+    waitpid(child, NULL, 0);
+    gatewayClose(&gw);
+    if (traceDir != NULL) traceLogClose(&trace);
+    return failed == 0;
+}
+
+int main(int argc, char** argv) {
+    static const int defaults[] = { 1, 4, 16, 64 };
+    uint32_t commands = 500;
+    bool ok = true;
+    int counts = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            commands = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            traceDir = argv[++i];
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "-l") == 0) {
+            i++;
+            continue;
+        }
+        int count = atoi(argv[i]);
+        if (count > 0 && count <= GATEWAY_MAX_MODULES) {
+            ok = runBenchmark(count, commands) && ok;
+            counts++;
+        }
+    }
+    for (int i = 0; counts == 0 && i < (int)(sizeof(defaults) / sizeof(defaults[0])); i++) {
+        ok = runBenchmark(defaults[i], commands) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
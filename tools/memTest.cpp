@@ -0,0 +1,90 @@
+/*
+ * memTest.cpp
+ *
+ * Created: 18-10-2026 07:04:52
+ * Author: Subrata
+ * Description: Host check of the SRAM budget of the library. Runs the setup
+ *              sequence of the example firmware against the in-process simulator
+ *              on a virtual clock, then checks that the buffer table adds up to
+ *              MEM_BUFFER_TOTAL within MEM_BUFFER_BUDGET and that memCheck passes,
+ *              i.e. no byte was lost from the receive ring or an over-long line.
+ *              Building it with a smaller DEFAULT_INPUT_BUFFER_SIZE, EVENT_LINE_SIZE
+ *              or BLE_BUFFER_SIZE shows whether the shrunk buffers still suffice.
+ *              Prints the buffer table and the result as one JSON line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/memTest.cpp src/memInfo.cpp src/rn4871.cpp
+ *        src/lsParser.cpp src/ringBuffer.cpp src/host/simPort.cpp src/host/vclock.cpp
+ *        src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp src/host/wiringHost.cpp -o memTest
+ * Usage: memTest
+ */
+
+#include "memInfo.h"
+#include "rn4871.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* myServiceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
+static const char* potCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+static const char* toggleLedCharUUID = "AD11CF40363F11E5BE3E0002A5D5C51B";
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+
+// -----------------------------------------------------------------------------------
+// Provisioning run procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if every step succeeded
+// The setup sequence of readPot_writeBtn.cpp followed by one update cycle.
+// -----------------------------------------------------------------------------------
+static bool provisionRun(void) {
+    if (!swInit()) return false;
+    if (!enterCommandMode()) return false;
+    if (!stopAdvertising()) return false;
+    if (!clearAllServices()) return false;
+    if (!setSerializedName("Avocado")) return false;
+    if (!setServiceUUID(myServiceUUID)) return false;
+    if (!setCharactUUID(potCharUUID, READ_PROPERTY, 4)) return false;
+    if (!setCharactUUID(toggleLedCharUUID, WRITE_PROPERTY, 1)) return false;
+    uint16_t potHandle = findHandle(potCharUUID, READ_PROPERTY);
+    if (potHandle == 0 || findHandle(toggleLedCharUUID, WRITE_PROPERTY) == 0) return false;
+    if (!reboot()) return false;
+    if (!enterCommandMode()) return false;
+    if (!setAdvPower(0)) return false;
+    if (!writeLocalCharacteristic(potHandle, "0123")) return false;
+    if (!readLocalCharacteristic(potHandle)) return false;
+    return strncmp(getLastResponse(), "0123", 4) == 0;
+}
+
+int main(void) {
+    memReport_t report;
+    uint32_t total = 0;
+
+    simInit(&sim);
+    vclockInit(&virtualClock);
+    simPortAttach(&port, &sim, &virtualClock);
+    setOperationMode(dataMode);
+
+    bool provisioned = provisionRun();
+    memInfoGet(&report);
+    bool checked = memCheck(&report);
+
+    printf("{\"buffers\":{");
+    for (uint8_t i = 0; i < memBufferCount; i++) {
+        printf("%s\"%s\":%u", i ? "," : "", memBuffers[i].name, memBuffers[i].size);
+        total += memBuffers[i].size;
+    }
+    bool budget = total == MEM_BUFFER_TOTAL && total <= MEM_BUFFER_BUDGET;
+
+    bool passed = provisioned && checked && budget;
+    printf("},\"result\":\"%s\",\"provisioned\":%d,\"mem_check\":%d,\"buffer_total\":%lu,"
+           "\"budget\":%d,\"rx_high_water\":%u,\"tx_high_water\":%u,\"rx_overruns\":%u,"
+           "\"line_overflows\":%u}\n",
+           passed ? "pass" : "fail", provisioned, checked, (unsigned long)total, MEM_BUFFER_BUDGET,
+           report.rxHighWater, report.txHighWater, report.rxOverruns, report.lineOverflows);
+    simPortDetach(&port);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,560 @@
+/*
+ * microBench.cpp
+ *
+ * Created: 18-10-2026 06:10:28
+ * Author: Subrata
+ * Description: Microbenchmarks of the hot primitives of the library on the Linux
+ *              port: ring buffer push/pop, response and LS listing parsing, and
+ *              command building. Inputs are captured from the RN4871 simulator so
+ *              they match real module output; the LS scaling benchmarks use
+ *              synthetic listings with hundreds of entries. The serial benchmarks
+ *              compare the runtime transport of the host port with the HAL driver
+ *              bound at compile time to the mock UART. Each benchmark runs for a minimum
+ *              wall time and prints one JSON object per line, so result files of
+ *              two versions can be compared line by line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/microBench.cpp src/rn4871.cpp src/lsParser.cpp
+ *        src/ringBuffer.cpp src/cmdEngine.cpp src/host/provision.cpp src/host/gateway.cpp
+ *        src/host/traceLog.cpp src/host/vclock.cpp src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o microBench
+ * Usage: microBench [-t min_ms] [-s services] [-c chars_per_service] [filter]
+ */
+
+#include "rn4871.h"
+#include "ringBuffer.h"
+#include "cmdEngine.h"
+#include "provision.h"
+#include "lsParser.h"
+#include "hal.h"
+#include "halMock.h"
+#include "rn4871Sim.h"
+#include "vclock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Size of captured module output
+#define CAPTURE_SIZE 4096
+
+typedef struct {
+    const char* name; // Benchmark name
+    const char* unit; // Rate unit, e.g. bytes/s
+    uint32_t (*run)(uint32_t iterations); // Runs iterations, returns units processed
+    uint16_t entries; // Entries of the synthetic LS listing, 0 if not used
+} bench_t;
+
+typedef struct {
+    const uint8_t* reply; // Bytes the module answers with
+    int replyLen;         // Length of the answer
+    int replyPos;         // Bytes already delivered
+    bool armOnCr;         // Re-arm the answer when a command is sent
+} benchPort_t;
+
+static const char* potCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+
+static benchPort_t port;
+static bleTransport_t transport;
+static vclock_t virtualClock;
+static volatile uint32_t sink; // Keeps results alive
+
+static char aokReply[64];
+static int aokLen;
+static char lsReply[CAPTURE_SIZE];
+static int lsLen;
+static uint32_t lsLines;
+static char lsTarget[33];
+static uint8_t lsTargetProperty;
+static char* synthReply;
+static int synthLen;
+static uint32_t synthLines;
+static uint16_t synthEntries;
+static char synthTarget[33];
+static uint16_t synthHandle;
+
+// -----------------------------------------------------------------------------------
+// Wall clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in ms
+// -----------------------------------------------------------------------------------
+static double wallMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// -----------------------------------------------------------------------------------
+// Bench port callbacks
+// -----------------------------------------------------------------------------------
+// The module answers every command instantly with the armed reply, so only the cost
+// of the library itself is measured.
+// -----------------------------------------------------------------------------------
+static int portRead(void* ctx, uint8_t* data, int length) {
+    int n = port.replyLen - port.replyPos;
+
+    (void)ctx;
+    if (n > length) n = length;
+    if (n > 0) {
+        memcpy(data, &port.reply[port.replyPos], n);
+        port.replyPos += n;
+    }
+    return n;
+}
+
+static int portWrite(void* ctx, const uint8_t* data, int length) {
+    (void)ctx;
+    if (port.armOnCr && memchr(data, '\r', length) != NULL) {
+        port.replyPos = 0;
+    }
+    return length;
+}
+
+static void portWait(void* ctx, bool forWrite, int timeout) {
+    (void)ctx;
+    (void)forWrite;
+    (void)timeout;
+}
+
+static void portReply(const char* reply, int length, bool armOnCr) {
+    port.reply = (const uint8_t*)reply;
+    port.replyLen = length;
+    port.replyPos = armOnCr ? length : 0;
+    port.armOnCr = armOnCr;
+}
+
+// -----------------------------------------------------------------------------------
+// Simulator capture procedure
+// -----------------------------------------------------------------------------------
+// Input : sim - Simulator, command - Command line without CR, out - Destination,
+//         size - Destination size
+// Output: int - Bytes the simulator answered with
+// -----------------------------------------------------------------------------------
+static int simCapture(rn4871Sim_t* sim, const char* command, char* out, int size) {
+    for (const char* c = command; *c; c++) {
+        simReceive(sim, (uint8_t)*c);
+    }
+    if (strcmp(command, "$$$") != 0) {
+        simReceive(sim, '\r');
+    }
+    int n = simTransmit(sim, (uint8_t*)out, size - 1);
+    out[n] = '\0';
+    return n;
+}
+
+// -----------------------------------------------------------------------------------
+// Input generation procedure
+// -----------------------------------------------------------------------------------
+// Input : services - Services to define, chars - Characteristics per service
+// Output: void
+// Defines a GATT table on the simulator and captures its AOK and LS output. The
+// last characteristic is the LS target, the worst case for the parser.
+// -----------------------------------------------------------------------------------
+static void generateInputs(int services, int chars) {
+    static rn4871Sim_t sim;
+    char command[80];
+    char scratch[CAPTURE_SIZE];
+
+    simInit(&sim);
+    simCapture(&sim, "$$$", scratch, sizeof(scratch));
+    aokLen = simCapture(&sim, "SN,Avocado", aokReply, sizeof(aokReply));
+
+    for (int s = 0; s < services; s++) {
+        snprintf(command, sizeof(command), "PS,AD11CF40%02X3F11E5BE3E0002A5D5C51B", s);
+        simCapture(&sim, command, scratch, sizeof(scratch));
+        for (int c = 0; c < chars; c++) {
+            uint8_t property = (c & 1) ? WRITE_PROPERTY : READ_PROPERTY;
+            snprintf(lsTarget, sizeof(lsTarget), "AD11CF40%02X%02X11E5BE3E0002A5D5C51B", (uint8_t)s, (uint8_t)c);
+            snprintf(command, sizeof(command), "PC,%s,%02X,04", lsTarget, property);
+            simCapture(&sim, command, scratch, sizeof(scratch));
+            lsTargetProperty = property;
+        }
+    }
+
+    lsLen = simCapture(&sim, "LS", lsReply, sizeof(lsReply));
+    lsLines = 0;
+    for (int i = 0; i < lsLen; i++) {
+        if (lsReply[i] == '\n') lsLines++;
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Synthetic listing procedure
+// -----------------------------------------------------------------------------------
+// Input : entries - Characteristics in the listing
+// Output: bool - True if the listing is ready
+// Builds an LS listing in the simulator's format with 8 characteristics per service.
+// The last characteristic is the target.
+// -----------------------------------------------------------------------------------
+static bool synthListing(uint16_t entries) {
+    if (synthReply != NULL && synthEntries == entries) return true;
+
+    free(synthReply);
+    synthReply = (char*)malloc((size_t)entries * 48 + (entries / 8 + 1) * 36 + 8);
+    if (synthReply == NULL) return false;
+
+    uint16_t handle = SIM_FIRST_HANDLE;
+    synthLen = 0;
+    synthLines = 0;
+    for (uint16_t i = 0; i < entries; i++) {
+        if (i % 8 == 0) {
+            synthLen += sprintf(&synthReply[synthLen], "AD11CF40%04X11E5BE3E0002A5D5C51B\r\n", i / 8);
+            synthLines++;
+            handle++;
+        }
+        snprintf(synthTarget, sizeof(synthTarget), "BF3FBD80%04X11E5A0620002A5D5C51B", i);
+        synthHandle = ++handle;
+        synthLen += sprintf(&synthReply[synthLen], "  %s,%04X,%02X\r\n", synthTarget, synthHandle, READ_PROPERTY);
+        synthLines++;
+    }
+    synthLen += sprintf(&synthReply[synthLen], "END\r\n");
+    synthLines++;
+    synthEntries = entries;
+    return true;
+}
+
+// -----------------------------------------------------------------------------------
+// Ring buffer benchmark
+// -----------------------------------------------------------------------------------
+// Bursts of half the ring are pushed and popped back, as the UART ISR and the
+// application do. One iteration moves BLE_BUFFER_SIZE / 2 bytes.
+// -----------------------------------------------------------------------------------
+static uint32_t benchRing(uint32_t iterations) {
+    static uint8_t storage[BLE_BUFFER_SIZE];
+    RingBuffer_t rb;
+    uint32_t sum = 0;
+    char c;
+
+    RingBuffer_init(&rb, storage, BLE_BUFFER_SIZE);
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint8_t j = 0; j < BLE_BUFFER_SIZE / 2; j++) {
+            RingBuffer_push(&rb, (char)(i + j));
+        }
+        while (RingBuffer_pop(&rb, &c)) {
+            sum += (uint8_t)c;
+        }
+    }
+    sink = sum;
+    return iterations * (BLE_BUFFER_SIZE / 2);
+}
+
+// -----------------------------------------------------------------------------------
+// Response matching benchmark
+// -----------------------------------------------------------------------------------
+// expectResponse on the AOK line of the module. One iteration is one line.
+// -----------------------------------------------------------------------------------
+static uint32_t benchExpectResponse(uint32_t iterations) {
+    uint32_t ok = 0;
+
+    portReply(aokReply, aokLen, false);
+    for (uint32_t i = 0; i < iterations; i++) {
+        port.replyPos = 0;
+        ok += expectResponse(AOK_RESP, DEFAULT_CMD_TIMEOUT);
+    }
+    sink = ok;
+    return iterations;
+}
+
+// -----------------------------------------------------------------------------------
+// LS parsing benchmark
+// -----------------------------------------------------------------------------------
+// parseLsCmd over the captured listing. Units are listing lines.
+// -----------------------------------------------------------------------------------
+static uint32_t benchParseLsCmd(uint32_t iterations) {
+    uint32_t found = 0;
+
+    portReply(lsReply, lsLen, false);
+    for (uint32_t i = 0; i < iterations; i++) {
+        port.replyPos = 0;
+        found += parseLsCmd(lsTarget, lsTargetProperty);
+    }
+    sink = found;
+    return iterations * lsLines;
+}
+
+// -----------------------------------------------------------------------------------
+// LS line parser benchmark
+// -----------------------------------------------------------------------------------
+// parseLsLine of the provisioning engine over the captured listing, split in place.
+// -----------------------------------------------------------------------------------
+static uint32_t benchParseLsLine(uint32_t iterations) {
+    static char lines[CAPTURE_SIZE];
+    char uuid[33];
+    uint16_t handle;
+    uint8_t property;
+    uint32_t found = 0;
+
+    memcpy(lines, lsReply, lsLen + 1);
+    for (char* p = lines; *p; p++) {
+        if (*p == '\r' || *p == '\n') *p = '\0';
+    }
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (int pos = 0; pos < lsLen; pos++) {
+            if (lines[pos] == '\0') continue;
+            if (parseLsLine(&lines[pos], uuid, sizeof(uuid), &handle, &property)) {
+                found += handle;
+            }
+            pos += strlen(&lines[pos]);
+        }
+    }
+    sink = found;
+    return iterations * lsLines;
+}
+
+// -----------------------------------------------------------------------------------
+// Command engine line assembly benchmark
+// -----------------------------------------------------------------------------------
+// cmdFeed of the captured listing into a pending LS command. Units are listing lines.
+// -----------------------------------------------------------------------------------
+static void engineWrite(void* ctx, const char* data, uint16_t length) {
+    (void)ctx;
+    (void)data;
+    (void)length;
+}
+
+static void engineDone(void* ctx, cmdStatus_t status, const char* line) {
+    (void)line;
+    if (status == cmdOk) (*(uint32_t*)ctx)++;
+}
+
+static uint32_t benchCmdFeed(uint32_t iterations) {
+    static cmdEngine_t engine;
+    uint32_t done = 0;
+
+    cmdInit(&engine, engineWrite, NULL);
+    for (uint32_t i = 0; i < iterations; i++) {
+        cmdSubmit(&engine, "LS", "END", cmdMatchList, DEFAULT_CMD_TIMEOUT, engineDone, &done);
+        cmdFeed(&engine, (const uint8_t*)lsReply, (uint16_t)lsLen, 0);
+    }
+    sink = done;
+    return iterations * lsLines;
+}
+
+// -----------------------------------------------------------------------------------
+// Command building benchmarks
+// -----------------------------------------------------------------------------------
+// Complete library calls against an instant AOK, so formatting, transmit queueing
+// and response matching are all included. Units are commands.
+// -----------------------------------------------------------------------------------
+static uint32_t benchSetCharactUUID(uint32_t iterations) {
+    uint32_t ok = 0;
+
+    portReply(aokReply, aokLen, true);
+    for (uint32_t i = 0; i < iterations; i++) {
+        ok += setCharactUUID(potCharUUID, READ_PROPERTY, 4);
+    }
+    sink = ok;
+    return iterations;
+}
+
+static uint32_t benchWriteLocal(uint32_t iterations) {
+    uint32_t ok = 0;
+
+    portReply(aokReply, aokLen, true);
+    for (uint32_t i = 0; i < iterations; i++) {
+        ok += writeLocalCharacteristic(0x0072, "0123");
+    }
+    sink = ok;
+    return iterations;
+}
+
+static uint32_t benchSetAdvPower(uint32_t iterations) {
+    uint32_t ok = 0;
+
+    portReply(aokReply, aokLen, true);
+    for (uint32_t i = 0; i < iterations; i++) {
+        ok += setAdvPower((uint8_t)(i % 6));
+    }
+    sink = ok;
+    return iterations;
+}
+
+// -----------------------------------------------------------------------------------
+// Serial path benchmarks
+// -----------------------------------------------------------------------------------
+// Per iteration half a ring of bytes is sent and the same amount received byte by
+// byte, once through bleSerial and its transport and once through the HAL driver on
+// the mock UART. Units are bytes moved in both directions.
+// -----------------------------------------------------------------------------------
+static uint32_t benchSerialTransport(uint32_t iterations) {
+    static const char burst[BLE_BUFFER_SIZE / 2 + 1] = "0123456789ABCDEF0123456789ABCDEF";
+    uint32_t sum = 0;
+
+    portReply(burst, BLE_BUFFER_SIZE / 2, false);
+    for (uint32_t i = 0; i < iterations; i++) {
+        port.replyPos = 0;
+        for (uint8_t j = 0; j < BLE_BUFFER_SIZE / 2; j++) {
+            blePrint((uint8_t)burst[j]);
+        }
+        while (bleAvailable()) {
+            sum += (uint8_t)bleRead();
+        }
+    }
+    sink = sum;
+    return iterations * BLE_BUFFER_SIZE;
+}
+
+static uint32_t benchSerialDriverMock(uint32_t iterations) {
+    typedef BleSerialDriver<MockUart, MockClock> mockDriver;
+    static const uint8_t burst[BLE_BUFFER_SIZE / 2 + 1] = "0123456789ABCDEF0123456789ABCDEF";
+    static ble_uart_t mockBle;
+    uint32_t sum = 0;
+
+    mockDriver::init(mockBle);
+    for (uint32_t i = 0; i < iterations; i++) {
+        MockUart::inject(burst, BLE_BUFFER_SIZE / 2);
+        for (uint8_t j = 0; j < BLE_BUFFER_SIZE / 2; j++) {
+            mockDriver::write(mockBle, burst[j]);
+        }
+        while (mockDriver::available(mockBle)) {
+            sum += (uint8_t)mockDriver::read(mockBle);
+        }
+    }
+    sink = sum + MockUart::state().sent;
+    return iterations * BLE_BUFFER_SIZE;
+}
+
+// -----------------------------------------------------------------------------------
+// LS scaling benchmarks
+// -----------------------------------------------------------------------------------
+// The streaming parser alone and parseLsCmd through the serial path, over synthetic
+// listings of growing size. A flat rate means cost is linear in the listing length.
+// -----------------------------------------------------------------------------------
+static uint32_t benchLsParserScaling(uint32_t iterations) {
+    lsParser_t parser;
+    uint32_t found = 0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        lsParserInit(&parser, synthTarget, READ_PROPERTY);
+        for (int j = 0; j < synthLen && !lsParserFeed(&parser, synthReply[j]); j++);
+        found += parser.found;
+    }
+    sink = found;
+    return iterations * synthLines;
+}
+
+static uint32_t benchParseLsScaling(uint32_t iterations) {
+    uint32_t found = 0;
+
+    portReply(synthReply, synthLen, false);
+    for (uint32_t i = 0; i < iterations; i++) {
+        port.replyPos = 0;
+        found += parseLsCmd(synthTarget, READ_PROPERTY);
+    }
+    sink = found;
+    return iterations * synthLines;
+}
+
+static const bench_t benches[] = {
+    { "ring_push_pop",        "bytes/s", benchRing, 0 },
+    { "expect_response",      "lines/s", benchExpectResponse, 0 },
+    { "parse_ls_cmd",         "lines/s", benchParseLsCmd, 0 },
+    { "parse_ls_line",        "lines/s", benchParseLsLine, 0 },
+    { "cmd_feed_ls",          "lines/s", benchCmdFeed, 0 },
+    { "set_charact_uuid",     "cmds/s",  benchSetCharactUUID, 0 },
+    { "write_local_charact",  "cmds/s",  benchWriteLocal, 0 },
+    { "set_adv_power",        "cmds/s",  benchSetAdvPower, 0 },
+    { "serial_transport",     "bytes/s", benchSerialTransport, 0 },
+    { "serial_driver_mock",   "bytes/s", benchSerialDriverMock, 0 },
+    { "ls_parser_scaling",    "lines/s", benchLsParserScaling, 16 },
+    { "ls_parser_scaling",    "lines/s", benchLsParserScaling, 256 },
+    { "ls_parser_scaling",    "lines/s", benchLsParserScaling, 4096 },
+    { "parse_ls_scaling",     "lines/s", benchParseLsScaling, 16 },
+    { "parse_ls_scaling",     "lines/s", benchParseLsScaling, 256 },
+    { "parse_ls_scaling",     "lines/s", benchParseLsScaling, 4096 },
+};
+
+// -----------------------------------------------------------------------------------
+// Run benchmark procedure
+// -----------------------------------------------------------------------------------
+// Input : bench - Benchmark, minMs - Minimum measured wall time
+// Output: void
+// Doubles the iteration count until one batch takes at least minMs, then reports it.
+// -----------------------------------------------------------------------------------
+static void runBench(const bench_t* bench, double minMs) {
+    uint32_t iterations = 1;
+    uint32_t units;
+    double elapsed;
+
+    if (bench->entries > 0) {
+        if (!synthListing(bench->entries)) return;
+        portReply(synthReply, synthLen, false);
+        if (parseLsCmd(synthTarget, READ_PROPERTY) != synthHandle) {
+            fprintf(stderr, "microBench: %s missed the target of %u entries\n", bench->name, bench->entries);
+            return;
+        }
+    }
+
+    bench->run(iterations); // Warm up
+    for (;;) {
+        double start = wallMillis();
+        units = bench->run(iterations);
+        elapsed = wallMillis() - start;
+        if (elapsed >= minMs || iterations >= 0x40000000UL) break;
+        iterations *= 2;
+    }
+
+    printf("{\"bench\":\"%s\",", bench->name);
+    if (bench->entries > 0) {
+        printf("\"entries\":%u,", bench->entries);
+    }
+    printf("\"unit\":\"%s\",\"rate\":%.0f,\"ns_per_iteration\":%.1f,"
+           "\"iterations\":%lu,\"wall_ms\":%.1f}\n",
+           bench->unit, units * 1000.0 / elapsed, elapsed * 1e6 / iterations,
+           (unsigned long)iterations, elapsed);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    double minMs = 200;
+    int services = 4;
+    int chars = 4;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:c:")) != -1) {
+        switch (opt) {
+            case 't': minMs = atof(optarg); break;
+            case 's': services = atoi(optarg); break;
+            case 'c': chars = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-t min_ms] [-s services] [-c chars_per_service] [filter]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    const char* filter = optind < argc ? argv[optind] : NULL;
+
+    if (services < 1 || chars < 1 || services * (chars + 1) > SIM_MAX_ATTRIBUTES) {
+        fprintf(stderr, "microBench: at most %d attributes\n", SIM_MAX_ATTRIBUTES);
+        return EXIT_FAILURE;
+    }
+    generateInputs(services, chars);
+
+    transport.read = portRead;
+    transport.write = portWrite;
+    transport.wait = portWait;
+    transport.ctx = &port;
+    vclockInit(&virtualClock); // No waits happen, only keeps millis() off the syscall path
+    vclockInstall(&virtualClock);
+    bleSetTransport(&transport);
+    setOperationMode(cmdMode);
+
+    portReply(lsReply, lsLen, false);
+    if (parseLsCmd(lsTarget, lsTargetProperty) == 0) {
+        fprintf(stderr, "microBench: target not found in the captured listing\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("{\"suite\":\"microBench\",\"min_ms\":%.0f,\"ls_lines\":%lu,\"ls_bytes\":%d}\n",
+           minMs, (unsigned long)lsLines, lsLen);
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (filter == NULL || strstr(benches[i].name, filter) != NULL) {
+            runBench(&benches[i], minMs);
+        }
+    }
+
+    bleSetTransport(NULL);
+    vclockUninstall(&virtualClock);
+    free(synthReply);
+    return EXIT_SUCCESS;
+}
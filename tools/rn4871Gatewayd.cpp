@@ -0,0 +1,173 @@
+/*
+ * rn4871Gatewayd.cpp
+ *
+ * Created: 18-10-2026 05:56:19
+ * Author: Subrata
+ * Description: Gateway daemon for the Linux port. Drives every RN4871 module given
+ *              on the command line from a single epoll loop, puts each one into
+ *              command mode, polls its connection status periodically and prints
+ *              the aggregated events of all modules on stdout. With -l the traffic
+ *              and a statistics snapshot per poll go to a binary trace log; with -x
+ *              the module counters are published as a Prometheus text file.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/rn4871Gatewayd.cpp src/cmdEngine.cpp
+ *        src/ringBuffer.cpp src/host/gateway.cpp src/host/traceLog.cpp
+ *        src/host/metrics.cpp src/host/bleSerialHost.cpp src/host/wiringHost.cpp -pthread
+ *        -o rn4871Gatewayd
+ * Usage: rn4871Gatewayd [-p poll_ms] [-l trace_dir] [-x metrics_file] device [device ...]
+ */
+
+#include "gateway.h"
+#include "metrics.h"
+#include "rn4871_const.h"
+#include "traceLog.h"
+#include "wiring.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Silence required before the $$$ sequence
+#define GUARD_TIME       100
+// Default interval between connection status polls
+#define DEFAULT_POLL_MS  5000
+
+static gateway_t gw;
+static traceLog_t trace;
+static metricsExporter_t metrics;
+static volatile sig_atomic_t running = 1;
+
+// -----------------------------------------------------------------------------------
+// Signal handler procedure
+// -----------------------------------------------------------------------------------
+// Input : sig - Signal number
+// Output: void
+// -----------------------------------------------------------------------------------
+static void onSignal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+// -----------------------------------------------------------------------------------
+// Command mode result procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Module id, status - Result, line - Response line
+// Output: void
+// -----------------------------------------------------------------------------------
+static void onCommandMode(void* ctx, cmdStatus_t status, const char* line) {
+    uintptr_t id = (uintptr_t)ctx;
+    (void)line;
+    printf("%u cmd %s\n", (unsigned)id, status == cmdOk ? "ready" : "failed");
+}
+
+// -----------------------------------------------------------------------------------
+// Status result procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Module id, status - Result, line - Response line
+// Output: void
+// Reports the peer address returned by GK, or "none" if no central is connected.
+// -----------------------------------------------------------------------------------
+static void onStatus(void* ctx, cmdStatus_t status, const char* line) {
+    uintptr_t id = (uintptr_t)ctx;
+    if (status == cmdOk || status == cmdError) {
+        printf("%u status %s\n", (unsigned)id, line);
+    } else if (status == cmdTimeout) {
+        printf("%u status timeout\n", (unsigned)id);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t pollPeriod = DEFAULT_POLL_MS;
+    const char* traceDir = NULL;
+    const char* metricsFile = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:l:x:")) != -1) {
+        if (opt == 'p') {
+            pollPeriod = (uint32_t)strtoul(optarg, NULL, 10);
+        } else if (opt == 'l') {
+            traceDir = optarg;
+        } else if (opt == 'x') {
+            metricsFile = optarg;
+        } else {
+            fprintf(stderr, "usage: %s [-p poll_ms] [-l trace_dir] [-x metrics_file] device [device ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || !gatewayInit(&gw)) {
+        fprintf(stderr, "usage: %s [-p poll_ms] [-l trace_dir] [-x metrics_file] device [device ...]\n", argv[0]);
+        return 1;
+    }
+    if (traceDir != NULL) {
+        if (!traceLogOpen(&trace, traceDir, 0)) {
+            fprintf(stderr, "cannot create trace log in %s\n", traceDir);
+            return 1;
+        }
+        gatewaySetTrace(&gw, &trace);
+    }
+    if (metricsFile != NULL && !metricsStart(&metrics, metricsFile, 0)) {
+        fprintf(stderr, "cannot start metrics exporter for %s\n", metricsFile);
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        int id = gatewayOpen(&gw, argv[i]);
+        if (id < 0) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            continue;
+        }
+        printf("%d open %s\n", id, argv[i]);
+    }
+    if (gw.moduleCount == 0) return 1;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    delay(GUARD_TIME); // One guard time covers all modules
+    for (uint16_t id = 0; id < gw.moduleCount; id++) {
+        gatewayEnterCommandMode(&gw, id, onCommandMode, (void*)(uintptr_t)id);
+    }
+
+    uint32_t lastPoll = millis();
+    while (running) {
+        uint32_t elapsed = millis() - lastPoll;
+        int wait = elapsed >= pollPeriod ? 0 : (int)(pollPeriod - elapsed);
+        if (gatewayRun(&gw, wait) < 0) {
+            continue; // Interrupted by a signal
+        }
+
+        gatewayEvent_t event;
+        while (gatewayPopEvent(&gw, &event)) {
+            printf("%u %lu event %s\n", event.module, (unsigned long)event.time, event.text);
+        }
+        metricsCapture(&metrics, &gw); // At most once per metrics interval
+
+        if (millis() - lastPoll >= pollPeriod) {
+            lastPoll = millis();
+            gatewayTraceStats(&gw);
+            for (uint16_t id = 0; id < gw.moduleCount; id++) {
+                rn4871_t* module = gatewayModule(&gw, id);
+                if (module->fd >= 0 && cmdIdle(&module->engine)) {
+                    gatewaySubmit(&gw, id, GET_CONNECTION_STATUS, NULL, cmdMatchLine,
+                                  DEFAULT_CMD_TIMEOUT, onStatus, (void*)(uintptr_t)id);
+                }
+            }
+        }
+    }
+
+    for (uint16_t id = 0; id < gw.moduleCount; id++) {
+        rn4871_t* module = gatewayModule(&gw, id);
+        const cmdStats_t* stats = &module->engine.stats;
+        fprintf(stderr, "%u commands=%lu errors=%lu timeouts=%lu events=%lu rx=%lu tx=%lu\n", id,
+                (unsigned long)stats->commands, (unsigned long)stats->errors,
+                (unsigned long)stats->timeouts, (unsigned long)stats->events,
+                (unsigned long)module->rxBytes, (unsigned long)module->txBytes);
+    }
+    gatewayTraceStats(&gw);
+    if (metricsFile != NULL) metricsStop(&metrics);
+    gatewayClose(&gw);
+    if (traceDir != NULL) traceLogClose(&trace);
+    return 0;
+}
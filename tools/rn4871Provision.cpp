@@ -0,0 +1,262 @@
+/*
+ * rn4871Provision.cpp
+ *
+ * Created: 18-10-2026 06:00:06
+ * Author: Subrata
+ * Description: Production line provisioning tool for the Linux port. Configures
+ *              the modules on all given serial ports concurrently, spreading the
+ *              ports over worker threads that each run their own gateway loop,
+ *              verifies every GATT table with one LS listing and writes one JSON
+ *              report line per unit. With -s it provisions simulated modules.
+ *
+ * Build: g++ -O2 -pthread -Isrc -Isrc/host tools/rn4871Provision.cpp src/cmdEngine.cpp
+ *        src/ringBuffer.cpp src/host/provision.cpp src/host/gateway.cpp src/host/traceLog.cpp
+ *        src/host/bleSerialHost.cpp src/host/wiringHost.cpp src/host/rn4871Sim.cpp
+ *        -o rn4871Provision
+ * Usage: rn4871Provision [-j workers] [-r report] [-n name] [-s count [-b boot_ms]] [device ...]
+ */
+
+#include "provision.h"
+#include "rn4871Sim.h"
+#include "rn4871_const.h"
+#include "wiring.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Maximum number of ports per station
+#define MAX_UNITS    256
+// Maximum number of worker threads
+#define MAX_WORKERS  16
+// Report line size
+#define REPORT_SIZE  512
+
+typedef struct {
+    pthread_t thread;               // Worker thread
+    uint16_t index;                 // Worker number
+    uint16_t workers;               // Total workers, ports are assigned round robin
+} worker_t;
+
+static const char* devices[MAX_UNITS];
+static int deviceCount;
+static provUnit_t units[MAX_UNITS];
+static FILE* report;
+static pthread_mutex_t reportLock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t passed, failed;
+
+// Profile of the readPot_writeBtn example
+static provProfile_t profile = {
+    "Avocado",
+    "AD11CF40063F11E5BE3E0002A5D5C51B",
+    {
+        { "AD11CF40163F11E5BE3E0002A5D5C51B", READ_PROPERTY, 4 },
+        { "AD11CF40363F11E5BE3E0002A5D5C51B", WRITE_PROPERTY, 1 }
+    },
+    2,
+    0
+};
+
+// -----------------------------------------------------------------------------------
+// Write report procedure
+// -----------------------------------------------------------------------------------
+// Input : unit - Finished unit or NULL if the port could not be opened,
+//         device - Port of the unit
+// Output: void
+// Appends the unit's report line; shared by all workers.
+// -----------------------------------------------------------------------------------
+static void writeReport(const provUnit_t* unit, const char* device) {
+    char line[REPORT_SIZE];
+
+    if (unit != NULL) {
+        provisionReport(unit, device, line, sizeof(line));
+    } else {
+        snprintf(line, sizeof(line), "{\"device\":\"%s\",\"result\":\"failed\",\"failed_step\":\"open\"}", device);
+    }
+
+    pthread_mutex_lock(&reportLock);
+    fprintf(report, "%s\n", line);
+    fflush(report);
+    if (unit != NULL && unit->result == provPassed) {
+        passed++;
+    } else {
+        failed++;
+    }
+    pthread_mutex_unlock(&reportLock);
+}
+
+// -----------------------------------------------------------------------------------
+// Worker thread procedure
+// -----------------------------------------------------------------------------------
+// Input : arg - Worker descriptor
+// Output: void* - NULL
+// Opens the worker's ports on a private gateway and provisions them concurrently.
+// -----------------------------------------------------------------------------------
+static void* workerMain(void* arg) {
+    worker_t* worker = (worker_t*)arg;
+    gateway_t* gw = (gateway_t*)malloc(sizeof(gateway_t));
+    int unitOf[GATEWAY_MAX_MODULES];
+    bool reported[GATEWAY_MAX_MODULES] = { false };
+    int pending = 0;
+
+    if (gw == NULL || !gatewayInit(gw)) {
+        free(gw);
+        return NULL;
+    }
+    for (int i = worker->index; i < deviceCount; i += worker->workers) {
+        int id = gatewayOpen(gw, devices[i]);
+        if (id < 0) {
+            writeReport(NULL, devices[i]);
+            continue;
+        }
+        unitOf[id] = i;
+        pending++;
+    }
+
+    delay(DELAY_BEFORE_CMD); // One guard time before $$$ covers all ports
+    for (uint16_t id = 0; id < gw->moduleCount; id++) {
+        provisionStart(&units[unitOf[id]], gw, id, &profile);
+    }
+
+    while (pending > 0) {
+        gatewayRun(gw, 10);
+
+        gatewayEvent_t event;
+        while (gatewayPopEvent(gw, &event)) {
+            provisionEvent(&units[unitOf[event.module]], event.text);
+        }
+
+        uint32_t now = millis();
+        for (uint16_t id = 0; id < gw->moduleCount; id++) {
+            provUnit_t* unit = &units[unitOf[id]];
+            provisionTask(unit, now);
+            if (unit->result != provRunning && !reported[id]) {
+                reported[id] = true;
+                writeReport(unit, devices[unitOf[id]]);
+                pending--;
+            }
+        }
+    }
+
+    gatewayClose(gw);
+    free(gw);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------------
+// Start simulators procedure
+// -----------------------------------------------------------------------------------
+// Input : count - Number of simulated modules, bootTime - Simulated reboot time in ms,
+//         paths - Receives the terminal paths, slaves - Receives terminal descriptors
+// Output: pid_t - Simulator process or -1 on failure
+// Serves the simulated modules from a child process. The terminal sides stay open in
+// the parent until provisioning ends so the simulators never see a hangup.
+// -----------------------------------------------------------------------------------
+static pid_t startSimulators(int count, uint16_t bootTime, char paths[][64], int* slaves) {
+    static rn4871Sim_t sims[MAX_UNITS];
+    static int masters[MAX_UNITS];
+
+    for (int i = 0; i < count; i++) {
+        simInit(&sims[i]);
+        sims[i].rebootTime = bootTime;
+        snprintf(sims[i].mac, sizeof(sims[i].mac), "0011223344%02X", i & 0xFF);
+        masters[i] = simOpenPty(paths[i], 64);
+        if (masters[i] < 0) return -1;
+        slaves[i] = open(paths[i], O_RDWR | O_NOCTTY);
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        simServeMany(sims, masters, count);
+        _exit(0);
+    }
+    for (int i = 0; i < count; i++) {
+        close(masters[i]);
+    }
+    return child;
+}
+
+int main(int argc, char** argv) {
+    static char simPaths[MAX_UNITS][64];
+    static int simSlaves[MAX_UNITS];
+    static worker_t workers[MAX_WORKERS];
+    const char* reportPath = NULL;
+    int workerCount = 0, simCount = 0;
+    uint16_t bootTime = 0;
+    pid_t simulator = -1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:r:n:s:b:")) != -1) {
+        switch (opt) {
+            case 'j': workerCount = atoi(optarg); break;
+            case 'r': reportPath = optarg; break;
+            case 'n': profile.name = optarg; break;
+            case 's': simCount = atoi(optarg); break;
+            case 'b': bootTime = (uint16_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-j workers] [-r report] [-n name] [-s count [-b boot_ms]] [device ...]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (simCount > MAX_UNITS) simCount = MAX_UNITS;
+    if (simCount > 0) {
+        simulator = startSimulators(simCount, bootTime, simPaths, simSlaves);
+        if (simulator < 0) {
+            fprintf(stderr, "rn4871Provision: cannot create simulated modules\n");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < simCount; i++) {
+            devices[deviceCount++] = simPaths[i];
+        }
+    }
+    for (int i = optind; i < argc && deviceCount < MAX_UNITS; i++) {
+        devices[deviceCount++] = argv[i];
+    }
+    if (deviceCount == 0) {
+        fprintf(stderr, "rn4871Provision: no ports given\n");
+        return EXIT_FAILURE;
+    }
+
+    report = reportPath != NULL ? fopen(reportPath, "w") : stdout;
+    if (report == NULL) {
+        perror("rn4871Provision: report");
+        return EXIT_FAILURE;
+    }
+
+    // Each worker gateway holds up to GATEWAY_MAX_MODULES ports
+    int minWorkers = (deviceCount + GATEWAY_MAX_MODULES - 1) / GATEWAY_MAX_MODULES;
+    if (workerCount <= 0) workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workerCount > deviceCount) workerCount = deviceCount;
+    if (workerCount > MAX_WORKERS) workerCount = MAX_WORKERS;
+    if (workerCount < minWorkers) workerCount = minWorkers;
+
+    uint32_t start = millis();
+    for (int i = 0; i < workerCount; i++) {
+        workers[i].index = (uint16_t)i;
+        workers[i].workers = (uint16_t)workerCount;
+        pthread_create(&workers[i].thread, NULL, workerMain, &workers[i]);
+    }
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    uint32_t elapsed = millis() - start;
+
+    fprintf(stderr, "{\"units\":%d,\"passed\":%u,\"failed\":%u,\"workers\":%d,\"elapsed_ms\":%u,\"units_per_min\":%.0f}\n",
+            deviceCount, passed, failed, workerCount, elapsed,
+            elapsed > 0 ? deviceCount * 60000.0 / elapsed : 0.0);
+
+    if (simulator > 0) {
+        kill(simulator, SIGTERM);
+        waitpid(simulator, NULL, 0);
+        for (int i = 0; i < simCount; i++) {
+            close(simSlaves[i]);
+        }
+    }
+    if (report != stdout) fclose(report);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,60 @@
+/*
+ * rn4871SelfTest.cpp
+ *
+ * Created: 18-10-2026 06:52:12
+ * Author: Subrata
+ * Description: Host runner of the library self-benchmark. Opens a module port, or
+ *              the pseudo-terminal of rn4871Sim started with --echo, brings the
+ *              module into command mode and prints the loopback throughput, the SHW
+ *              and GK latency histograms and the buffer high-water marks exactly as
+ *              the firmware would log them.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/rn4871SelfTest.cpp src/selfTest.cpp src/rn4871.cpp
+ *        src/lsParser.cpp src/ringBuffer.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o rn4871SelfTest
+ * Usage: rn4871SelfTest [-b loopback_bytes] [-r rounds] device handle
+ *        handle is the hexadecimal handle of a local characteristic written by SHW.
+ */
+
+#include "rn4871.h"
+#include "bleSerial.h"
+#include "selfTest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    uint16_t bytes = 1024;
+    uint8_t rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:r:")) != -1) {
+        switch (opt) {
+            case 'b': bytes = (uint16_t)strtoul(optarg, NULL, 10); break;
+            case 'r': rounds = (uint8_t)strtoul(optarg, NULL, 10); break;
+            default: optind = argc + 1; break;
+        }
+    }
+    if (optind + 2 != argc) {
+        fprintf(stderr, "usage: %s [-b loopback_bytes] [-r rounds] device handle\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bleSetDevice(argv[optind]);
+    bleInit();
+    if (!ble.initialized) {
+        fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if (probeModule() == moduleSilent || !enterCommandMode()) {
+        fprintf(stderr, "module does not answer\n");
+        return EXIT_FAILURE;
+    }
+
+    selfTestStats_t stats;
+    char text[512];
+    bool ok = selfTestRun(&stats, (uint16_t)strtoul(argv[optind + 1], NULL, 16), bytes, rounds);
+    selfTestFormat(&stats, text, sizeof(text));
+    fputs(text, stdout);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
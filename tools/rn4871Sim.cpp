@@ -0,0 +1,83 @@
+/*
+ * rn4871Sim.cpp
+ *
+ * Created: 18-10-2026 05:51:34
+ * Author: Subrata
+ * Description: Command line RN4871 simulator for the Linux port. Opens a
+ *              pseudo-terminal pair, prints the path of the terminal to connect
+ *              the library to and serves the simulated module on the other end.
+ *
+ * Build: g++ -Isrc -Isrc/host tools/rn4871Sim.cpp src/host/rn4871Sim.cpp
+ *        src/host/session.cpp src/host/vclock.cpp src/host/bleSerialHost.cpp
+ *        src/ringBuffer.cpp src/host/wiringHost.cpp -o rn4871Sim
+ * Usage: rn4871Sim [--echo] [--boot ms] [--record session]
+ */
+
+#include "rn4871Sim.h"
+#include "session.h"
+#include "wiring.h"
+#include <signal.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static sessionRecorder_t recorder;
+
+// -----------------------------------------------------------------------------------
+// Signal handler procedure
+// -----------------------------------------------------------------------------------
+// Input : sig - Signal number
+// Output: void
+// Completes the session file before exiting.
+// -----------------------------------------------------------------------------------
+static void onSignal(int sig) {
+    (void)sig;
+    sessionRecordClose(&recorder);
+    _exit(EXIT_SUCCESS);
+}
+
+int main(int argc, char** argv) {
+    static rn4871Sim_t sim;
+    char slavePath[64];
+
+    simInit(&sim);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--echo") == 0) {
+            sim.echoData = true; // Loop data mode bytes back
+        } else if (strcmp(argv[i], "--boot") == 0 && i + 1 < argc) {
+            sim.rebootTime = (uint16_t)atoi(argv[++i]); // Realistic reboot duration
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            if (!sessionRecordOpen(&recorder, argv[++i])) {
+                perror("rn4871Sim: record");
+                return EXIT_FAILURE;
+            }
+            sim.tap = sessionTap; // Capture the served byte stream
+            sim.tapCtx = &recorder;
+        }
+    }
+
+    int master = simOpenPty(slavePath, sizeof(slavePath));
+    if (master < 0) {
+        perror("rn4871Sim: posix_openpt");
+        return EXIT_FAILURE;
+    }
+    printf("%s\n", slavePath);
+    fflush(stdout);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    while (1) {
+        struct pollfd pfd = { master, (short)(POLLIN | (simPending(&sim) > 0 ? POLLOUT : 0)), 0 };
+        if (poll(&pfd, 1, simTimeToEvent(&sim, millis())) < 0) break;
+        simTask(&sim, millis());
+        if (pfd.revents & POLLHUP) {
+            usleep(10000); // No terminal side open yet
+        }
+        if (!simServe(&sim, master)) break;
+    }
+    sessionRecordClose(&recorder);
+    close(master);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+/*
+ * rn4871Trace.cpp
+ *
+ * Created: 18-10-2026 06:27:02
+ * Author: Subrata
+ * Description: Reader of the binary trace log written by the gateway. Maps each
+ *              segment read-only, uses the segment times and the per-block index to
+ *              seek to the requested time window and to skip blocks holding nothing
+ *              of the requested module, then prints the records as text or a
+ *              per-module summary as JSON lines. Live segments can be read while the
+ *              gateway is still writing them.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/rn4871Trace.cpp -o rn4871Trace
+ * Usage: rn4871Trace [-m module] [-f from_ms] [-u until_ms] [-t type] [-s] directory
+ *        Times are ms since the start of the oldest segment; types are rx, tx, event,
+ *        command, connection and stats.
+ */
+
+#include "traceLog.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_SEGMENTS 4096
+#define ANY_MODULE   -1
+
+static const char* typeNames[] = { "?", "rx", "tx", "event", "command", "connection", "stats" };
+static const char* statusNames[] = { "pending", "ok", "error", "timeout" };
+
+typedef struct {
+    uint64_t rxBytes;      // Received bytes
+    uint64_t txBytes;      // Transmitted bytes
+    uint32_t events;       // Events
+    uint32_t commands;     // Completed commands
+    uint32_t failures;     // Commands not ok
+    uint64_t latencyTotal; // Sum of round trips
+    uint32_t latencyMax;   // Longest round trip
+    uint32_t connections;  // Connections established
+    bool seen;             // Module has records in the window
+} moduleSummary_t;
+
+typedef struct {
+    int module;             // Module filter or ANY_MODULE
+    int type;               // Type filter or 0
+    uint64_t from;          // Window start, ms since the trace start
+    uint64_t until;         // Window end, ms since the trace start
+    bool summary;           // Summarize instead of printing records
+    uint32_t blocksRead;    // Index blocks scanned
+    uint32_t blocksSkipped; // Index blocks skipped by the module bitmap
+    uint32_t records;       // Records matched
+    moduleSummary_t modules[64];
+} query_t;
+
+static query_t query;
+
+// -----------------------------------------------------------------------------------
+// Compare segment numbers procedure
+// -----------------------------------------------------------------------------------
+// Input : a, b - Segment numbers
+// Output: int - qsort ordering
+// -----------------------------------------------------------------------------------
+static int compareNumbers(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// -----------------------------------------------------------------------------------
+// Print bytes procedure
+// -----------------------------------------------------------------------------------
+// Input : data - Payload, length - Byte count
+// Output: void
+// Prints traffic as a quoted string with control characters escaped.
+// -----------------------------------------------------------------------------------
+static void printBytes(const uint8_t* data, uint16_t length) {
+    putchar('"');
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (c == '\r') fputs("\\r", stdout);
+        else if (c == '\n') fputs("\\n", stdout);
+        else if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (isprint(c)) putchar(c);
+        else printf("\\x%02X", c);
+    }
+    putchar('"');
+}
+
+// -----------------------------------------------------------------------------------
+// Handle record procedure
+// -----------------------------------------------------------------------------------
+// Input : record - Record header, time - ms since the trace start
+// Output: void
+// Prints one record or adds it to the module summary.
+// -----------------------------------------------------------------------------------
+static void handleRecord(const traceRecord_t* record, uint64_t time) {
+    const uint8_t* payload = (const uint8_t*)(record + 1);
+    uint32_t latency = 0;
+
+    if (record->type == traceCommand && record->length >= sizeof(latency)) {
+        memcpy(&latency, payload, sizeof(latency));
+    }
+    query.records++;
+
+    if (query.summary) {
+        if (record->module >= 64) return;
+        moduleSummary_t* summary = &query.modules[record->module];
+        summary->seen = true;
+        switch (record->type) {
+            case traceRx: summary->rxBytes += record->length; break;
+            case traceTx: summary->txBytes += record->length; break;
+            case traceEvent: summary->events++; break;
+            case traceCommand:
+                summary->commands++;
+                if (record->flags != 1) summary->failures++; // cmdOk
+                summary->latencyTotal += latency;
+                if (latency > summary->latencyMax) summary->latencyMax = latency;
+                break;
+            case traceConnection:
+                if (record->flags) summary->connections++;
+                break;
+        }
+        return;
+    }
+
+    printf("%llu %u %s ", (unsigned long long)time, record->module,
+           record->type < sizeof(typeNames) / sizeof(typeNames[0]) ? typeNames[record->type] : "?");
+    switch (record->type) {
+        case traceRx:
+        case traceTx:
+            printBytes(payload, record->length);
+            break;
+        case traceEvent:
+            printf("%.*s", record->length, (const char*)payload);
+            break;
+        case traceCommand:
+            printf("%s %ums ", record->flags < 4 ? statusNames[record->flags] : "?", latency);
+            if (record->length >= sizeof(latency)) {
+                printBytes(payload + sizeof(latency), record->length - sizeof(latency));
+            }
+            break;
+        case traceConnection:
+            fputs(record->flags ? "connected" : "disconnected", stdout);
+            break;
+        case traceStats:
+            if (record->length >= sizeof(traceStats_t)) {
+                traceStats_t stats;
+                memcpy(&stats, payload, sizeof(stats));
+                printf("commands=%u errors=%u timeouts=%u events=%u latency_max=%u rx=%u tx=%u dropped=%u",
+                       stats.commands, stats.errors, stats.timeouts, stats.events, stats.latencyMax,
+                       stats.rxBytes, stats.txBytes, stats.txDropped);
+            }
+            break;
+    }
+    putchar('\n');
+}
+
+// -----------------------------------------------------------------------------------
+// Scan segment procedure
+// -----------------------------------------------------------------------------------
+// Input : base - Segment mapping, origin - Segment start in ms since the trace start
+// Output: bool - False once the window end has been passed
+// Binary-searches the index for the block holding the window start, then walks the
+// blocks in order, skipping those without the requested module.
+// -----------------------------------------------------------------------------------
+static bool scanSegment(const uint8_t* base, uint64_t origin) {
+    const traceSegmentHeader_t* header = (const traceSegmentHeader_t*)base;
+    uint32_t recordEnd = __atomic_load_n(&header->recordEnd, __ATOMIC_ACQUIRE);
+    const traceIndex_t* index = (const traceIndex_t*)(base + header->size);
+    uint32_t count = header->indexCount;
+
+    if (count == 0 || origin + header->lastTime < query.from) return true;
+    if (origin + header->firstTime > query.until) return false;
+
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (high - low > 1) { // Last block starting at or before the window start
+        uint32_t mid = (low + high) / 2;
+        if (origin + index[-(int32_t)mid - 1].time <= query.from) low = mid;
+        else high = mid;
+    }
+
+    for (uint32_t i = low; i < count; i++) {
+        const traceIndex_t* block = &index[-(int32_t)i - 1];
+        uint32_t end = i + 1 < count ? index[-(int32_t)i - 2].offset : recordEnd;
+
+        if (origin + block->time > query.until) return false;
+        if (query.module != ANY_MODULE && !(block->modules & (1ULL << query.module))) {
+            query.blocksSkipped++;
+            continue;
+        }
+        query.blocksRead++;
+        for (uint32_t offset = block->offset; offset + sizeof(traceRecord_t) <= end;) {
+            const traceRecord_t* record = (const traceRecord_t*)(base + offset);
+            uint32_t size = (sizeof(traceRecord_t) + record->length + 3) & ~3U;
+            if (offset + size > end) break; // Torn record of a crashed writer
+            offset += size;
+
+            uint64_t time = origin + record->time;
+            if (time < query.from) continue;
+            if (time > query.until) return false;
+            if (query.module != ANY_MODULE && record->module != query.module) continue;
+            if (query.type != 0 && record->type != query.type) continue;
+            handleRecord(record, time);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    static uint32_t numbers[MAX_SEGMENTS];
+    uint32_t segments = 0;
+    int opt;
+
+    query.module = ANY_MODULE;
+    query.until = UINT64_MAX;
+    while ((opt = getopt(argc, argv, "m:f:u:t:s")) != -1) {
+        switch (opt) {
+            case 'm': query.module = atoi(optarg); break;
+            case 'f': query.from = strtoull(optarg, NULL, 10); break;
+            case 'u': query.until = strtoull(optarg, NULL, 10); break;
+            case 's': query.summary = true; break;
+            case 't':
+                for (int t = 1; t < (int)(sizeof(typeNames) / sizeof(typeNames[0])); t++) {
+                    if (strcmp(optarg, typeNames[t]) == 0) query.type = t;
+                }
+                if (query.type != 0) break;
+                /* fall through */
+            default:
+                fprintf(stderr, "usage: %s [-m module] [-f from_ms] [-u until_ms] [-t type] [-s] directory\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc || query.module < ANY_MODULE || query.module >= 64) {
+        fprintf(stderr, "usage: %s [-m module] [-f from_ms] [-u until_ms] [-t type] [-s] directory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* dir = argv[optind];
+    DIR* d = opendir(dir);
+    if (d == NULL) {
+        perror(dir);
+        return EXIT_FAILURE;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL && segments < MAX_SEGMENTS) {
+        unsigned number;
+        char suffix[8];
+        if (sscanf(entry->d_name, "trace-%u.%7s", &number, suffix) == 2 && strcmp(suffix, "rnt") == 0) {
+            numbers[segments++] = number;
+        }
+    }
+    closedir(d);
+    qsort(numbers, segments, sizeof(numbers[0]), compareNumbers);
+
+    bool haveStart = false;
+    uint64_t traceStart = 0;
+    for (uint32_t s = 0; s < segments; s++) {
+        char path[TRACE_PATH_SIZE + 32];
+        struct stat st;
+
+        snprintf(path, sizeof(path), TRACE_FILE_FORMAT, dir, numbers[s]);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(traceSegmentHeader_t)) {
+            if (fd >= 0) close(fd);
+            continue;
+        }
+        void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) continue;
+
+        const traceSegmentHeader_t* header = (const traceSegmentHeader_t*)map;
+        bool valid = memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) == 0 &&
+                     header->version == TRACE_VERSION && header->size <= (uint64_t)st.st_size &&
+                     header->indexCount * sizeof(traceIndex_t) < header->size;
+        bool more = true;
+        if (valid) {
+            if (!haveStart) {
+                traceStart = header->startUnixMs;
+                haveStart = true;
+            }
+            uint64_t origin = header->startUnixMs > traceStart ? header->startUnixMs - traceStart : 0;
+            more = scanSegment((const uint8_t*)map, origin);
+        }
+        munmap(map, st.st_size);
+        if (!more) break;
+    }
+
+    if (query.summary) {
+        for (int m = 0; m < 64; m++) {
+            const moduleSummary_t* summary = &query.modules[m];
+            if (!summary->seen) continue;
+            printf("{\"module\":%d,\"rx_bytes\":%llu,\"tx_bytes\":%llu,\"events\":%u,\"commands\":%u,"
+                   "\"failures\":%u,\"latency_mean_ms\":%.2f,\"latency_max_ms\":%u,\"connections\":%u}\n",
+                   m, (unsigned long long)summary->rxBytes, (unsigned long long)summary->txBytes, summary->events,
+                   summary->commands, summary->failures,
+                   summary->commands ? (double)summary->latencyTotal / summary->commands : 0.0,
+                   summary->latencyMax, summary->connections);
+        }
+        printf("{\"segments\":%u,\"records\":%u,\"blocks_read\":%u,\"blocks_skipped\":%u}\n",
+               segments, query.records, query.blocksRead, query.blocksSkipped);
+    }
+    return EXIT_SUCCESS;
+}
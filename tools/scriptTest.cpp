@@ -0,0 +1,80 @@
+/*
+ * scriptTest.cpp
+ *
+ * Created: 18-10-2026 06:55:52
+ * Author: Subrata
+ * Description: Host check of the script and listing readers against the
+ *              in-process simulator on a virtual clock. Uploads a script, reads
+ *              it back by fingerprint, stores and checks a configuration record,
+ *              and then lets the module fall silent in the middle of a listing,
+ *              which must end in a timeout rather than a hang. Every command must
+ *              end up answered or timed out in the command statistics. An alarm
+ *              stops the check if a loop never lets virtual time advance. Prints
+ *              the result as one JSON line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/scriptTest.cpp src/moduleScript.cpp src/moduleConfig.cpp
+ *        src/crc16.cpp src/rn4871.cpp src/lsParser.cpp src/ringBuffer.cpp src/host/simPort.cpp
+ *        src/host/vclock.cpp src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o scriptTest
+ * Usage: scriptTest
+ */
+
+#include "moduleConfig.h"
+#include "moduleScript.h"
+#include "rn4871.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Wall time in s after which a hanging loop fails the check
+#define WALL_LIMIT 10
+
+static const char* script = "@CONN\nSHW,0072,01\n@DISCON\nSHW,0072,00\n";
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+
+int main(void) {
+    alarm(WALL_LIMIT); // Default action terminates the process
+
+    simInit(&sim);
+    vclockInit(&virtualClock);
+    simPortAttach(&port, &sim, &virtualClock);
+    setOperationMode(dataMode);
+
+    bool commandMode = enterCommandMode();
+    scriptSyncResult_t written = scriptSync(script);
+    bool stored = strcmp(sim.script, script) == 0;
+    scriptSyncResult_t unchanged = scriptSync(script);
+
+    uint16_t fingerprint = scriptFingerprint(script);
+    bool saved = configSave(fingerprint);
+    bool current = configIsCurrent(fingerprint);
+
+    // Module falls silent after the first line of a listing
+    simEmit(&sim, "000B,2A00,02\r\n");
+    sim.rebooting = true; // Input is ignored during boot
+    sim.rebootDue = sim.now + 60000;
+    uint32_t start = millis();
+    bool incomplete = configIsCurrent(fingerprint);
+    uint32_t waited = millis() - start;
+    bool timedOut = !incomplete && waited >= DEFAULT_CMD_TIMEOUT && waited < 60000;
+
+    // Every command is settled, including those whose response was parsed in place
+    const commandStats_t* stats = getCommandStats();
+    bool settled = stats->answered + stats->timeouts == stats->commands;
+
+    bool passed = commandMode && written == scriptSyncWritten && stored &&
+                  unchanged == scriptSyncUnchanged && saved && current && timedOut && settled;
+    printf("{\"result\":\"%s\",\"command_mode\":%d,\"written\":%d,\"stored\":%d,\"unchanged\":%d,"
+           "\"saved\":%d,\"current\":%d,\"timeout_ms\":%lu,\"commands\":%u,\"answered\":%u,"
+           "\"timeouts\":%u,\"virtual_ms\":%lu}\n",
+           passed ? "pass" : "fail", commandMode, written == scriptSyncWritten, stored,
+           unchanged == scriptSyncUnchanged, saved, current, (unsigned long)waited, stats->commands,
+           stats->answered, stats->timeouts, (unsigned long)virtualClock.now);
+    simPortDetach(&port);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
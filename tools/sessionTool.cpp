@@ -0,0 +1,179 @@
+/*
+ * sessionTool.cpp
+ *
+ * Created: 18-10-2026 06:04:25
+ * Author: Subrata
+ * Description: Session record/replay harness for the Linux port. "record" runs the
+ *              setup scenario of the example firmware against a real or simulated
+ *              module and saves the byte stream and API results; "replay" runs the
+ *              same scenario against recordings under virtual time and reports one
+ *              JSON line per file, so a corpus of sessions is a deterministic
+ *              behaviour and timing regression suite.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/sessionTool.cpp src/rn4871.cpp src/lsParser.cpp
+ *        src/ringBuffer.cpp src/host/session.cpp src/host/vclock.cpp src/host/bleSerialHost.cpp
+ *        src/host/wiringHost.cpp -o sessionTool
+ * Usage: sessionTool record <device> <session>
+ *        sessionTool replay <session> [session ...]
+ */
+
+#include "rn4871.h"
+#include "session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* myServiceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
+static const char* potCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+static const char* toggleLedCharUUID = "AD11CF40363F11E5BE3E0002A5D5C51B";
+
+static sessionRecorder_t recorder;
+static session_t session;
+static bool replaying = false;
+
+// -----------------------------------------------------------------------------------
+// Report API result procedure
+// -----------------------------------------------------------------------------------
+// Input : name - Library call, value - Result as text
+// Output: void
+// Records the result while recording, compares it while replaying.
+// -----------------------------------------------------------------------------------
+static void apiResult(const char* name, const char* value) {
+    if (replaying) {
+        sessionCheckApi(&session, name, value);
+    } else {
+        sessionRecordApi(&recorder, name, value);
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Report numeric API result procedure
+// -----------------------------------------------------------------------------------
+// Input : name - Library call, value - Result
+// Output: void
+// -----------------------------------------------------------------------------------
+static void apiNumber(const char* name, long value) {
+    char text[16];
+    snprintf(text, sizeof(text), "%ld", value);
+    apiResult(name, text);
+}
+
+// -----------------------------------------------------------------------------------
+// Run scenario procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: void
+// The setup sequence of readPot_writeBtn.cpp followed by one update cycle.
+// -----------------------------------------------------------------------------------
+static void runScenario(void) {
+    apiNumber("swInit", swInit());
+    apiNumber("enterCommandMode", enterCommandMode());
+    apiNumber("stopAdvertising", stopAdvertising());
+    apiNumber("clearAllServices", clearAllServices());
+    apiNumber("setSerializedName", setSerializedName("Avocado"));
+    apiNumber("setServiceUUID", setServiceUUID(myServiceUUID));
+    apiNumber("setCharactUUID", setCharactUUID(potCharUUID, READ_PROPERTY, 4));
+    apiNumber("setCharactUUID", setCharactUUID(toggleLedCharUUID, WRITE_PROPERTY, 1));
+    uint16_t potHandle = findHandle(potCharUUID, READ_PROPERTY);
+    apiNumber("findHandle", potHandle);
+    apiNumber("findHandle", findHandle(toggleLedCharUUID, WRITE_PROPERTY));
+    apiNumber("reboot", reboot());
+    apiNumber("enterCommandMode", enterCommandMode());
+    apiNumber("setAdvPower", setAdvPower(0));
+    apiNumber("getConnectionStatus", getConnectionStatus());
+    apiNumber("writeLocalCharacteristic", writeLocalCharacteristic(potHandle, "0123"));
+    apiNumber("readLocalCharacteristic", readLocalCharacteristic(potHandle));
+    apiResult("getLastResponse", getLastResponse());
+}
+
+// -----------------------------------------------------------------------------------
+// Wall clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in ms
+// -----------------------------------------------------------------------------------
+static double wallMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// -----------------------------------------------------------------------------------
+// Record procedure
+// -----------------------------------------------------------------------------------
+// Input : device - Serial port, path - Session file
+// Output: int - Exit status
+// -----------------------------------------------------------------------------------
+static int record(const char* device, const char* path) {
+    bleSetDevice(device);
+    bleInit();
+    if (!ble.initialized) {
+        fprintf(stderr, "sessionTool: cannot open %s\n", device);
+        return EXIT_FAILURE;
+    }
+    if (!sessionRecordOpen(&recorder, path)) {
+        fprintf(stderr, "sessionTool: cannot create %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    bleSetTap(sessionTap, &recorder);
+    runScenario();
+    bleSetTap(NULL, NULL);
+    sessionRecordClose(&recorder);
+    return EXIT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------------
+// Replay procedure
+// -----------------------------------------------------------------------------------
+// Input : path - Session file
+// Output: bool - True if the replay reproduced the recording
+// -----------------------------------------------------------------------------------
+static bool replay(const char* path) {
+    if (!sessionLoad(&session, path)) {
+        printf("{\"session\":\"%s\",\"result\":\"error\",\"error\":\"cannot read\"}\n", path);
+        return false;
+    }
+
+    double start = wallMillis();
+    replaying = true;
+    setOperationMode(dataMode);
+    sessionReplayStart(&session);
+    runScenario();
+    sessionReplayStop(&session);
+    replaying = false;
+    bool passed = sessionReplayPassed(&session);
+
+    printf("{\"session\":\"%s\",\"result\":\"%s\",\"records\":%lu,\"api_checked\":%lu,"
+           "\"virtual_ms\":%lu,\"wall_ms\":%.2f",
+           path, passed ? "pass" : "fail", (unsigned long)session.count,
+           (unsigned long)session.apiChecked, (unsigned long)session.clock.now, wallMillis() - start);
+    if (!passed) {
+        printf(",\"error\":\"");
+        for (const char* c = session.error; *c; c++) {
+            if (*c == '"' || *c == '\\') putchar('\\');
+            putchar(*c);
+        }
+        printf("\"");
+    }
+    printf("}\n");
+    sessionFree(&session);
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && strcmp(argv[1], "record") == 0) {
+        return record(argv[2], argv[3]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        bool ok = true;
+        for (int i = 2; i < argc; i++) {
+            ok = replay(argv[i]) && ok;
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    fprintf(stderr, "usage: %s record <device> <session>\n       %s replay <session> [session ...]\n",
+            argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
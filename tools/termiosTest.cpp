@@ -0,0 +1,93 @@
+/*
+ * termiosTest.cpp
+ *
+ * Created: 18-10-2026 06:16:37
+ * Author: Subrata
+ * Description: Host check of the LinuxTermios backend of the hardware abstraction
+ *              layer. Instantiates BleSerialDriver with LinuxTermios and LinuxClock
+ *              on the slave side of a pseudo-terminal served by the simulator,
+ *              enters command mode, reads the firmware version, drains the
+ *              transmit path with txWait and closes the port. Prints the result as
+ *              one JSON line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/termiosTest.cpp src/ringBuffer.cpp
+ *        src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp src/host/wiringHost.cpp -o termiosTest
+ * Usage: termiosTest
+ */
+
+#include "hal.h"
+#include "halTermios.h"
+#include "rn4871Sim.h"
+#include "rn4871_const.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest wait for a reply (ms)
+#define REPLY_TIMEOUT 1000
+
+typedef BleSerialDriver<LinuxTermios, LinuxClock> termiosDriver;
+
+static rn4871Sim_t sim;
+static ble_uart_t port;
+static int master = -1;
+
+// -----------------------------------------------------------------------------------
+// Exchange procedure
+// -----------------------------------------------------------------------------------
+// Input : command - Bytes to send, expect - Substring the reply must contain,
+//         reply - Destination, size - Destination size
+// Output: bool - True if the reply arrived before REPLY_TIMEOUT
+// Sends through the driver and serves the simulator until the reply is complete.
+// -----------------------------------------------------------------------------------
+static bool exchange(const char* command, const char* expect, char* reply, size_t size) {
+    size_t length = 0;
+
+    for (const char* c = command; *c != '\0'; c++) {
+        while (!termiosDriver::write(port, (uint8_t)*c)) {
+            simServe(&sim, master); // Ring full, let the module take bytes
+        }
+    }
+    reply[0] = '\0';
+
+    unsigned long start = LinuxClock::now();
+    while (!LinuxClock::expired(start, REPLY_TIMEOUT)) {
+        simServe(&sim, master);
+        simTask(&sim, LinuxClock::now());
+        while (termiosDriver::available(port) > 0 && length + 1 < size) {
+            reply[length++] = (char)termiosDriver::read(port);
+            reply[length] = '\0';
+        }
+        if (strstr(reply, expect) != NULL) {
+            return true;
+        }
+        LinuxClock::sleep(1);
+    }
+    return false;
+}
+
+int main(void) {
+    char slavePath[64];
+    char reply[128];
+
+    simInit(&sim);
+    master = simOpenPty(slavePath, sizeof(slavePath));
+    if (master < 0 || !LinuxTermios::open(slavePath)) {
+        perror("termiosTest: pty");
+        return EXIT_FAILURE;
+    }
+    termiosDriver::init(port);
+
+    bool commandMode = exchange(ENTER_CMD, PROMPT, reply, sizeof(reply));
+    bool version = exchange(DISPLAY_FW_VERSION "\r", "RN4871 V", reply, sizeof(reply));
+    termiosDriver::txWait(port);
+    bool drained = !LinuxTermios::txBusy(port);
+
+    LinuxTermios::close();
+    bool closed = LinuxTermios::txComplete(); // Must not touch the closed descriptor
+
+    bool passed = commandMode && version && drained && closed;
+    printf("{\"result\":\"%s\",\"command_mode\":%d,\"version\":%d,\"drained\":%d,\"closed\":%d}\n",
+           passed ? "pass" : "fail", commandMode, version, drained, closed);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
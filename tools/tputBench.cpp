@@ -0,0 +1,171 @@
+/*
+ * tputBench.cpp
+ *
+ * Created: 18-10-2026 06:58:46
+ * Author: Subrata
+ * Description: Host counterpart of the throughput test service. Runs the firmware
+ *              side of tputService against the in-process simulator on a virtual
+ *              clock and plays the central: connects, subscribes, writes the start
+ *              command, then checks every received payload for its sequence number.
+ *              The simulator paces the link by connection events, so connection
+ *              interval, packets per event and payload gap can be compared. Prints
+ *              the run report and the central's view as one JSON line.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/tputBench.cpp src/tputService.cpp src/rn4871.cpp
+ *        src/lsParser.cpp src/ringBuffer.cpp src/host/simPort.cpp src/host/vclock.cpp
+ *        src/host/rn4871Sim.cpp src/host/bleSerialHost.cpp src/host/wiringHost.cpp
+ *        -o tputBench
+ * Usage: tputBench [-m notify|uart] [-n payloads] [-g gap_ms] [-i interval_ms]
+ *        [-p packets_per_event]
+ */
+
+#include "rn4871.h"
+#include "tputService.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Longest run in virtual ms before the benchmark gives up
+#define RUN_LIMIT 600000UL
+
+typedef struct {
+    uint32_t payloads;       // Payloads received in full
+    uint32_t sequenceErrors; // Payloads out of sequence or corrupted
+    uint16_t expected;       // Next expected sequence number
+    char line[TPUT_PAYLOAD_SIZE]; // Transparent UART payload being assembled
+    uint8_t lineLen;         // Bytes in line
+} central_t;
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+static central_t central;
+
+// -----------------------------------------------------------------------------------
+// Check sequence procedure
+// -----------------------------------------------------------------------------------
+// Input : sequence - Sequence number of a received payload
+// Output: void
+// -----------------------------------------------------------------------------------
+static void checkSequence(uint16_t sequence) {
+    if (sequence != central.expected) {
+        central.sequenceErrors++;
+    }
+    central.expected = sequence + 1;
+    central.payloads++;
+}
+
+// -----------------------------------------------------------------------------------
+// Central receive procedure
+// -----------------------------------------------------------------------------------
+// Input : ctx - Unused, handle - Notifying handle or 0 for transparent UART data,
+//         data - Value or data bytes, length - Byte count
+// Output: void
+// -----------------------------------------------------------------------------------
+static void centralReceive(void* ctx, uint16_t handle, const uint8_t* data, uint16_t length) {
+    (void)ctx;
+    if (handle != 0) {
+        if (handle == tputService.dataHandle && length == TPUT_PAYLOAD_SIZE) {
+            checkSequence(data[0] | (uint16_t)data[1] << 8);
+        }
+        return;
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        central.line[central.lineLen++] = (char)data[i];
+        if (data[i] == '\n' || central.lineLen == TPUT_PAYLOAD_SIZE) {
+            char digits[5] = { 0 };
+            memcpy(digits, central.line, 4);
+            if (central.lineLen == TPUT_PAYLOAD_SIZE && data[i] == '\n') {
+                checkSequence((uint16_t)strtoul(digits, NULL, 16));
+            } else {
+                central.sequenceErrors++; // Payload lost bytes on the way
+                central.expected++;
+            }
+            central.lineLen = 0;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------
+// Event handler procedure
+// -----------------------------------------------------------------------------------
+// Input : event - Event without % delimiters
+// Output: void
+// -----------------------------------------------------------------------------------
+static void onEvent(const char* event) {
+    tputHandleEvent(event);
+}
+
+int main(int argc, char** argv) {
+    tputMode_t mode = tputNotify;
+    uint16_t count = 500;
+    uint8_t gap = 0;
+    uint16_t interval = 30;
+    uint8_t packets = SIM_PACKETS_PER_EVENT;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:g:i:p:")) != -1) {
+        switch (opt) {
+            case 'm': mode = strcmp(optarg, "uart") == 0 ? tputUart : tputNotify; break;
+            case 'n': count = (uint16_t)strtoul(optarg, NULL, 10); break;
+            case 'g': gap = (uint8_t)strtoul(optarg, NULL, 10); break;
+            case 'i': interval = (uint16_t)strtoul(optarg, NULL, 10); break;
+            case 'p': packets = (uint8_t)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-m notify|uart] [-n payloads] [-g gap_ms] [-i interval_ms] "
+                                "[-p packets_per_event]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    simInit(&sim);
+    vclockInit(&virtualClock);
+    simPortAttach(&port, &sim, &virtualClock);
+    sim.connInterval = interval;
+    sim.packetsPerEvent = packets;
+    sim.central = centralReceive;
+    setOperationMode(dataMode);
+
+    // Firmware side: define the service and look up its handles
+    if (!enterCommandMode() || !tputDefine() || !reboot() || !enterCommandMode() || !tputInit()) {
+        fprintf(stderr, "service setup failed\n");
+        return EXIT_FAILURE;
+    }
+    setEventHandler(onEvent);
+
+    // Central side: connect, subscribe and start the run
+    char command[9];
+    snprintf(command, sizeof(command), "%02X%02X%02X%02X", mode == tputUart ? TPUT_OP_UART : TPUT_OP_NOTIFY,
+             count & 0xFF, count >> 8, gap);
+    simConnect(&sim, NULL);
+    simCentralSubscribe(&sim, tputService.dataHandle, true);
+    simCentralWrite(&sim, tputService.controlHandle, command);
+
+    // Main loop of the firmware until the report is stored
+    uint32_t start = millis();
+    bool started = false;
+    while (!timeoutExpired(start, RUN_LIMIT)) {
+        getConnectionStatus(); // Delivers the pending events
+        started = started || tputService.request != tputIdle;
+        tputTask();
+        if (started && tputService.request == tputIdle) break;
+    }
+    while ((sim.linkQueued > 0 || sim.linkPartial > 0) && !timeoutExpired(start, RUN_LIMIT)) {
+        delay(interval); // Let the link drain
+    }
+
+    const tputReport_t* report = &tputService.report;
+    printf("{\"mode\":\"%s\",\"interval_ms\":%u,\"packets_per_event\":%u,\"gap_ms\":%u,"
+           "\"payloads\":%u,\"bytes\":%lu,\"time_ms\":%lu,\"throughput_Bps\":%.0f,\"stalls\":%u,"
+           "\"flow_events\":%u,\"central_payloads\":%lu,\"sequence_errors\":%lu,\"link_packets\":%lu,"
+           "\"link_dropped\":%lu,\"notify_rejected\":%lu}\n",
+           mode == tputUart ? "uart" : "notify", interval, packets, gap, report->payloads,
+           (unsigned long)report->bytes, (unsigned long)report->time,
+           report->time > 0 ? report->bytes * 1000.0 / report->time : 0.0, report->stalls,
+           report->flowEvents, (unsigned long)central.payloads, (unsigned long)central.sequenceErrors,
+           (unsigned long)sim.linkPackets, (unsigned long)sim.linkDropped, (unsigned long)sim.notifyRejected);
+    simPortDetach(&port);
+    return started && central.payloads == count && central.sequenceErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+/*
+ * virtualBench.cpp
+ *
+ * Created: 18-10-2026 06:08:53
+ * Author: Subrata
+ * Description: Virtual-time provisioning benchmark. Runs the setup sequence of the
+ *              example firmware, reboot included, against a fresh in-process
+ *              simulator on a virtual clock many times in a row and reports the
+ *              simulated and wall time as one JSON line. Every run is deterministic,
+ *              so a failing run number reproduces exactly.
+ *
+ * Build: g++ -O2 -Isrc -Isrc/host tools/virtualBench.cpp src/rn4871.cpp src/lsParser.cpp
+ *        src/ringBuffer.cpp src/host/simPort.cpp src/host/vclock.cpp src/host/rn4871Sim.cpp
+ *        src/host/bleSerialHost.cpp src/host/wiringHost.cpp -o virtualBench
+ * Usage: virtualBench [-n runs] [-b boot_ms]
+ */
+
+#include "rn4871.h"
+#include "simPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char* myServiceUUID = "AD11CF40063F11E5BE3E0002A5D5C51B";
+static const char* potCharUUID = "AD11CF40163F11E5BE3E0002A5D5C51B";
+static const char* toggleLedCharUUID = "AD11CF40363F11E5BE3E0002A5D5C51B";
+
+static rn4871Sim_t sim;
+static vclock_t virtualClock;
+static simPort_t port;
+
+// -----------------------------------------------------------------------------------
+// Wall clock procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: double - Monotonic time in ms
+// -----------------------------------------------------------------------------------
+static double wallMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// -----------------------------------------------------------------------------------
+// Provisioning run procedure
+// -----------------------------------------------------------------------------------
+// Input : None
+// Output: bool - True if every step succeeded
+// The setup sequence of readPot_writeBtn.cpp followed by one update cycle.
+// -----------------------------------------------------------------------------------
+static bool provisionRun(void) {
+    if (!swInit()) return false;
+    if (!enterCommandMode()) return false;
+    if (!stopAdvertising()) return false;
+    if (!clearAllServices()) return false;
+    if (!setSerializedName("Avocado")) return false;
+    if (!setServiceUUID(myServiceUUID)) return false;
+    if (!setCharactUUID(potCharUUID, READ_PROPERTY, 4)) return false;
+    if (!setCharactUUID(toggleLedCharUUID, WRITE_PROPERTY, 1)) return false;
+    uint16_t potHandle = findHandle(potCharUUID, READ_PROPERTY);
+    if (potHandle == 0 || findHandle(toggleLedCharUUID, WRITE_PROPERTY) == 0) return false;
+    if (!reboot()) return false;
+    if (!enterCommandMode()) return false;
+    if (!setAdvPower(0)) return false;
+    if (!writeLocalCharacteristic(potHandle, "0123")) return false;
+    if (!readLocalCharacteristic(potHandle)) return false;
+    return strncmp(getLastResponse(), "0123", 4) == 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned long runs = 1000;
+    uint16_t bootTime = 300;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:")) != -1) {
+        switch (opt) {
+            case 'n': runs = strtoul(optarg, NULL, 10); break;
+            case 'b': bootTime = (uint16_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n runs] [-b boot_ms]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    unsigned long passed = 0;
+    unsigned long firstFailure = 0;
+    uint64_t virtualTotal = 0;
+    uint64_t jumps = 0;
+    double start = wallMillis();
+
+    for (unsigned long run = 1; run <= runs; run++) {
+        simInit(&sim);
+        sim.rebootTime = bootTime;
+        vclockInit(&virtualClock);
+        simPortAttach(&port, &sim, &virtualClock);
+        setOperationMode(dataMode);
+
+        if (provisionRun()) {
+            passed++;
+        } else if (firstFailure == 0) {
+            firstFailure = run;
+        }
+        virtualTotal += virtualClock.now;
+        jumps += virtualClock.jumps;
+        simPortDetach(&port);
+    }
+
+    double wall = wallMillis() - start;
+    printf("{\"runs\":%lu,\"passed\":%lu,\"first_failure\":%lu,\"virtual_ms_per_run\":%.1f,"
+           "\"wall_ms\":%.2f,\"runs_per_s\":%.0f,\"speedup\":%.0f,\"jumps_per_run\":%.1f}\n",
+           runs, passed, firstFailure, runs ? (double)virtualTotal / runs : 0.0, wall,
+           wall > 0 ? runs * 1000.0 / wall : 0.0, wall > 0 ? virtualTotal / wall : 0.0,
+           runs ? (double)jumps / runs : 0.0);
+    return passed == runs ? EXIT_SUCCESS : EXIT_FAILURE;
+}